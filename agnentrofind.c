@@ -30,6 +30,7 @@ Approximate Binary Search
 #include "flag_fracterval_u64.h"
 #include "flag_fracterval_u128.h"
 #include "flag_loggamma.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include "flag_poissocache.h"
 #include "flag_agnentroprox.h"
@@ -46,6 +47,8 @@ Approximate Binary Search
 #include "loggamma_xtrn.h"
 #include "maskops.h"
 #include "maskops_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 #include "poissocache.h"
 #include "agnentroprox.h"
 #include "agnentroprox_xtrn.h"
@@ -81,6 +84,7 @@ Approximate Binary Search
 #define AGNENTROFIND_FORMAT_PRECISE_BIT_IDX 4U
 #define AGNENTROFIND_FORMAT_PROGRESS 1U
 #define AGNENTROFIND_FORMAT_PROGRESS_BIT_IDX 3U
+#define AGNENTROFIND_PREFETCH_SIZE_MAX 0x40000000U
 #define AGNENTROFIND_SWEEP_STATUS_EXACT 0U
 #define AGNENTROFIND_SWEEP_STATUS_CUSTOM 1U
 #define AGNENTROFIND_SWEEP_STATUS_NEEDLE 2U
@@ -94,6 +98,120 @@ agnentrofind_error_print(char *char_list_base){
   return;
 }
 
+u8
+agnentrofind_needle_list_parse(u8 granularity, u8 *granularity_status_base, ULONG *needle_idx_max_base, char *needle_list_char_list_base, ULONG needle_list_size, ULONG *needle_mask_idx_max_base, ULONG *needle_mask_idx_max_list_base, u8 *needle_mask_list_base, u8 overlap_status){
+/*
+Convert a needle list file to a list of needles suitable for agnentroprox_multimatch_init().
+
+In:
+
+  granularity is agnentroprox_init():In:granularity.
+
+  granularity_status_base is undefined.
+
+  needle_idx_max_base is undefined.
+
+  *needle_list_char_list_base is the contents of the needle list file, followed by a null terminator. Each line thereof is empty or a needle formatted as described for (needle) in the help text, either a UTF8 string prefixed with "@" or hex bytes prefixed with "+". Lines may end with "\n" or "\r\n". This list will be overwritten.
+
+  needle_list_size is the size of *needle_list_char_list_base, not counting the null terminator.
+
+  needle_mask_idx_max_base is undefined.
+
+  *needle_mask_idx_max_list_base is writable for one more item than the number of "\n"s in *needle_list_char_list_base.
+
+  *needle_mask_list_base is writable for needle_list_size items.
+
+  overlap_status is agnentroprox_init():In:overlap_status.
+
+Out:
+
+  Returns zero on success, else one after printing an error message.
+
+  *granularity_status_base is one if the size of any needle isn't a multiple of (granularity+1) such that tail bytes will be ignored, else zero.
+
+  *needle_idx_max_base is one less than the number of needles, which is the number of nonempty lines.
+
+  *needle_mask_idx_max_base is the least needle size, in the sense of agnentroprox_match_find():In:needle_mask_idx_max.
+
+  *needle_mask_idx_max_list_base contains (*needle_idx_max_base+1) needle sizes, also in that sense.
+
+  *needle_mask_list_base contains the concatenation of the needles so described, having been stripped of any tail bytes.
+*/
+  ULONG char_idx;
+  ULONG char_idx_min;
+  u8 granularity_status;
+  ULONG needle_idx;
+  ULONG needle_mask_idx_max;
+  ULONG needle_mask_idx_max_min;
+  char needle_prefix;
+  ULONG needle_size;
+  ULONG needle_u8_idx;
+  u8 status;
+  ULONG u8_idx_delta;
+
+  char_idx=0;
+  *granularity_status_base=0;
+  needle_idx=0;
+  needle_mask_idx_max_min=ULONG_MAX;
+  needle_u8_idx=0;
+  status=0;
+  u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
+  do{
+    char_idx_min=char_idx;
+    while((char_idx!=needle_list_size)&&(needle_list_char_list_base[char_idx]!='\n')){
+      char_idx++;
+    }
+    needle_list_char_list_base[char_idx]=0;
+    needle_size=char_idx-char_idx_min;
+    if(needle_size&&(needle_list_char_list_base[char_idx-1]=='\r')){
+      needle_size--;
+      needle_list_char_list_base[char_idx-1]=0;
+    }
+    if(needle_size){
+      needle_prefix=needle_list_char_list_base[char_idx_min];
+      needle_size--;
+      status=!needle_size;
+      if(!status){
+        if(needle_prefix=='+'){
+          status=!!ascii_hex_to_u8_list_convert(char_idx_min+needle_size, char_idx_min+1, needle_list_char_list_base, &needle_mask_list_base[needle_u8_idx]);
+          needle_size>>=1;
+        }else if(needle_prefix=='@'){
+          memcpy(&needle_mask_list_base[needle_u8_idx], &needle_list_char_list_base[char_idx_min+1], (size_t)(needle_size));
+        }else{
+          status=1;
+        }
+      }
+      if(status){
+        agnentrofind_error_print("Each nonempty line of a (needle) list must be \"@\" followed by UTF8 text or\n\"+\" followed by an even number of nybbles");
+        DEBUG_U64("needle_idx_in_hex", needle_idx);
+        break;
+      }
+      needle_mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, needle_size, overlap_status);
+      if(needle_mask_idx_max==ULONG_MAX){
+        agnentrofind_error_print("(needle) list contains a needle smaller than (granularity+1) bytes");
+        DEBUG_U64("needle_idx_in_hex", needle_idx);
+        status=1;
+        break;
+      }
+      *granularity_status_base=(u8)(*granularity_status_base|granularity_status);
+      needle_mask_idx_max_list_base[needle_idx]=needle_mask_idx_max;
+      needle_mask_idx_max_min=MIN(needle_mask_idx_max, needle_mask_idx_max_min);
+      needle_idx++;
+/*
+Advance by the size of the needle without its tail bytes, so the next one will overwrite them.
+*/
+      needle_u8_idx+=(needle_mask_idx_max*u8_idx_delta)+granularity+1;
+    }
+  }while((char_idx++)!=needle_list_size);
+  if(!(status|needle_idx)){
+    agnentrofind_error_print("(needle) list is empty");
+    status=1;
+  }
+  *needle_idx_max_base=needle_idx-1;
+  *needle_mask_idx_max_base=needle_mask_idx_max_min;
+  return status;
+}
+
 void
 agnentrofind_out_of_memory_print(void){
   agnentrofind_error_print("Out of memory");
@@ -108,6 +226,228 @@ agnentrofind_parameter_error_print(char *char_list_base){
   return;
 }
 
+u8
+agnentrofind_rank_file_merge(u8 ascending_status, char *haystack_filename_list_base, ULONG haystack_filename_list_size, ULONG *rank_count_base, char *rank_filename_base, char **rank_filename_list_base_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base){
+/*
+Merge a folder ranking with the one in a rank file left by previous runs, possibly on other machines, then save the merged ranking back to the rank file. In this way, the shards of a corpus can be ranked separately, but reported as a whole.
+
+A rank file consists of a rank list exported by agnentroprox_rank_list_serialize(), followed by the null-terminated names of the ranked files in rank order. The file index of each rank is the offset of its filename relative to the first one.
+
+In:
+
+  ascending_status is agnentroprox_rank_list_insert():In:ascending_status.
+
+  *haystack_filename_list_base is the haystack filename list, to which the file indexes at rank_list_base refer.
+
+  haystack_filename_list_size is the size of *haystack_filename_list_base, which exceeds all such file indexes.
+
+  *rank_count_base is the number of ranks at rank_list_base.
+
+  *rank_filename_base is the writable null-terminated name of the rank file, which need not exist. It will be unchanged upon return.
+
+  *rank_filename_list_base_base is undefined.
+
+  rank_idx_max_max is agnentroprox_rank_list_malloc():In:rank_idx_max_max as it pertains to rank_list_base.
+
+  *rank_list_base is the folder ranking.
+
+Out:
+
+  Returns zero on success, else one after printing an error message.
+
+  *rank_count_base is the number of ranks in the merged ranking. Undefined on failure.
+
+  *rank_filename_list_base_base is NULL on failure, else a list containing the filenames of the merged ranking, which should eventually be freed via filesys_free().
+
+  *rank_list_base is the merged ranking, whose file indexes refer to *rank_filename_list_base_base. Undefined on failure.
+*/
+  ULONG file_idx;
+  char *filename_base;
+  ULONG filename_list_char_idx;
+  ULONG filename_list_size;
+  ULONG filename_size;
+  u8 filesys_status;
+  ULONG merge_rank_count_list_base[2];
+  agnentroprox_rank_t *merge_rank_list_base;
+  agnentroprox_rank_t *merge_rank_list_base_list_base[2];
+  u8 old_ascending_status;
+  char *old_filename_list_base;
+  ULONG old_filename_list_size;
+  ULONG old_rank_count;
+  ULONG old_rank_idx_max;
+  agnentroprox_rank_t *old_rank_list_base;
+  ULONG rank_count;
+  ULONG rank_file_size;
+  ULONG rank_idx;
+  ULONG serial_size;
+  u64 *serial_u64_list_base;
+  ULONG shard_idx_max;
+  u8 status;
+
+  merge_rank_list_base=NULL;
+  old_ascending_status=ascending_status;
+  old_rank_list_base=NULL;
+  serial_u64_list_base=NULL;
+  *rank_filename_list_base_base=NULL;
+  do{
+    old_filename_list_base=NULL;
+    old_filename_list_size=0;
+    old_rank_count=0;
+    rank_file_size=0;
+    shard_idx_max=0;
+    status=1;
+    filesys_status=filesys_file_size_ulong_get(&rank_file_size, rank_filename_base);
+    if(filesys_status!=FILESYS_STATUS_NOT_FOUND){
+      if(filesys_status){
+        agnentrofind_error_print("Rank file is too big to fit in memory");
+        break;
+      }
+/*
+Read the rank file and check that it was ranked in the same direction, and that each rank refers to the first character of one of its filenames, before anything gets overwritten.
+*/
+      serial_u64_list_base=(u64 *)(filesys_char_list_malloc(rank_file_size));
+      if(!serial_u64_list_base){
+        agnentrofind_out_of_memory_print();
+        break;
+      }
+      filesys_status=filesys_file_read_exact(rank_file_size, rank_filename_base, serial_u64_list_base);
+      if(filesys_status){
+        agnentrofind_error_print("Could not read rank file");
+        break;
+      }
+      serial_size=AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT<<U64_SIZE_LOG2;
+      if(serial_size<=rank_file_size){
+        old_rank_count=(ULONG)(serial_u64_list_base[1]);
+        if((old_rank_count==serial_u64_list_base[1])&&(old_rank_count<=((rank_file_size>>U64_SIZE_LOG2)/AGNENTROPROX_RANK_U64_COUNT))){
+          serial_size=agnentroprox_rank_list_serialize(ascending_status, old_rank_count, NULL, NULL);
+          old_filename_list_base=&((char *)(serial_u64_list_base))[serial_size];
+          old_filename_list_size=rank_file_size-serial_size;
+          status=(rank_file_size<serial_size);
+        }
+      }
+      if(!status){
+        old_rank_idx_max=0;
+        if(old_rank_count){
+          old_rank_idx_max=old_rank_count-1;
+          status=1;
+          if(old_filename_list_size){
+            status=!!old_filename_list_base[old_filename_list_size-1];
+          }
+        }
+      }
+      if(!status){
+        old_rank_list_base=agnentroprox_rank_list_malloc(old_rank_idx_max);
+        if(!old_rank_list_base){
+          agnentrofind_out_of_memory_print();
+          status=1;
+          break;
+        }
+        status=agnentroprox_rank_list_deserialize(&old_ascending_status, &old_rank_count, old_rank_idx_max, old_rank_list_base, serial_size, serial_u64_list_base);
+      }
+      if(!status){
+        rank_idx=0;
+        while(rank_idx<old_rank_count){
+          file_idx=(ULONG)(old_rank_list_base[rank_idx].file_idx);
+          if((old_rank_list_base[rank_idx].file_idx!=file_idx)||(old_filename_list_size<=file_idx)||(file_idx&&old_filename_list_base[file_idx-1])){
+            status=1;
+            break;
+          }
+/*
+Move the file index past the end of the haystack filename list, so that it can't collide with the file indexes of the new ranks. This favors the latter in case of a tie.
+*/
+          old_rank_list_base[rank_idx].file_idx=haystack_filename_list_size+file_idx;
+          rank_idx++;
+        }
+      }
+      if(status){
+        agnentrofind_error_print("Rank file is corrupt");
+        break;
+      }
+      if(old_ascending_status!=ascending_status){
+        agnentrofind_error_print("Rank file was ranked in the opposite direction");
+        status=1;
+        break;
+      }
+      shard_idx_max=1;
+    }
+    merge_rank_list_base=agnentroprox_rank_list_malloc(rank_idx_max_max);
+    if(!merge_rank_list_base){
+      agnentrofind_out_of_memory_print();
+      status=1;
+      break;
+    }
+    merge_rank_count_list_base[0]=*rank_count_base;
+    merge_rank_count_list_base[1]=old_rank_count;
+    merge_rank_list_base_list_base[0]=rank_list_base;
+    merge_rank_list_base_list_base[1]=old_rank_list_base;
+    status=agnentroprox_rank_list_merge(ascending_status, &rank_count, rank_idx_max_max, merge_rank_list_base, shard_idx_max, merge_rank_count_list_base, merge_rank_list_base_list_base);
+    if(status){
+      agnentrofind_out_of_memory_print();
+      break;
+    }
+/*
+Build the new rank file in memory, renumbering each rank with the offset of its filename in the new list. Because the offsets increase with rank, the merged ranking remains in order.
+*/
+    filename_list_size=0;
+    rank_idx=0;
+    while(rank_idx<rank_count){
+      file_idx=(ULONG)(merge_rank_list_base[rank_idx].file_idx);
+      filename_base=&haystack_filename_list_base[file_idx];
+      if(haystack_filename_list_size<=file_idx){
+        filename_base=&old_filename_list_base[file_idx-haystack_filename_list_size];
+      }
+      filename_list_size+=(ULONG)(strlen(filename_base))+1;
+      rank_idx++;
+    }
+    serial_size=agnentroprox_rank_list_serialize(ascending_status, rank_count, NULL, NULL);
+    rank_file_size=serial_size+filename_list_size;
+    *rank_filename_list_base_base=filesys_char_list_malloc(rank_file_size);
+    if(!*rank_filename_list_base_base){
+      agnentrofind_out_of_memory_print();
+      status=1;
+      break;
+    }
+    filename_list_char_idx=0;
+    rank_idx=0;
+    while(rank_idx<rank_count){
+      file_idx=(ULONG)(merge_rank_list_base[rank_idx].file_idx);
+      filename_base=&haystack_filename_list_base[file_idx];
+      if(haystack_filename_list_size<=file_idx){
+        filename_base=&old_filename_list_base[file_idx-haystack_filename_list_size];
+      }
+      filename_size=(ULONG)(strlen(filename_base))+1;
+      memcpy(&(*rank_filename_list_base_base)[serial_size+filename_list_char_idx], filename_base, (size_t)(filename_size));
+      merge_rank_list_base[rank_idx].file_idx=filename_list_char_idx;
+      filename_list_char_idx+=filename_size;
+      rank_idx++;
+    }
+    agnentroprox_rank_list_serialize(ascending_status, rank_count, merge_rank_list_base, (u64 *)(*rank_filename_list_base_base));
+    filesys_status=filesys_file_write_durable(rank_file_size, rank_filename_base, *rank_filename_list_base_base);
+    if(filesys_status){
+      agnentrofind_error_print("Could not write rank file");
+      status=1;
+      break;
+    }
+/*
+Point the file indexes at the filenames in the list which is returned, which begin after the serialized rank list.
+*/
+    rank_idx=0;
+    while(rank_idx<rank_count){
+      rank_list_base[rank_idx]=merge_rank_list_base[rank_idx];
+      rank_list_base[rank_idx].file_idx+=serial_size;
+      rank_idx++;
+    }
+    *rank_count_base=rank_count;
+  }while(0);
+  if(status){
+    *rank_filename_list_base_base=filesys_free(*rank_filename_list_base_base);
+  }
+  agnentroprox_free(merge_rank_list_base);
+  agnentroprox_free(old_rank_list_base);
+  filesys_free(serial_u64_list_base);
+  return status;
+}
+
 void
 agnentrofind_warning_print(char *char_list_base){
   DEBUG_PRINT("WARNING: ");
@@ -148,11 +488,11 @@ main(int argc, char *argv[]){
   u8 dump_status;
   fru128 entropy;
   fru128 *entropy_list_base0;
-  fru128 *entropy_list_base1;
+  ULONG entropy_list_idx_max;
   ULONG entropy_list_size;
   u128 entropy_mean;
+  fru128 entropy_needle;
   fru128 entropy_raw;
-  u8 fatal_status;
   u8 file_status;
   u8 filesys_status;
   u8 granularity;
@@ -162,14 +502,11 @@ main(int argc, char *argv[]){
   ULONG haystack_file_size_max;
   char *haystack_filename_base;
   ULONG haystack_filename_list_char_idx;
-  ULONG haystack_filename_list_char_idx_max;
   ULONG haystack_filename_list_char_idx_new;
   ULONG haystack_filename_count;
   ULONG haystack_filename_idx;
-  ULONG *haystack_filename_idx_list_base;
   char *haystack_filename_list_base;
   ULONG haystack_filename_list_size;
-  ULONG haystack_filename_list_size_new;
   ULONG haystack_mask_idx_max;
   ULONG haystack_mask_idx_max_max;
   ULONG haystack_mask_idx_max_parallel;
@@ -178,6 +515,11 @@ main(int argc, char *argv[]){
   u32 haystack_mask_max;
   u32 haystack_mask_max_finalize;
   u32 haystack_mask_min;
+  filesys_prefetch_t haystack_prefetch;
+  void *haystack_prefetch_handle_base;
+  u8 *haystack_prefetch_mask_list_base;
+  agnentroprox_rank_t *haystack_rank_list_base;
+  u8 haystack_sign_status;
   u32 joint_mask_max_densify;
   u32 joint_mask_max_finalize;
   u32 joint_mask_max_surroundify;
@@ -189,10 +531,14 @@ main(int argc, char *argv[]){
   ULONG *maskops_bitmap_base;
   u32 *maskops_u32_list_base;
   ULONG match_count;
+  ULONG *match_count_list_base;
   ULONG match_idx;
   ULONG match_idx_max_max;
   ULONG match_idx_nested;
   ULONG match_idx_old;
+  ULONG match_list_idx;
+  ULONG match_list_idx_max;
+  ULONG *match_needle_idx_list_base;
   ULONG match_u8_idx;
   ULONG *match_u8_idx_list_base;
   ULONG match_u8_idx_max;
@@ -202,21 +548,33 @@ main(int argc, char *argv[]){
   u64 match_u8_idx_u64;
   u8 merge_status;
   u16 mode;
+  agnentroprox_multimatch_t *multimatch_base;
+  agnentroprox_multineedle_t *multineedle_base;
+  ULONG needle_count;
   ULONG needle_file_size;
   char *needle_filename_base;
   ULONG needle_filename_size;
   ULONG needle_filename_size_minus_1;
+  ULONG needle_idx;
+  ULONG needle_idx_max;
+  ULONG needle_idx_max_max;
+  ULONG needle_list_char_idx;
+  char *needle_list_char_list_base;
+  u8 needle_list_status;
   ULONG needle_mask_idx_max;
+  ULONG *needle_mask_idx_max_list_base;
   ULONG needle_mask_idx_max_parallel;
   ULONG needle_mask_idx_max_parallel_channelized;
   u8 *needle_mask_list_base;
   u32 needle_mask_max;
   u32 needle_mask_max_finalize;
   u32 needle_mask_min;
+  ULONG needle_match_count;
   char needle_prefix;
   u8 needle_sign_status;
   char *out_filename_base;
   char *out_filename_list_base;
+  ULONG out_filename_char_idx;
   ULONG out_filename_list_char_idx;
   ULONG out_filename_list_char_idx_max;
   ULONG out_filename_list_char_idx_new;
@@ -228,17 +586,18 @@ main(int argc, char *argv[]){
   u8 precise_status;
   u8 progress_status;
   ULONG rank_count;
+  char *rank_filename_base;
+  char *rank_filename_list_base;
   ULONG rank_idx;
   ULONG rank_idx_max_max;
-  ULONG rank_idx_min;
   fru128 *rank_list_base;
   u8 remask_status;
-  u8 retry_status;
   u128 score;
   ULONG score_idx;
   fru128 score_packed;
   u128 score_threshold;
   u64 score_u64;
+  u8 sign_mode;
   u8 status;
   u8 surroundify_status;
   ULONG sweep_mask_idx_max;
@@ -246,13 +605,16 @@ main(int argc, char *argv[]){
   ULONG sweep_size;
   u8 sweep_status;
   char *sweep_text_base;
+  u32 thread_idx_max;
   ULONG utf8_idx_max;
 
   overflow_status=0;
   status=ascii_init(ASCII_BUILD_BREAK_COUNT_EXPECTED, 0);
-  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 4));
+  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 10));
   status=(u8)(status|fracterval_u128_init(FRU128_BUILD_BREAK_COUNT_EXPECTED, 0));
-  status=(u8)(status|maskops_init(MASKOPS_BUILD_BREAK_COUNT_EXPECTED, 0));
+  status=(u8)(status|maskops_init(MASKOPS_BUILD_BREAK_COUNT_EXPECTED, 3));
+  status=(u8)(status|thread_init(THREAD_BUILD_BREAK_COUNT_EXPECTED, 1));
+  thread_idx_max=thread_count_get()-1;
   agnentroprox_base=NULL;
   case_insensitive_status=0;
   dump_u8_list_base=NULL;
@@ -266,18 +628,27 @@ main(int argc, char *argv[]){
   dump_size=0;
   dump_status=0;
   entropy_list_base0=NULL;
-  entropy_list_base1=NULL;
   FRU128_SET_ZERO(entropy_raw);
   granularity_status=0;
-  haystack_filename_idx_list_base=NULL;
   haystack_filename_list_base=NULL;
   haystack_mask_list_base=NULL;
+  haystack_prefetch_handle_base=NULL;
+  haystack_prefetch_mask_list_base=NULL;
+  haystack_rank_list_base=NULL;
   loggamma_base=NULL;
   maskops_bitmap_base=NULL;
   maskops_u32_list_base=NULL;
+  match_count_list_base=NULL;
+  match_needle_idx_list_base=NULL;
   match_u8_idx_list_base=NULL;
+  multimatch_base=NULL;
+  multineedle_base=NULL;
+  needle_list_char_list_base=NULL;
+  needle_mask_idx_max_list_base=NULL;
   needle_mask_list_base=NULL;
   out_filename_list_base=NULL;
+  rank_filename_base=NULL;
+  rank_filename_list_base=NULL;
   do{
     if(status){
       agnentrofind_error_print("Outdated source code");
@@ -291,11 +662,11 @@ main(int argc, char *argv[]){
       DEBUG_PRINT("Syntax:\n\n");
       DEBUG_PRINT("  agnentrofind needle haystack geometry sweep ranks [format [dump_delta\n  dump_size dump_filename]]\n\n");
       DEBUG_PRINT("where all numerical parameters are decimal unless otherwise stated:\n\n");
-      DEBUG_PRINT("(needle) is one of the following: (0) a UTF8 text string prefixed with \"@\", and\nsurrounded by single or double quotes if necessary; (1) a series of hex bytes\nstarting with \"+\", for example \"+5cE2\" which means 5C followed by E2; or (2)\nthe name of a file containing the binary data to find. If you don't know some\nof the bytes in the middle, then fake them as plausibly as possible.\n\n");
+      DEBUG_PRINT("(needle) is one of the following: (0) a UTF8 text string prefixed with \"@\", and\nsurrounded by single or double quotes if necessary; (1) a series of hex bytes\nstarting with \"+\", for example \"+5cE2\" which means 5C followed by E2; (2) the\nname of a file containing the binary data to find; or (3) the name of a needle\nlist file prefixed with \"%\", each nonempty line of which is a needle in the\nform of (0) or (1). If you don't know some of the bytes in the middle, then\nfake them as plausibly as possible. All the needles in a list will be scored in\na single pass over each (haystack) file. If (sweep) is \"e\" or \"i\", then each\nmatch will be reported as the 0-based index of the needle, not counting empty\nlines, followed by the offset. Otherwise (haystack) must be a file, (mode) must\nbe 00, and (sweep) must not be \"n\"; each needle will then get its own (ranks)\nmatches, each reported as the index of the needle followed by the score and the\noffset.\n\n");
       DEBUG_PRINT("(haystack) is the file or folder to search for matches (no wildcard characters).\nIn the latter case, all symlinks will be ignored so that no subfolder will be\nprocessed more than once.\n\n");
       DEBUG_PRINT("(geometry) is a hex bitmap which controls mask processing:\n\n  bits 0-1: (granularity) Mask size minus 1. Note that 3 (32 bits per mask)\n  requires 64GiB of memory.\n\n  bit 2: (densify) Set to enable densification (mask utilization footprint\n  minimization) after deltafication.\n\n  bit 3: (surroundify) After densification, subtract the minimum mask from all\n  masks, so as to make the new minimum 0. Then convert all masks to their\n  surround codes relative to their new maximum. Note that surroundification is\n  a sparser way of taking the first derivative, so it may be more effective\n  than setting (deltas) to a nonzero value.\n\n  bit 4-5: (deltas) The number of times to compute the delta (discrete\n  derivative) of the mask list prior to considering (overlap). Each delta, if\n  any, will transform {A, B, C...} to  {A, (B-A), (C-B)...}. This is useful\n  for improving the entropy contrast of signals containing masks which\n  represent magnitudes, as opposed to merely symbols. Experiment to find the\n  optimum value for your data set. If the mask list size isn't a multiple of\n  ((granularity)+1) bytes, then the remainder bytes will remain unchanged.\n\n  bit 6: (channelize) Set if masks consist of parallel byte channels, for\n  example the red, green, and blue bytes of 24-bit pixels. This will cause\n  deltafication, if enabled, to occur on individual bytes, prior to considering\n  (overlap). For example, {A0:B0, A1:B1, A2:B2} (3 masks spanning 6 bytes)\n  would be transformed to {A0:B0, (A1-A0):(B1-B0), (A2-A1):(B2-B1)}.\n\n  bit 7: (overlap) Overlap masks on byte boundaries. For example, if\n  (granularity) is 2, then {A0:B0:C0, A1:B1:C1} (2 masks spanning 6 bytes, with\n  the low bytes being A0 and A1) would be processed as though it were\n  {A0:B0:C0, B0:C0:A1, C0:A1:B1, A1:B1:C1}. This can improve search quality in\n  cases where context matters, as opposed to merely the frequency distribution\n  of symbols. It only affects search -- not preprocessing.\n\n  bits 8-9: (mode) tells the type of entropy to use when computing the\n  divergence from the distribution inside the sweep window (the sliding window\n  within a given (haystack) file) to (and perhaps also from) (needle):\n\n    00 for divcompressivity (fast approximation of the Kullback-Leibler\n    divergence).\n\n    01 for (1-(Leidich divergence)) (AKA \"negated LD\") (medium speed, weights\n    distributions by file size).\n\n    10 for (1-(normalized Jensen-Shannon divergence)) (AKA \"negated JSD\")\n    (slowest, cares about distributions, not file sizes).\n\n    11 Reserved.\n\n");
       DEBUG_PRINT("(sweep) is the nonzero number of masks in the sliding haystack window, except\nfor the following special cases: \"e\" or \"i\" to find only exact matches or\ncase-insensitive exact matches, respectively; or \"n\" or \"h\" to find approximate\nmatches the same size as (needle) or (haystack), respectively. For example, 5\nmeans: a 5-byte window if (granularity)=0, a 10-byte window if (granularity)=1\nand (overlap)=0, or a 7-byte window if (granularity)=2 and (overlap)=1. Prefix\nwith \"+\" to treat the first (sweep) bytes of the file as the entire haystack\nor \"-\" for the same with the last (sweep) masks.\n\n");
-      DEBUG_PRINT("(ranks) is the nonzero number of slots in the list of (best) matches. Matches\nwill be reported as 0-based file offsets or filenames when haystack is a file\nor folder, respectively. In either case, results will be sorted in the order\nimplied by granularity, such that lesser offsets and files encountered earlier\nwill prevail in case of a tie. If (ranks) is prefixed with \"@\", then results\nwill be delivered to the folder or file following that symbol. In this case\nthey will be sorted by sweep window base offset, and not by entropy. Each\nresult will be an 8-byte fracterval mean (center) if (precise) is 0, else a\npair of 16-byte fracterval low and high values if (precise) is 1. In this way,\nit's possible to dump the results of an entire entropy transform. If (haystack)\nis a file in this case, then (ranks) will be treated as a file; otherwise it\nwill be treated as a folder.\n\n");
+      DEBUG_PRINT("(ranks) is the nonzero number of slots in the list of (best) matches. Matches\nwill be reported as 0-based file offsets or filenames when haystack is a file\nor folder, respectively. In either case, results will be sorted in the order\nimplied by granularity, such that lesser offsets and files encountered earlier\nwill prevail in case of a tie. If (ranks) is prefixed with \"@\", then results\nwill be delivered to the folder or file following that symbol. In this case\nthey will be sorted by sweep window base offset, and not by entropy. Each\nresult will be an 8-byte fracterval mean (center) if (precise) is 0, else a\npair of 16-byte fracterval low and high values if (precise) is 1. In this way,\nit's possible to dump the results of an entire entropy transform. If (haystack)\nis a file in this case, then (ranks) will be treated as a file; otherwise it\nwill be treated as a folder. If (haystack) is a folder, then (ranks) may instead\nbe followed by \"#\" and the name of a rank file, for example \"10#ranks.bin\".\nThe results will then be merged with those saved there by previous runs, if\nany, and the merged results will be saved back to it. In this way, a corpus can\nbe searched one folder at a time, even on different machines, then ranked as a\nwhole. All such runs must use the same parameters, and a file which is searched\nmore than once will be ranked more than once.\n\n");
       DEBUG_PRINT("(format) is a hex bitmap which controls output formatting:\n\n  bit 0: (merge) Prevent the reporting of more than 1 match per sweep. This is\n  useful for filtering because usually many matches occur within the same\n  sweep. In either case, a sweep with global minimum or maximum score will be\n  reported at rank 0. Ignored when (haystack) is a folder.\n\n  bit 1: (ascending) Display worst matches first. Either way, ties will be\n  resolved in favor of lower sweep offsets.\n\n  bit 2: (cavalier) Do not report errors encountered after commencing analysis.\n\n  bit 3: (progress) Make verbose comments about compute progress.\n\n  bit 4: (precise) Set to display entropy values as 64.64 fixed-point hex\n  fractervals. Fractervals are displayed as {(A.B), (C.D)} where (A.B) is the\n  lower bound and (C.D) is (1/(2^64)) less than the upper bound.\n\n");
       DEBUG_PRINT("The following options are only valid when haystack is a file:\n\n");
       DEBUG_PRINT("(dump_delta) is the number of bytes after the base of a match at which to start\ndumping, such that 0 means to start at the match itself. Prefix with \"-\" to\nindicate a negative value. Reported match offsets will be adjusted accordingly,\nsaturating to [0, (haystack size)-1].\n\n");
@@ -375,10 +746,25 @@ main(int argc, char *argv[]){
       append_mode=2;
     }else{
 /*
+Split off the rank file, if any, which follows "#".
+*/
+      out_filename_char_idx=0;
+      while(out_filename_char_idx!=out_filename_size){
+        if(out_filename_base[out_filename_char_idx]=='#'){
+          out_filename_base[out_filename_char_idx]=0;
+          rank_filename_base=&out_filename_base[out_filename_char_idx+1];
+          break;
+        }
+        out_filename_char_idx++;
+      }
+/*
 Don't accept ranks larger than we can fit in the address space, considering that it will be used to allocate *entropy_list_base0, which consists of u128 fractervals.
 */
       status=ascii_decimal_to_u64_convert(argv[5], &parameter, ULONG_MAX>>(U128_SIZE_LOG2+1));
       status=(u8)(status|!parameter);
+      if(rank_filename_base){
+        status=(u8)(status|!rank_filename_base[0]);
+      }
       if(status){
         agnentrofind_parameter_error_print("ranks");
         break;
@@ -486,6 +872,27 @@ We need to allocate space for the full dump filename, which will contain the exi
     }
     needle_filename_base=argv[1];
     needle_prefix=needle_filename_base[0];
+    needle_list_status=(needle_prefix=='%');
+    if(needle_list_status){
+      status=1;
+      if(sweep_status==AGNENTROFIND_SWEEP_STATUS_NEEDLE){
+        agnentrofind_error_print("A (needle) list doesn't allow (sweep) to be \"n\"");
+        break;
+      }else if((sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)&&(mode!=AGNENTROPROX_MODE_DIVENTROPY)){
+        agnentrofind_error_print("Approximate matching with a (needle) list requires (mode) to be 00");
+        break;
+      }else if(append_mode==2){
+        agnentrofind_error_print("A (needle) list is not allowed when (ranks) is prefixed with \"@\"");
+        break;
+      }else if(delta_count|densify_status|surroundify_status){
+        agnentrofind_error_print("Deltafication, densification, and surroundification are not allowed with a\n(needle) list");
+        break;
+      }else if(merge_status){
+        agnentrofind_error_print("Merging is not allowed with a (needle) list");
+        break;
+      }
+      needle_filename_base=&needle_filename_base[1];
+    }
     needle_file_size=0;
     needle_mask_idx_max=0;
     needle_filename_size=(ULONG)(strlen(needle_filename_base));
@@ -510,10 +917,56 @@ We need to allocate space for the full dump filename, which will contain the exi
         }
       }
     }
-    needle_mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, needle_file_size, overlap_status);
     needle_mask_idx_max_parallel=0;
-    if(delta_count|densify_status|surroundify_status){
-      needle_mask_idx_max_parallel=agnentroprox_mask_idx_max_get(granularity, &granularity_status, needle_file_size, 0);
+    if(!needle_list_status){
+      needle_mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, needle_file_size, overlap_status);
+      if(delta_count|densify_status|surroundify_status){
+        needle_mask_idx_max_parallel=agnentroprox_mask_idx_max_get(granularity, &granularity_status, needle_file_size, 0);
+      }
+    }else{
+/*
+Read the needle list, then allocate one needle size per line and enough space to hold all the needles, which can only shrink on conversion from text.
+*/
+      if(!needle_file_size){
+        agnentrofind_error_print("(needle) list is empty");
+        break;
+      }
+      needle_list_char_list_base=filesys_char_list_malloc(needle_file_size);
+      if(!needle_list_char_list_base){
+        agnentrofind_out_of_memory_print();
+        break;
+      }
+      filesys_status=filesys_file_read_exact(needle_file_size, needle_filename_base, needle_list_char_list_base);
+      if(filesys_status){
+        if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
+          agnentrofind_error_print("(needle) size changed during execution");
+          break;
+        }else{
+          agnentrofind_error_print("Could not read (needle)");
+          break;
+        }
+      }
+      needle_list_char_list_base[needle_file_size]=0;
+      needle_idx_max_max=0;
+      needle_list_char_idx=0;
+      do{
+        needle_idx_max_max+=(needle_list_char_list_base[needle_list_char_idx]=='\n');
+      }while((++needle_list_char_idx)!=needle_file_size);
+      needle_mask_idx_max_list_base=agnentroprox_ulong_list_malloc(needle_idx_max_max);
+      needle_mask_list_base=agnentroprox_mask_list_malloc(0, needle_file_size-1, 1);
+      if(!(needle_mask_idx_max_list_base&&needle_mask_list_base)){
+        agnentrofind_out_of_memory_print();
+        break;
+      }
+      status=agnentrofind_needle_list_parse(granularity, &granularity_status, &needle_idx_max, needle_list_char_list_base, needle_file_size, &needle_mask_idx_max, needle_mask_idx_max_list_base, needle_mask_list_base, overlap_status);
+      if(status){
+        break;
+      }
+      status=1;
+      if(granularity_status&&!cavalier_status){
+        agnentrofind_warning_print("Some (needle) list sizes aren't a multiple of (granularity+1), so tail\nbytes will be ignored");
+      }
+      granularity_status=0;
     }
     granularity_channelized=granularity;
     mask_size=(u8)(granularity+1);
@@ -533,7 +986,9 @@ We need to allocate space for the full dump filename, which will contain the exi
     if((sweep_status==AGNENTROFIND_SWEEP_STATUS_EXACT)||(sweep_status==AGNENTROFIND_SWEEP_STATUS_NEEDLE)){
       sweep_mask_idx_max_max=needle_mask_idx_max;
     }
-    needle_mask_list_base=agnentroprox_mask_list_malloc(granularity, needle_mask_idx_max, overlap_status);
+    if(!needle_list_status){
+      needle_mask_list_base=agnentroprox_mask_list_malloc(granularity, needle_mask_idx_max, overlap_status);
+    }
     if(!needle_mask_list_base){
       agnentrofind_out_of_memory_print();
       break;
@@ -551,7 +1006,7 @@ We need to allocate space for the full dump filename, which will contain the exi
       status=1;
     }else if(needle_prefix=='@'){
       memcpy(&needle_mask_list_base[0], &needle_filename_base[1], (size_t)(needle_filename_size_minus_1));
-    }else{
+    }else if(!needle_list_status){
       filesys_status=filesys_file_read_exact(needle_file_size, needle_filename_base, needle_mask_list_base);
       if(filesys_status){
         if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
@@ -564,31 +1019,17 @@ We need to allocate space for the full dump filename, which will contain the exi
       }
     }
     haystack_filename_base=argv[2];
-    fatal_status=0;
     haystack_file_size_max=0;
     haystack_filename_count=0;
     haystack_filename_list_size=U16_MAX;
-    retry_status=0;
-    do{
-      haystack_filename_list_char_idx_max=haystack_filename_list_size-1;
-      haystack_filename_list_base=filesys_char_list_malloc(haystack_filename_list_char_idx_max);
-      if(!haystack_filename_list_base){
-        fatal_status=1;
-        agnentrofind_out_of_memory_print();
-        break;
-      }
-      haystack_filename_list_size_new=haystack_filename_list_size;
-      retry_status=filesys_filename_list_get(&fatal_status, &haystack_file_size_max, &file_status, &haystack_filename_count, haystack_filename_list_base, &haystack_filename_list_size_new, haystack_filename_base);
-      if(fatal_status){
-        agnentrofind_error_print("(haystack) not found or inaccessible");
-        break;
-      }
-      if(retry_status){
-        haystack_filename_list_base=filesys_free(haystack_filename_list_base);
-        haystack_filename_list_size=haystack_filename_list_size_new;
-      }
-    }while(retry_status);
-    if(fatal_status){
+    haystack_filename_list_base=filesys_char_list_malloc(haystack_filename_list_size);
+    if(!haystack_filename_list_base){
+      agnentrofind_out_of_memory_print();
+      break;
+    }
+    status=filesys_filename_list_get(&haystack_file_size_max, &file_status, &haystack_filename_count, &haystack_filename_list_base, &haystack_filename_list_size, haystack_filename_base);
+    if(status){
+      agnentrofind_error_print("(haystack) not found or inaccessible");
       break;
     }
     status=filesys_filename_list_sort(haystack_filename_count, haystack_filename_list_base);
@@ -635,6 +1076,10 @@ Ignore the return status of agnentroprox_mask_idx_max_get() because it doesn't m
         agnentrofind_error_print("Dumping or merging is not allowed if (haystack) is a folder");
         status=1;
         break;
+      }else if(needle_list_status&&(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)){
+        agnentrofind_error_print("Approximate matching with a (needle) list requires (haystack) to be a file");
+        status=1;
+        break;
       }
       if(append_mode<=1){
         match_idx_max_max=0;
@@ -646,6 +1091,11 @@ If we're in exact match mode, then set match_idx_max_max to ULONG_MAX because we
         match_idx_max_max--;
       }
     }else{
+      if(rank_filename_base){
+        agnentrofind_error_print("A rank file is only allowed if (haystack) is a folder");
+        status=1;
+        break;
+      }
       if(dump_status==2){
         dump_size_max=dump_size;
         if(!dump_size){
@@ -665,17 +1115,51 @@ If we're in exact match mode, then set match_idx_max_max to ULONG_MAX because we
         }
       }
     }
-    entropy_list_base0=fracterval_u128_rank_list_malloc(rank_idx_max_max);
+    entropy_list_idx_max=rank_idx_max_max;
+    if((!file_status)&&(append_mode<=1)){
+/*
+Folder results are ranked in *haystack_rank_list_base, so each transform only needs to return the entropy extremum.
+*/
+      entropy_list_idx_max=0;
+    }
+    if(needle_list_status&&(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)){
+/*
+Give each needle its own list of (ranks) matches, plus the item of scratch space which agnentroprox_multidiventropy_transform() requires. The matches of all the needles will be gathered at the base of these lists afterwards.
+*/
+      needle_count=needle_idx_max+1;
+      entropy_list_idx_max=(rank_idx_max_max+2)*needle_count;
+      status=(u8)(status|((entropy_list_idx_max/needle_count)!=(rank_idx_max_max+2)));
+      entropy_list_idx_max-=2;
+      match_count_list_base=agnentroprox_ulong_list_malloc(needle_idx_max);
+      status=(u8)(status|!match_count_list_base);
+    }
+    if(!status){
+      entropy_list_base0=fracterval_u128_rank_list_malloc(entropy_list_idx_max);
+    }
     status=(u8)(status|!entropy_list_base0);
-    entropy_list_base1=fracterval_u128_rank_list_malloc(0);
-    status=(u8)(status|!entropy_list_base1);
-    haystack_filename_idx_list_base=agnentroprox_ulong_list_malloc(rank_idx_max_max);
-    status=(u8)(status|!haystack_filename_idx_list_base);
     haystack_mask_list_base=agnentroprox_mask_list_malloc(granularity, haystack_mask_idx_max_max, overlap_status);
     status=(u8)(status|!haystack_mask_list_base);
+    if((!clip_mode)&&(haystack_filename_count!=1)&&(haystack_file_size_max<=AGNENTROFIND_PREFETCH_SIZE_MAX)){
+/*
+Allocate a second haystack buffer so that the next haystack can be read on another thread while the current one is being analyzed. This is just an optimization, so failure isn't an error.
+*/
+      haystack_prefetch_mask_list_base=agnentroprox_mask_list_malloc(granularity, haystack_mask_idx_max_max, overlap_status);
+    }
+    if(!file_status){
+      haystack_rank_list_base=agnentroprox_rank_list_malloc(rank_idx_max_max);
+      status=(u8)(status|!haystack_rank_list_base);
+    }
     if(file_status){
-      match_u8_idx_list_base=agnentroprox_ulong_list_malloc(match_idx_max_max);
+      match_list_idx_max=match_idx_max_max;
+      if(needle_list_status&&(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)){
+        match_list_idx_max=entropy_list_idx_max+1;
+      }
+      match_u8_idx_list_base=agnentroprox_ulong_list_malloc(match_list_idx_max);
       status=(u8)(status|!match_u8_idx_list_base);
+      if(needle_list_status){
+        match_needle_idx_list_base=agnentroprox_ulong_list_malloc(match_list_idx_max);
+        status=(u8)(status|!match_needle_idx_list_base);
+      }
     }
     mask_max=(1U<<(granularity<<U8_BITS_LOG2)<<U8_BITS)-1;
     if(densify_status){
@@ -689,11 +1173,32 @@ If we're in exact match mode, then set match_idx_max_max to ULONG_MAX because we
       break;
     }
     status=1;
-    agnentroprox_base=agnentroprox_init(AGNENTROPROX_BUILD_BREAK_COUNT_EXPECTED, 4, granularity, loggamma_base, haystack_mask_idx_max_max, mask_max, mode, overlap_status, sweep_mask_idx_max_max);
+    agnentroprox_base=agnentroprox_init(AGNENTROPROX_BUILD_BREAK_COUNT_EXPECTED, 12, granularity, loggamma_base, haystack_mask_idx_max_max, mask_max, mode, overlap_status, sweep_mask_idx_max_max);
     if(!agnentroprox_base){
       agnentrofind_out_of_memory_print();
       break;
     }
+    if(needle_list_status){
+      if(sweep_status==AGNENTROFIND_SWEEP_STATUS_EXACT){
+        if(progress_status){
+          DEBUG_PRINT("Building automaton from (needle) list...\n");
+        }
+        multimatch_base=agnentroprox_multimatch_init(append_mode, case_insensitive_status, granularity, needle_idx_max, needle_mask_idx_max_list_base, needle_mask_list_base, overlap_status);
+        if(!multimatch_base){
+          agnentrofind_out_of_memory_print();
+          break;
+        }
+      }else{
+        if(progress_status){
+          DEBUG_PRINT("Loading (needle) list frequencies...\n");
+        }
+        multineedle_base=agnentroprox_multineedle_init(agnentroprox_base, needle_idx_max, needle_mask_idx_max_list_base, needle_mask_list_base);
+        if(!multineedle_base){
+          agnentrofind_out_of_memory_print();
+          break;
+        }
+      }
+    }
     if(delta_count){
       if(progress_status){
         DEBUG_PRINT("Computing ");
@@ -714,14 +1219,9 @@ If we're in exact match mode, then set match_idx_max_max to ULONG_MAX because we
         }
         DEBUG_PRINT(" channelization...\n");
       }
-/*
-As specified in the help text, any remainder bytes will be unchanged by deltafication. We are guaranteed at least one full mask, due to agnentroprox_mask_idx_max_get() returning good status.
-*/
-      delta_idx=0;
-      do{
-        maskops_deltafy(channel_status, 1, granularity, needle_mask_idx_max_parallel, needle_mask_list_base);
-      }while((delta_idx++)!=delta_count);
     }
+    haystack_mask_max=0;
+    haystack_mask_min=0;
     joint_mask_max_densify=0;
     joint_mask_min_densify=0;
     joint_mask_max_surroundify=0;
@@ -729,13 +1229,20 @@ As specified in the help text, any remainder bytes will be unchanged by deltafic
     needle_mask_max=0;
     needle_mask_min=0;
     needle_sign_status=0;
-    if(densify_status|surroundify_status){
-      needle_sign_status=maskops_unsign(granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, &needle_mask_max, &needle_mask_min);
+    if(delta_count|densify_status|surroundify_status){
+/*
+Deltafy and unsign in at most 2 passes. As specified in the help text, any remainder bytes will be unchanged by deltafication. We are guaranteed at least one full mask, due to agnentroprox_mask_idx_max_get() returning good status. Note that nonzero (deltas) has always resulted in one more delta than its face value, which must remain the case for consistency with undeltafication below as well as preexisting results.
+*/
+      sign_mode=MASKOPS_SIGN_MODE_KEEP;
+      if(densify_status|surroundify_status){
+        sign_mode=MASKOPS_SIGN_MODE_UNSIGN;
+      }
+      needle_mask_min=maskops_pipeline(NULL, channel_status, (u8)(delta_count+(!!delta_count)), granularity, needle_mask_idx_max_parallel, needle_mask_list_base, &needle_mask_max, sign_mode, &needle_sign_status);
     }
 /*
 If (sweep_status==AGNENTROFIND_SWEEP_STATUS_EXACT), then we need to look for exact matches, otherwise approximate ones, using entirely different Agnentroprox functions. In the former case, *rank_list_base will end up containing sorted maximum match counts; in the latter, it will end up containing sorted divcompressivities.
 */
-    if(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT){
+    if((sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)&&!needle_list_status){
       agnentroprox_mask_list_load(agnentroprox_base, 0, needle_mask_idx_max, needle_mask_list_base);
     }
     entropy_raw=agnentroprox_entropy_raw_get(agnentroprox_base, needle_mask_idx_max, &overflow_status);
@@ -766,7 +1273,31 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
         haystack_file_size=sweep_size;
         filesys_status=filesys_subfile_read_next(direction_status, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_file_size, 0, haystack_mask_list_base);
       }else{
-        filesys_status=filesys_file_read_next(&haystack_file_size, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_mask_list_base);
+        if(!haystack_prefetch_handle_base){
+          filesys_status=filesys_file_read_next(&haystack_file_size, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_mask_list_base);
+        }else{
+/*
+Wait for the haystack which was prefetched during the previous iteration, then swap it in.
+*/
+          thread_async_finish(haystack_prefetch_handle_base);
+          haystack_prefetch_handle_base=NULL;
+          filesys_status=haystack_prefetch.status;
+          haystack_file_size=haystack_prefetch.file_size_max;
+          haystack_filename_list_char_idx_new=haystack_prefetch.filename_idx;
+          haystack_prefetch.void_list_base=haystack_mask_list_base;
+          haystack_mask_list_base=haystack_prefetch_mask_list_base;
+          haystack_prefetch_mask_list_base=(u8 *)(haystack_prefetch.void_list_base);
+        }
+        if(haystack_prefetch_mask_list_base&&((haystack_filename_idx+1)!=haystack_filename_count)){
+/*
+Start reading the next haystack. Only haystack_prefetch_mask_list_base will be written, and haystack_filename_list_base will only be read, so analysis of the current haystack can proceed in parallel. If the thread can't be created, then haystack_prefetch_handle_base is NULL, so the next iteration will just read the haystack itself.
+*/
+          haystack_prefetch.file_size_max=haystack_file_size_max;
+          haystack_prefetch.filename_idx=haystack_filename_list_char_idx_new;
+          haystack_prefetch.filename_list_base=haystack_filename_list_base;
+          haystack_prefetch.void_list_base=haystack_prefetch_mask_list_base;
+          haystack_prefetch_handle_base=thread_async_start(&filesys_file_read_next_thread, &haystack_prefetch);
+        }
       }
       if(!filesys_status){
         haystack_mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, haystack_file_size, overlap_status);
@@ -808,17 +1339,18 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
                 }
                 DEBUG_PRINT(" channelization...\n");
               }
-              delta_idx=0;
-              do{
-                maskops_deltafy(channel_status, 1, granularity, haystack_mask_idx_max_parallel, haystack_mask_list_base);
-              }while((delta_idx++)!=delta_count);
             }
-            if(densify_status|surroundify_status){
-              if(!needle_sign_status){
-                haystack_mask_min=maskops_max_min_get(granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, &haystack_mask_max, 0);
-              }else{
-                haystack_mask_min=maskops_negate(granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, &haystack_mask_max);
+            if(delta_count|densify_status|surroundify_status){
+/*
+Deltafy and negate the haystack if and only if the needle was negated, in at most 2 passes. The densification footprint can't be marked here because it depends on the joint mask range.
+*/
+              sign_mode=MASKOPS_SIGN_MODE_KEEP;
+              if(needle_sign_status){
+                sign_mode=MASKOPS_SIGN_MODE_NEGATE;
               }
+              haystack_mask_min=maskops_pipeline(NULL, channel_status, (u8)(delta_count+(!!delta_count)), granularity, haystack_mask_idx_max_parallel, haystack_mask_list_base, &haystack_mask_max, sign_mode, &haystack_sign_status);
+            }
+            if(densify_status|surroundify_status){
               joint_mask_max_densify=MAX(haystack_mask_max, needle_mask_max);
               joint_mask_max_finalize=joint_mask_max_densify;
               joint_mask_max_surroundify=joint_mask_max_densify;
@@ -828,13 +1360,13 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
                 if(progress_status){
                   DEBUG_PRINT("Densifying needle and haystack...\n");
                 }
-                maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_max_densify, joint_mask_min_densify, 1);
-                maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_max_densify, joint_mask_min_densify, 0);
-                joint_mask_max_finalize=maskops_densify_remask_prepare(maskops_bitmap_base, 1, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_bitmap_prepare_parallel(maskops_bitmap_base, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_max_densify, joint_mask_min_densify, 1, thread_idx_max);
+                maskops_densify_bitmap_prepare_parallel(maskops_bitmap_base, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_max_densify, joint_mask_min_densify, 0, thread_idx_max);
+                joint_mask_max_finalize=maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 1, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
                 joint_mask_max_surroundify=joint_mask_max_finalize;
                 joint_mask_min_surroundify=0;
-                maskops_densify(1, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_min_densify, maskops_u32_list_base);
-                maskops_densify(1, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_parallel(1, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
+                maskops_densify_parallel(1, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
               }
               if(surroundify_status){
                 if(progress_status){
@@ -872,9 +1404,6 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
               }
             }
             rank_list_base=entropy_list_base0;
-            if((append_mode<=1)&&(!file_status)){
-              rank_list_base=entropy_list_base1;
-            }
             if(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT){
               if(mode==AGNENTROPROX_MODE_JSDT){
                 match_count=agnentroprox_jsd_transform(agnentroprox_base, append_mode, haystack_mask_idx_max, haystack_mask_list_base, rank_list_base, match_idx_max_max, match_u8_idx_list_base, sweep_mask_idx_max);
@@ -882,7 +1411,7 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
               }else if(mode==AGNENTROPROX_MODE_LDT){
                 match_count=agnentroprox_ld_transform(agnentroprox_base, append_mode, haystack_mask_idx_max, haystack_mask_list_base, rank_list_base, match_idx_max_max, match_u8_idx_list_base, sweep_mask_idx_max);
                 entropy=rank_list_base[0];
-              }else{
+              }else if(!needle_list_status){
                 if(append_mode<=1){
                   append_mode=!append_mode;
                 }
@@ -895,10 +1424,46 @@ We're guaranteed at least one match, so go ahead and convert it to divcompressiv
 */
                 entropy=rank_list_base[0];
                 entropy=agnentroprox_compressivity_get(entropy, entropy_raw);
+              }else{
+                agnentroprox_multidiventropy_transform(agnentroprox_base, !append_mode, rank_list_base, haystack_mask_idx_max, haystack_mask_list_base, match_count_list_base, match_idx_max_max, match_u8_idx_list_base, multineedle_base, &overflow_status, sweep_mask_idx_max);
+/*
+Gather the matches of all the needles at the base of the lists, converting each to divcompressivity with respect to its own needle. The best match of each needle is at its own rank zero, so compare only those in order to find the best match overall. A needle might have no matches at all, so skip it in that case, and report zero if no needle matched.
+*/
+                FRU128_SET_ZERO(entropy);
+                match_count=0;
+                match_list_idx=0;
+                needle_idx=0;
+                do{
+                  entropy_raw=agnentroprox_entropy_raw_get(agnentroprox_base, needle_mask_idx_max_list_base[needle_idx], &overflow_status);
+                  match_idx=0;
+                  needle_match_count=match_count_list_base[needle_idx];
+                  if(needle_match_count){
+                    do{
+                      entropy_needle=rank_list_base[match_list_idx+match_idx];
+                      entropy_needle=agnentroprox_compressivity_get(entropy_needle, entropy_raw);
+                      rank_list_base[match_count]=entropy_needle;
+                      match_needle_idx_list_base[match_count]=needle_idx;
+                      match_u8_idx_list_base[match_count]=match_u8_idx_list_base[match_list_idx+match_idx];
+                      if(!match_idx){
+                        FRU128_MEAN_TO_FTD128(entropy_mean, entropy_needle);
+                        if((!match_count)||((!append_mode)&&U128_IS_LESS(score, entropy_mean))||(append_mode&&U128_IS_LESS(entropy_mean, score))){
+                          entropy=entropy_needle;
+                          score=entropy_mean;
+                        }
+                      }
+                      match_count++;
+                    }while((++match_idx)!=needle_match_count);
+                  }
+                  match_list_idx+=match_idx_max_max+2;
+                }while((needle_idx++)!=needle_idx_max);
               }
               FRU128_MEAN_TO_FTD128(score, entropy);
             }else{
-              match_count=agnentroprox_match_find(append_mode, case_insensitive_status, granularity, haystack_mask_idx_max, haystack_mask_list_base, match_idx_max_max, match_u8_idx_list_base, needle_mask_idx_max, needle_mask_list_base, overlap_status);
+              if(!needle_list_status){
+                match_count=agnentroprox_match_find(append_mode, case_insensitive_status, granularity, haystack_mask_idx_max, haystack_mask_list_base, match_idx_max_max, match_u8_idx_list_base, needle_mask_idx_max, needle_mask_list_base, overlap_status);
+              }else{
+                match_count=agnentroprox_multimatch_find(haystack_mask_idx_max, haystack_mask_list_base, match_idx_max_max, match_needle_idx_list_base, match_u8_idx_list_base, multimatch_base);
+              }
               U128_FROM_U64_HI(score, (u64)(match_count));
               FRU128_FROM_FTD128(entropy, score);
             }
@@ -917,9 +1482,9 @@ We're guaranteed at least one match, so go ahead and convert it to divcompressiv
                 if(progress_status){
                   DEBUG_PRINT("Undensifying haystack...\n");
                 }
-                maskops_densify_remask_prepare(maskops_bitmap_base, 0, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 0, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
                 remask_status=1;
-                maskops_densify(0, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_parallel(0, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
               }
               if(needle_sign_status){
                 maskops_negate(granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, &haystack_mask_max);
@@ -946,9 +1511,9 @@ We're guaranteed at least one match, so go ahead and convert it to divcompressiv
                   DEBUG_PRINT("Undensifying needle...\n");
                 }
                 if(!remask_status){
-                  maskops_densify_remask_prepare(maskops_bitmap_base, 0, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base);
+                  maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 0, joint_mask_max_densify, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
                 }
-                maskops_densify(0, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_parallel(0, granularity_channelized, needle_mask_idx_max_parallel_channelized, needle_mask_list_base, joint_mask_min_densify, maskops_u32_list_base, thread_idx_max);
               }
             }
             if(append_mode==2){
@@ -1003,23 +1568,12 @@ We're guaranteed at least one match, so go ahead and convert it to divcompressiv
               if(!file_status){
                 if(U128_IS_NOT_ZERO(score)||(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)){
                   status=1;
-                  if((!append_mode)&&U128_IS_LESS_EQUAL(score_threshold, score)){
-                    status=fracterval_u128_rank_list_insert_descending(entropy, &rank_count, &rank_idx, rank_idx_max_max, entropy_list_base0, &score_threshold);
-                  }else if((append_mode==1)&&U128_IS_LESS_EQUAL(score, score_threshold)){
-                    status=fracterval_u128_rank_list_insert_ascending(entropy, &rank_count, &rank_idx, rank_idx_max_max, entropy_list_base0, &score_threshold);
-                  }
-                  if(!status){
-                    rank_idx_min=rank_idx;
-                    rank_idx=rank_count-1;
-                    while(rank_idx!=rank_idx_min){
-                      haystack_filename_idx_list_base[rank_idx]=haystack_filename_idx_list_base[rank_idx-1];
-                      rank_idx--;
-                    }
-                    haystack_filename_idx_list_base[rank_idx]=haystack_filename_list_char_idx;
+                  if(((!append_mode)&&U128_IS_LESS_EQUAL(score_threshold, score))||((append_mode==1)&&U128_IS_LESS_EQUAL(score, score_threshold))){
+                    agnentroprox_rank_list_insert(append_mode, entropy, (u64)(haystack_filename_list_char_idx), &rank_count, rank_idx_max_max, haystack_rank_list_base, &score_threshold, 0);
                   }
                   status=0;
                 }
-              }else if((mode!=AGNENTROPROX_MODE_JSDT)&&(mode!=AGNENTROPROX_MODE_LDT)&&(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)){
+              }else if((mode!=AGNENTROPROX_MODE_JSDT)&&(mode!=AGNENTROPROX_MODE_LDT)&&(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT)&&!needle_list_status){
 /*
 Convert all matches to divcompressivity.
 */
@@ -1116,6 +1670,22 @@ Don't attempt to merge ranking sweeps in haystack mode, as there's only one entr
 */
        sweep_size=0;
     }
+    if(rank_filename_base){
+      if(progress_status){
+        DEBUG_PRINT("Merging with rank file...\n");
+      }
+      status=agnentrofind_rank_file_merge(append_mode, haystack_filename_list_base, haystack_filename_list_size, &rank_count, rank_filename_base, &rank_filename_list_base, rank_idx_max_max, haystack_rank_list_base);
+      if(status){
+        break;
+      }
+/*
+The ranks now refer to the filenames in the rank file, not in the haystack.
+*/
+      filesys_free(haystack_filename_list_base);
+      haystack_filename_list_base=rank_filename_list_base;
+      rank_filename_list_base=NULL;
+      status=1;
+    }
     if(append_mode<=1){
       if(progress_status){
         if(match_count|rank_count){
@@ -1148,7 +1718,7 @@ Don't attempt to merge ranking sweeps in haystack mode, as there's only one entr
       if(!file_status){
         rank_idx=0;
         while(rank_idx<rank_count){
-          entropy=entropy_list_base0[rank_idx];
+          entropy=haystack_rank_list_base[rank_idx].entropy;
           if((!precise_status)|(sweep_status==AGNENTROFIND_SWEEP_STATUS_EXACT)){
             FRU128_MEAN_TO_FTD128(score, entropy);
             U128_TO_U64_HI(score_u64, score);
@@ -1157,7 +1727,8 @@ Don't attempt to merge ranking sweeps in haystack mode, as there's only one entr
             DEBUG_F128_PAIR("", entropy.a, entropy.b);
           }
           DEBUG_PRINT(" ");
-          DEBUG_WRITE(&haystack_filename_list_base[haystack_filename_idx_list_base[rank_idx]]);
+          haystack_filename_list_char_idx=(ULONG)(haystack_rank_list_base[rank_idx].file_idx);
+          DEBUG_WRITE(&haystack_filename_list_base[haystack_filename_list_char_idx]);
           rank_idx++;
         }
       }else{
@@ -1227,12 +1798,19 @@ Get rid of overlapping sweep regions, prioritizing those of inferior rank for re
                 }
               }
               match_u8_idx_list_base[match_idx]=match_u8_idx;
+              if(match_needle_idx_list_base){
+                match_needle_idx_list_base[match_idx]=match_needle_idx_list_base[match_idx_old-1];
+              }
               match_idx++;
             }while(match_idx_old!=match_count);
             match_count=match_idx;
           }
           match_idx=0;
           do{
+            if(match_needle_idx_list_base){
+              DEBUG_U64("", (u64)(match_needle_idx_list_base[match_idx]));
+              DEBUG_PRINT(" ");
+            }
             if(sweep_status!=AGNENTROFIND_SWEEP_STATUS_EXACT){
               entropy=entropy_list_base0[match_idx];
               if(!precise_status){
@@ -1309,19 +1887,26 @@ We shouldn't report the error because we've been told not to, which is probably
     }
     status=0;
   }while(0);
+  thread_async_finish(haystack_prefetch_handle_base);
+  agnentroprox_multineedle_free_all(multineedle_base);
+  agnentroprox_multimatch_free_all(multimatch_base);
   agnentroprox_free_all(agnentroprox_base);
   maskops_free(maskops_u32_list_base);
   maskops_free(maskops_bitmap_base);
   agnentroprox_free(match_u8_idx_list_base);
+  agnentroprox_free(match_needle_idx_list_base);
+  agnentroprox_free(match_count_list_base);
+  agnentroprox_free(haystack_rank_list_base);
+  agnentroprox_free(haystack_prefetch_mask_list_base);
   agnentroprox_free(haystack_mask_list_base);
-  agnentroprox_free(haystack_filename_idx_list_base);
-  fracterval_u128_free(entropy_list_base1);
   fracterval_u128_free(entropy_list_base0);
   filesys_free(dump_filename_base);
   ascii_free(dump_u8_list_base);
   filesys_free(out_filename_list_base);
   filesys_free(haystack_filename_list_base);
   agnentroprox_free(needle_mask_list_base);
+  agnentroprox_free(needle_mask_idx_max_list_base);
+  filesys_free(needle_list_char_list_base);
   loggamma_free_all(loggamma_base);
   DEBUG_ALLOCATION_CHECK();
   return status;
@@ -26,8 +26,10 @@ Logarithmic Mask Logization Utility
 #include "flag.h"
 #include "flag_ascii.h"
 #include "flag_filesys.h"
+#include "flag_thread.h"
 #include "flag_agnentrolog.h"
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "constant.h"
 #include "debug.h"
@@ -37,6 +39,96 @@ Logarithmic Mask Logization Utility
 #include "bitscan_xtrn.h"
 #include "filesys.h"
 #include "filesys_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
+
+#define AGNENTROLOG_CHUNK_SIZE_MAX 0x4000000U
+/*
+AGNENTROLOG_LOG_GET_KERNEL() is expanded once per possible mask size by AGNENTROLOG_MASK_SIZE_SWITCH, so that (_mask_size) is a constant, whereupon the data-dependent branches in BITSCAN_MSB64_SMALL_GET() can be replaced with a branchless binary search down to the most significant nonzero byte. It operates on the locals of agnentrolog_log_get().
+*/
+#define AGNENTROLOG_LOG_GET_KERNEL(_mask_size) \
+  do{ \
+    AGNENTROLOG_MASK_LOAD(mask_u64, &in_u8_list_base[in_u8_idx], _mask_size); \
+    in_u8_idx+=(_mask_size); \
+    bit_count=0; \
+    if(4<(_mask_size)){ \
+      shift=(u8)(!!(mask_u64>>32)<<5); \
+      mask_u64>>=shift; \
+      bit_count=shift; \
+    } \
+    if(2<(_mask_size)){ \
+      shift=(u8)(!!(mask_u64>>16)<<4); \
+      mask_u64>>=shift; \
+      bit_count=(u8)(bit_count+shift); \
+    } \
+    shift=(u8)(!!(mask_u64>>8)<<3); \
+    mask_u64>>=shift; \
+    bit_count=(u8)(bit_count+shift+bitscan_msb_list_base[mask_u64]+!!mask_u64); \
+    out_u8_list_base[out_u8_idx]=bit_count; \
+    out_u8_idx++; \
+  }while(in_u8_idx<=in_u8_idx_max)
+/*
+AGNENTROLOG_MASK_LOAD() loads a mask of constant size (_mask_size) from (_u8_list_base) into (_mask_u64). Sizes which aren't powers of 2 are assembled from a pair of overlapping loads, which is much faster than an odd-sized memcpy().
+*/
+#define AGNENTROLOG_MASK_LOAD(_mask_u64, _u8_list_base, _mask_size) \
+  do{ \
+    u32 _a; \
+    u32 _b; \
+    u16 _c; \
+    u16 _d; \
+    \
+    if((_mask_size)==3){ \
+      memcpy(&_c, _u8_list_base, (size_t)(2)); \
+      memcpy(&_d, &(_u8_list_base)[1], (size_t)(2)); \
+      _mask_u64=_c|((u64)(_d)<<U8_BITS); \
+    }else if((4<(_mask_size))&&((_mask_size)<8)){ \
+      memcpy(&_a, _u8_list_base, (size_t)(4)); \
+      memcpy(&_b, &(_u8_list_base)[(_mask_size)-4], (size_t)(4)); \
+      _mask_u64=_a|((u64)(_b)<<(((_mask_size)&3)<<U8_BITS_LOG2)); \
+    }else{ \
+      _mask_u64=0; \
+      memcpy(&_mask_u64, _u8_list_base, (size_t)(_mask_size)); \
+    } \
+  }while(0)
+#define AGNENTROLOG_MASK_SIZE_SWITCH(_kernel, _mask_size) \
+  switch(_mask_size){ \
+  case 2: \
+    _kernel(2); \
+    break; \
+  case 3: \
+    _kernel(3); \
+    break; \
+  case 4: \
+    _kernel(4); \
+    break; \
+  case 5: \
+    _kernel(5); \
+    break; \
+  case 6: \
+    _kernel(6); \
+    break; \
+  case 7: \
+    _kernel(7); \
+    break; \
+  default: \
+    _kernel(8); \
+  }
+#define AGNENTROLOG_THREAD_FOOTPRINT_MAX 0x40000000U
+
+TYPEDEF_START
+  ULONG *in_filename_char_idx_list_base;
+  char *in_filename_list_base;
+  u8 *in_u8_list_base;
+  ULONG *out_filename_char_idx_list_base;
+  char *out_filename_list_base;
+  u8 *out_u8_list_base;
+  u8 *status_list_base;
+  ULONG in_chunk_size_max;
+  ULONG in_filename_count;
+  u32 thread_idx;
+  u32 thread_idx_max;
+  u8 mask_size_in;
+TYPEDEF_END(agnentrolog_thread_t)
 
 void
 agnentrolog_error_print(char *char_list_base){
@@ -46,6 +138,50 @@ agnentrolog_error_print(char *char_list_base){
   return;
 }
 
+void
+agnentrolog_log_get(ULONG in_u8_idx_max, u8 *in_u8_list_base, u8 mask_size_in, u8 *out_u8_list_base){
+/*
+Convert one chunk of a mask list to bit counts, which are (floor(log2(M))+1) for each mask M, or zero if M is zero.
+
+In:
+
+  in_u8_idx_max is one less than the size of the chunk, which is a multiple of mask_size_in.
+
+  *in_u8_list_base is the chunk.
+
+  mask_size_in is the size of each mask.
+
+  *out_u8_list_base is writable for (in_u8_idx_max+1)/mask_size_in bytes, and doesn't overlap *in_u8_list_base.
+
+Out:
+
+  *out_u8_list_base contains the bit count of each mask in *in_u8_list_base.
+*/
+  u8 bit_count;
+  ULONG in_u8_idx;
+  u8 mask_u8;
+  u64 mask_u64;
+  ULONG out_u8_idx;
+  u8 shift;
+
+  in_u8_idx=0;
+  out_u8_idx=0;
+  if(mask_size_in==1){
+/*
+Comparing against every threshold is branchless and works on bytes, so the compiler can vectorize it.
+*/
+    do{
+      mask_u8=in_u8_list_base[in_u8_idx];
+      bit_count=(u8)((0<mask_u8)+(1<mask_u8)+(3<mask_u8)+(7<mask_u8)+(15<mask_u8)+(31<mask_u8)+(63<mask_u8)+(127<mask_u8));
+      out_u8_list_base[in_u8_idx]=bit_count;
+      in_u8_idx++;
+    }while(in_u8_idx<=in_u8_idx_max);
+  }else{
+    AGNENTROLOG_MASK_SIZE_SWITCH(AGNENTROLOG_LOG_GET_KERNEL, mask_size_in);
+  }
+  return;
+}
+
 void
 agnentrolog_out_of_memory_print(void){
   agnentrolog_error_print("Out of memory");
@@ -60,45 +196,157 @@ agnentrolog_parameter_error_print(char *char_list_base){
   return;
 }
 
+u8
+agnentrolog_stream(ULONG in_filename_list_char_idx, ULONG out_filename_char_idx, agnentrolog_thread_t *thread_base){
+/*
+Convert one file to one output file of bit counts, streaming it through in chunks.
+
+In:
+
+  in_filename_list_char_idx is the offset of the input filename at thread_base->in_filename_list_base.
+
+  out_filename_char_idx is the offset of the corresponding output filename at thread_base->out_filename_list_base.
+
+  *thread_base is the agnentrolog_thread_t, including the work buffers, which is private to the calling thread.
+
+Out:
+
+  Returns zero on success, else the FILESYS_STATUS constant describing the failure.
+*/
+  u8 filesys_status;
+  ULONG in_chunk_size;
+  ULONG in_chunk_size_max;
+  u64 in_file_size;
+  u64 in_file_u8_idx;
+  ULONG in_filename_char_idx;
+  char *in_filename_list_base;
+  u8 *in_u8_list_base;
+  u8 mask_size_in;
+  char *out_filename_list_base;
+  ULONG out_u8_count;
+  u8 *out_u8_list_base;
+
+  in_chunk_size_max=thread_base->in_chunk_size_max;
+  in_filename_list_base=thread_base->in_filename_list_base;
+  in_u8_list_base=thread_base->in_u8_list_base;
+  mask_size_in=thread_base->mask_size_in;
+  out_filename_list_base=thread_base->out_filename_list_base;
+  out_u8_list_base=thread_base->out_u8_list_base;
+  filesys_status=filesys_file_size_get(&in_file_size, &in_filename_list_base[in_filename_list_char_idx]);
+  if((!filesys_status)&&((!in_file_size)||(in_file_size%mask_size_in))){
+    filesys_status=FILESYS_STATUS_CALLER_CUSTOM;
+  }
+  if(!filesys_status){
+    in_file_u8_idx=0;
+    do{
+      in_chunk_size=in_chunk_size_max;
+      if((in_file_size-in_file_u8_idx)<in_chunk_size){
+        in_chunk_size=(ULONG)(in_file_size-in_file_u8_idx);
+      }
+      in_filename_char_idx=in_filename_list_char_idx;
+      filesys_status=filesys_subfile_read_next(0, &in_filename_char_idx, in_filename_list_base, in_chunk_size, in_file_u8_idx, in_u8_list_base);
+      if(filesys_status){
+        break;
+      }
+      agnentrolog_log_get(in_chunk_size-1, in_u8_list_base, mask_size_in, out_u8_list_base);
+      out_u8_count=in_chunk_size/mask_size_in;
+      if(!in_file_u8_idx){
+        filesys_status=filesys_file_write_obnoxious(out_u8_count, &out_filename_list_base[out_filename_char_idx], out_u8_list_base);
+      }else{
+        filesys_status=filesys_file_append(out_u8_count, &out_filename_list_base[out_filename_char_idx], out_u8_list_base);
+      }
+      if(filesys_status){
+        break;
+      }
+      in_file_u8_idx+=in_chunk_size;
+    }while(in_file_u8_idx!=in_file_size);
+  }
+  return filesys_status;
+}
+
+void *
+agnentrolog_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for main().
+
+Convert every (thread_idx_max+1)th file, starting with file number thread_idx, so that the threads collectively cover the entire file list.
+
+In:
+
+  *thread_base is an agnentrolog_thread_t. Filenames are located through in_filename_char_idx_list_base and out_filename_char_idx_list_base because FileSys temporarily modifies the filenames belonging to other threads while writing them.
+
+Out:
+
+  Returns NULL.
+
+  thread_base->status_list_base[N] is the return value of agnentrolog_stream() for each file number N covered by this thread.
+*/
+  ULONG *in_filename_char_idx_list_base;
+  ULONG in_file_idx;
+  ULONG in_filename_count;
+  ULONG *out_filename_char_idx_list_base;
+  u8 *status_list_base;
+  agnentrolog_thread_t *thread_base_u;
+  u32 thread_count;
+
+  thread_base_u=(agnentrolog_thread_t *)(thread_base);
+  in_filename_char_idx_list_base=thread_base_u->in_filename_char_idx_list_base;
+  in_filename_count=thread_base_u->in_filename_count;
+  out_filename_char_idx_list_base=thread_base_u->out_filename_char_idx_list_base;
+  status_list_base=thread_base_u->status_list_base;
+  in_file_idx=thread_base_u->thread_idx;
+  thread_count=thread_base_u->thread_idx_max+1;
+  do{
+    status_list_base[in_file_idx]=agnentrolog_stream(in_filename_char_idx_list_base[in_file_idx], out_filename_char_idx_list_base[in_file_idx], thread_base_u);
+    in_file_idx+=thread_count;
+  }while(in_file_idx<in_filename_count);
+  return NULL;
+}
+
 int
 main(int argc, char *argv[]){
   ULONG arg_idx;
-  u8 bit_count;
-  u8 fatal_status;
   u8 file_status;
   u8 filesys_status;
+  ULONG in_chunk_size_max;
   ULONG in_file_idx;
-  ULONG in_file_size;
   ULONG in_file_size_max;
+  u8 *in_file_status_list_base;
   char *in_filename_base;
+  ULONG *in_filename_char_idx_list_base;
   ULONG in_filename_count;
   char *in_filename_list_base;
   ULONG in_filename_list_char_idx;
-  ULONG in_filename_list_char_idx_max;
-  ULONG in_filename_list_char_idx_new;
   ULONG in_filename_list_size;
-  ULONG in_filename_list_size_new;
-  ULONG in_u8_idx;
-  ULONG in_u8_idx_max;
   u8 *in_u8_list_base;
   u8 mask_size_in;
-  u64 mask_u64;
   char *out_filename_base;
   ULONG out_filename_char_idx;
+  ULONG *out_filename_char_idx_list_base;
   ULONG out_filename_char_idx_max;
-  ULONG out_filename_char_idx_new;
   char *out_filename_list_base;
   ULONG out_filename_list_size;
-  ULONG out_u8_idx;
+  u8 *out_u8_list_base;
   u64 parameter;
-  u8 retry_status;
   u8 status;
+  ULONG thread_footprint;
+  u32 thread_idx;
+  u32 thread_idx_max;
+  u32 thread_idx_max_file;
+  agnentrolog_thread_t thread_list_base[THREAD_COUNT_MAX];
 
   status=ascii_init(ASCII_BUILD_BREAK_COUNT_EXPECTED, 0);
-  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 4));
+  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 7));
+  status=(u8)(status|thread_init(THREAD_BUILD_BREAK_COUNT_EXPECTED, 0));
+  thread_idx_max=thread_count_get()-1;
+  in_file_status_list_base=NULL;
+  in_filename_char_idx_list_base=NULL;
   in_filename_list_base=NULL;
   in_u8_list_base=NULL;
+  out_filename_char_idx_list_base=NULL;
   out_filename_list_base=NULL;
+  out_u8_list_base=NULL;
+  thread_idx_max_file=0;
   do{
     if(status){
       agnentrolog_error_print("Outdated source code");
@@ -116,6 +364,7 @@ main(int argc, char *argv[]){
       DEBUG_PRINT("(granularity) is one less than the number of bytes per input mask, on [0, 7].\n\n");
       DEBUG_PRINT("(input) is the file or folder from which to read multiples of (granularity+1)\nbytes.\n\n");
       DEBUG_PRINT("(output) is the file or folder, corresponding to but different from (input), to\nwhich to write the corresponding log values. Each output log is the integer\nfloor of the log2 of the input mask, plus 1. 0 maps to 0\n\n");
+      DEBUG_PRINT("Files need not fit in memory, as they're processed in chunks.\n\n");
       break;
     }
     arg_idx=0;
@@ -136,33 +385,19 @@ main(int argc, char *argv[]){
     }
     in_filename_base=argv[2];
     out_filename_base=argv[3];
-    fatal_status=0;
     in_file_size_max=0;
     in_filename_count=0;
     in_filename_list_size=U16_MAX;
     mask_size_in=(u8)(parameter+1);
-    retry_status=0;
     status=1;
-    do{
-      in_filename_list_char_idx_max=in_filename_list_size-1;
-      in_filename_list_base=filesys_char_list_malloc(in_filename_list_char_idx_max);
-      if(!in_filename_list_base){
-        fatal_status=1;
-        agnentrolog_out_of_memory_print();
-        break;
-      }
-      in_filename_list_size_new=in_filename_list_size;
-      retry_status=filesys_filename_list_get(&fatal_status, &in_file_size_max, &file_status, &in_filename_count, in_filename_list_base, &in_filename_list_size_new, in_filename_base);
-      if(fatal_status){
-        agnentrolog_error_print("(input) not found or inaccessible");
-        break;
-      }
-      if(retry_status){
-        in_filename_list_base=filesys_free(in_filename_list_base);
-        in_filename_list_size=in_filename_list_size_new;
-      }
-    }while(retry_status);
-    if(fatal_status){
+    in_filename_list_base=filesys_char_list_malloc(in_filename_list_size);
+    if(!in_filename_list_base){
+      agnentrolog_out_of_memory_print();
+      break;
+    }
+    status=filesys_filename_list_get(&in_file_size_max, &file_status, &in_filename_count, &in_filename_list_base, &in_filename_list_size, in_filename_base);
+    if(status){
+      agnentrolog_error_print("(input) not found or inaccessible");
       break;
     }
     status=filesys_filename_list_sort(in_filename_count, in_filename_list_base);
@@ -170,9 +405,20 @@ main(int argc, char *argv[]){
       agnentrolog_out_of_memory_print();
       break;
     }
-    status=1;
-    in_u8_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_file_size_max));
+    in_chunk_size_max=(AGNENTROLOG_CHUNK_SIZE_MAX/mask_size_in)*mask_size_in;
+    if(in_file_size_max<in_chunk_size_max){
+      in_chunk_size_max=in_file_size_max;
+    }
+    in_u8_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_chunk_size_max));
     status=!in_u8_list_base;
+    out_u8_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_chunk_size_max/mask_size_in));
+    status=(u8)(status|!out_u8_list_base);
+    in_file_status_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_filename_count));
+    status=(u8)(status|!in_file_status_list_base);
+    in_filename_char_idx_list_base=(ULONG *)(DEBUG_MALLOC_PARANOID(in_filename_count*(ULONG)(sizeof(ULONG))));
+    status=(u8)(status|!in_filename_char_idx_list_base);
+    out_filename_char_idx_list_base=(ULONG *)(DEBUG_MALLOC_PARANOID(in_filename_count*(ULONG)(sizeof(ULONG))));
+    status=(u8)(status|!out_filename_char_idx_list_base);
     out_filename_list_size=filesys_filename_list_morph_size_get(in_filename_count, in_filename_base, in_filename_list_base, out_filename_base);
     out_filename_char_idx_max=out_filename_list_size-1;
     out_filename_list_base=filesys_char_list_malloc(out_filename_char_idx_max);
@@ -182,37 +428,72 @@ main(int argc, char *argv[]){
       break;
     }
     filesys_filename_list_morph(in_filename_count, in_filename_base, in_filename_list_base, out_filename_base, out_filename_list_base);
-    in_filename_list_char_idx=0;
     in_file_idx=0;
+    in_filename_list_char_idx=0;
     out_filename_char_idx=0;
     do{
-      in_file_size=in_file_size_max;
-      in_filename_list_char_idx_new=in_filename_list_char_idx;
-      filesys_status=filesys_file_read_next(&in_file_size, &in_filename_list_char_idx_new, in_filename_list_base, in_u8_list_base);
-      if((!in_file_size)||(in_file_size%mask_size_in)){
-        filesys_status=FILESYS_STATUS_CALLER_CUSTOM;
+      in_filename_char_idx_list_base[in_file_idx]=in_filename_list_char_idx;
+      out_filename_char_idx_list_base[in_file_idx]=out_filename_char_idx;
+      in_filename_list_char_idx+=(ULONG)(strlen(&in_filename_list_base[in_filename_list_char_idx]))+1;
+      out_filename_char_idx+=(ULONG)(strlen(&out_filename_list_base[out_filename_char_idx]))+1;
+      in_file_idx++;
+    }while(in_file_idx!=in_filename_count);
+/*
+Convert files in parallel, each one entirely on a single thread, so that output doesn't depend on the thread count. Limit the number of threads so that their work buffers don't exceed AGNENTROLOG_THREAD_FOOTPRINT_MAX in total, as far as possible.
+*/
+    thread_footprint=in_chunk_size_max+(in_chunk_size_max/mask_size_in);
+    thread_idx_max_file=(u32)(MIN((ULONG)(thread_idx_max), in_filename_count-1));
+    if((AGNENTROLOG_THREAD_FOOTPRINT_MAX/thread_footprint)<=thread_idx_max_file){
+      thread_idx_max_file=(u32)(AGNENTROLOG_THREAD_FOOTPRINT_MAX/thread_footprint);
+      if(thread_idx_max_file){
+        thread_idx_max_file--;
       }
+    }
+    thread_list_base[0].in_filename_char_idx_list_base=in_filename_char_idx_list_base;
+    thread_list_base[0].in_filename_list_base=in_filename_list_base;
+    thread_list_base[0].in_u8_list_base=in_u8_list_base;
+    thread_list_base[0].out_filename_char_idx_list_base=out_filename_char_idx_list_base;
+    thread_list_base[0].out_filename_list_base=out_filename_list_base;
+    thread_list_base[0].out_u8_list_base=out_u8_list_base;
+    thread_list_base[0].status_list_base=in_file_status_list_base;
+    thread_list_base[0].in_chunk_size_max=in_chunk_size_max;
+    thread_list_base[0].in_filename_count=in_filename_count;
+    thread_list_base[0].thread_idx=0;
+    thread_list_base[0].mask_size_in=mask_size_in;
+/*
+Allocate private work buffers for each additional thread. If that fails, then just run fewer threads.
+*/
+    if(thread_idx_max_file){
+      thread_idx=1;
+      do{
+        thread_list_base[thread_idx]=thread_list_base[0];
+        thread_list_base[thread_idx].thread_idx=thread_idx;
+        thread_list_base[thread_idx].in_u8_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_chunk_size_max));
+        status=!thread_list_base[thread_idx].in_u8_list_base;
+        thread_list_base[thread_idx].out_u8_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_chunk_size_max/mask_size_in));
+        status=(u8)(status|!thread_list_base[thread_idx].out_u8_list_base);
+        if(status){
+          DEBUG_FREE_PARANOID(thread_list_base[thread_idx].out_u8_list_base);
+          DEBUG_FREE_PARANOID(thread_list_base[thread_idx].in_u8_list_base);
+          thread_idx_max_file=thread_idx-1;
+          break;
+        }
+      }while((thread_idx++)!=thread_idx_max_file);
+    }
+    thread_idx=0;
+    do{
+      thread_list_base[thread_idx].thread_idx_max=thread_idx_max_file;
+    }while((thread_idx++)!=thread_idx_max_file);
+    thread_list_run(&agnentrolog_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(agnentrolog_thread_t)), thread_idx_max_file);
+/*
+Report errors in file order, as though the files had been processed serially.
+*/
+    in_file_idx=0;
+    do{
+      filesys_status=in_file_status_list_base[in_file_idx];
+      in_filename_list_char_idx=in_filename_char_idx_list_base[in_file_idx];
+      out_filename_char_idx=out_filename_char_idx_list_base[in_file_idx];
       status=!!filesys_status;
-      if(!status){
-        in_u8_idx=0;
-        in_u8_idx_max=(ULONG)(in_file_size-1);
-        out_u8_idx=0;
-        do{
-          mask_u64=0;
-          memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in));
-          in_u8_idx+=mask_size_in;
-          bit_count=0;
-          if(mask_u64){
-            BITSCAN_MSB64_SMALL_GET(bit_count, mask_u64);
-            bit_count++;
-          }
-          in_u8_list_base[out_u8_idx]=bit_count;
-          out_u8_idx++;
-        }while(in_u8_idx<=in_u8_idx_max);
-        out_filename_char_idx_new=out_filename_char_idx;
-        filesys_status=filesys_file_write_next_obnoxious(out_u8_idx, &out_filename_char_idx_new, out_filename_list_base, in_u8_list_base);
-        status=!!filesys_status;
-      }
       if(status){
         if(filesys_status!=FILESYS_STATUS_WRITE_FAIL){
           DEBUG_WRITE(&in_filename_list_base[in_filename_list_char_idx]);
@@ -242,13 +523,22 @@ main(int argc, char *argv[]){
           agnentrolog_error_print("Internal error. Please report");
         }
       }
-      in_filename_list_char_idx=in_filename_list_char_idx_new;
       in_file_idx++;
-      out_filename_char_idx=out_filename_char_idx_new;
     }while(in_file_idx!=in_filename_count);
     status=0;
   }while(0);
+  if(thread_idx_max_file){
+    thread_idx=1;
+    do{
+      DEBUG_FREE_PARANOID(thread_list_base[thread_idx].out_u8_list_base);
+      DEBUG_FREE_PARANOID(thread_list_base[thread_idx].in_u8_list_base);
+    }while((thread_idx++)!=thread_idx_max_file);
+  }
   filesys_free(out_filename_list_base);
+  DEBUG_FREE_PARANOID(out_filename_char_idx_list_base);
+  DEBUG_FREE_PARANOID(in_filename_char_idx_list_base);
+  DEBUG_FREE_PARANOID(in_file_status_list_base);
+  DEBUG_FREE_PARANOID(out_u8_list_base);
   DEBUG_FREE_PARANOID(in_u8_list_base);
   filesys_free(in_filename_list_base);
   DEBUG_ALLOCATION_CHECK();
@@ -476,11 +476,16 @@ Out:
   ULONG *freq_list_base;
   u128 freq_mantissa;
   u8 freq_pop_cache_idx;
+  ULONG *freq_pop_dense_list_base;
   ULONG freq_pop_idx_max;
   ULONG *freq_pop_list_base0;
   ULONG *freq_pop_list_base1;
   ULONG freq_pop_ulong_idx;
   loggamma_t *loggamma_base;
+  ULONG loggamma_batch_count;
+  ULONG loggamma_batch_idx;
+  fru128 *loggamma_batch_list_base;
+  u64 *loggamma_batch_parameter_list_base;
   ULONG loggamma_idx_max;
   fru128 *loggamma_list_base;
   u64 loggamma_parameter;
@@ -552,20 +557,33 @@ Subtract the sum of loggamma(freq+1), which is log(freq!), over all masks. This
       }
     }while((mask++)!=mask_max);
   }else if(mode==AGNENTROPROX_MODE_LOGFREEDOM){
-    poissocache_base=agnentroprox_base->poissocache_base;
-    if(new_status){
-      poissocache_reset(poissocache_base);
-    }
-    freq_pop_idx_max=poissocache_parameters_get(&freq_pop_list_base0, poissocache_base);
 /*
-Count the populations of all frequencies. Use the same indexing and hashing method expected by agnentroprox_entropy_transform(). See the comments there.
+Count the populations of all frequencies. If the dense list is large enough to be indexed by every possible frequency, then count them there, in which case agnentroprox_entropy_transform() will use them as they are. Otherwise use the same indexing and hashing method expected by agnentroprox_entropy_transform(). See the comments there.
 */
-    mask=0;
-    do{
-      freq=freq_list_base[mask];
-      POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq, freq_pop_list_base0, freq_pop_list_base1, poissocache_base);
-      freq_pop_list_base1[freq_pop_ulong_idx+1]++;
-    }while((mask++)!=mask_max);
+    freq_pop_dense_list_base=NULL;
+    poissocache_base=agnentroprox_base->poissocache_base;
+    if(new_status&&(mask_count<=agnentroprox_base->freq_pop_dense_idx_max)){
+      freq_pop_dense_list_base=agnentroprox_base->freq_pop_dense_list_base;
+    }
+    if(freq_pop_dense_list_base){
+      agnentroprox_ulong_list_zero(mask_count, freq_pop_dense_list_base);
+      mask=0;
+      do{
+        freq=freq_list_base[mask];
+        freq_pop_dense_list_base[freq]++;
+      }while((mask++)!=mask_max);
+    }else{
+      if(new_status){
+        poissocache_reset(poissocache_base);
+      }
+      freq_pop_idx_max=poissocache_parameters_get(&freq_pop_list_base0, poissocache_base);
+      mask=0;
+      do{
+        freq=freq_list_base[mask];
+        POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq, freq_pop_list_base0, freq_pop_list_base1, overflow_status, poissocache_base);
+        freq_pop_list_base1[freq_pop_ulong_idx+1]++;
+      }while((mask++)!=mask_max);
+    }
 /*
 Evaluate the logfreedom in nats (AKA "eubits" in https://dyspoissonism.blogspot.com/2015/05/the-logfreedom-formula.html), where H0 has been subsumed into the sums:
 
@@ -586,11 +604,44 @@ where:
     FRU128_ADD_FRU128_SELF(entropy, term, overflow_status);
     freq_pop_cache_idx=0;
     freq_pop_ulong_idx=0;
+    loggamma_batch_count=0;
+    loggamma_batch_idx=0;
+    loggamma_batch_list_base=agnentroprox_base->loggamma_batch_list_base;
+    loggamma_batch_parameter_list_base=agnentroprox_base->loggamma_batch_parameter_list_base;
     do{
-      status=poissocache_item_get_serialized(&freq_pop_cache_idx, &freq_pop_ulong_idx, &freq, poissocache_base, &pop);
+      if(!freq_pop_dense_list_base){
+        status=poissocache_item_get_serialized(&freq_pop_cache_idx, &freq_pop_ulong_idx, &freq, poissocache_base, &pop);
+        if((!status)&&pop){
+          loggamma_parameter=(u64)(freq)+1;
+          LOGGAMMA_U64_CACHED(term, loggamma_base, loggamma_idx_max, loggamma_list_base, loggamma_parameter_list_base, loggamma_parameter, overflow_status);
+        }
+      }else{
+        if(loggamma_batch_idx==loggamma_batch_count){
+/*
+Gather the next batch of frequencies of nonzero population, which are on [0, mask_count], and evaluate their loggammas all at once. They're sorted and tend to be consecutive, which allows loggamma_u64_list() to do so much faster than one at a time. Reuse freq_pop_ulong_idx as the index of the dense list.
+*/
+          loggamma_batch_count=0;
+          loggamma_batch_idx=0;
+          while((freq_pop_ulong_idx<=mask_count)&&(loggamma_batch_count<=AGNENTROPROX_LOGGAMMA_BATCH_IDX_MAX)){
+            if(freq_pop_dense_list_base[freq_pop_ulong_idx]){
+              loggamma_batch_parameter_list_base[loggamma_batch_count]=(u64)(freq_pop_ulong_idx)+1;
+              loggamma_batch_count++;
+            }
+            freq_pop_ulong_idx++;
+          }
+          if(loggamma_batch_count){
+            overflow_status=(u8)(overflow_status|loggamma_u64_list(loggamma_batch_list_base, loggamma_base, loggamma_idx_max, loggamma_list_base, loggamma_parameter_list_base, loggamma_batch_count-1, loggamma_batch_parameter_list_base));
+          }
+        }
+        status=(loggamma_batch_idx==loggamma_batch_count);
+        if(!status){
+          freq=(ULONG)(loggamma_batch_parameter_list_base[loggamma_batch_idx]-1);
+          pop=freq_pop_dense_list_base[freq];
+          term=loggamma_batch_list_base[loggamma_batch_idx];
+          loggamma_batch_idx++;
+        }
+      }
       if((!status)&&pop){
-        loggamma_parameter=(u64)(freq)+1;
-        LOGGAMMA_U64_CACHED(term, loggamma_base, loggamma_idx_max, loggamma_list_base, loggamma_parameter_list_base, loggamma_parameter, overflow_status);
         if(1<pop){
           FRU128_MULTIPLY_U64_SELF(term, pop, overflow_status);
         }
@@ -848,6 +899,8 @@ Out:
   ULONG *freq_list_base1;
   u128 freq_mantissa;
   ULONG freq_plus_1;
+  ULONG freq_pop_dense_idx_max;
+  ULONG *freq_pop_dense_list_base;
   ULONG freq_pop_idx_max;
   ULONG *freq_pop_list_base0;
   ULONG *freq_pop_list_base1;
@@ -887,6 +940,7 @@ Out:
   u8 overlap_status;
   poissocache_t *poissocache_base;
   ULONG pop;
+  ULONG *pop_base;
   u8 sign_status;
   fru128 sum_quartics;
   fru128 sum_squares;
@@ -1006,6 +1060,23 @@ where:
   if(!sign_status){
     mask_sign_mask=0;
   }
+  freq_pop_dense_list_base=NULL;
+  freq_pop_idx_max=0;
+  freq_pop_list_base0=NULL;
+  poissocache_base=NULL;
+  if(mode==AGNENTROPROX_MODE_LOGFREEDOM){
+/*
+Within a sweep, no frequency can exceed sweep_mask_count. So if the sweep is small enough, track the populations of frequencies in a dense list indexed by frequency, as opposed to hashing them into the Poisson cache. Either way, agnentroprox_entropy_delta_get() has already counted the populations of the first sweep under the same condition.
+*/
+    freq_pop_dense_idx_max=agnentroprox_base->freq_pop_dense_idx_max;
+    if(sweep_mask_count<=freq_pop_dense_idx_max){
+      freq_pop_dense_list_base=agnentroprox_base->freq_pop_dense_list_base;
+    }
+    if(!freq_pop_dense_list_base){
+      poissocache_base=agnentroprox_base->poissocache_base;
+      freq_pop_idx_max=poissocache_parameters_get(&freq_pop_list_base0, poissocache_base);
+    }
+  }
   u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
   u8_idx=sweep_mask_count*u8_idx_delta;
   u8_idx_max=mask_idx_max*u8_idx_delta;
@@ -1251,36 +1322,54 @@ The logfreedom difference in terms the frequencies in question and their respect
 where we need to serialize updates to the populations of the old and new masks, hence the division into 2 separate lines above.
 */
         if(freq_old!=freq_plus_1){
-          poissocache_base=agnentroprox_base->poissocache_base;
-          freq_pop_idx_max=poissocache_parameters_get(&freq_pop_list_base0, poissocache_base);
-          POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_old, freq_pop_list_base0, freq_pop_list_base1, poissocache_base);
-          pop=freq_pop_list_base1[freq_pop_ulong_idx+1];
-          freq_pop_list_base1[freq_pop_ulong_idx+1]=pop-1;
+          if(freq_pop_dense_list_base){
+            pop_base=&freq_pop_dense_list_base[freq_old];
+          }else{
+            POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_old, freq_pop_list_base0, freq_pop_list_base1, overflow_status, poissocache_base);
+            pop_base=&freq_pop_list_base1[freq_pop_ulong_idx+1];
+          }
+          pop=*pop_base;
+          *pop_base=pop-1;
           FRU64_LOG_U64_NONZERO_CACHED(term_plus, log_idx_max, log_list_base, log_parameter_list_base, (u64)(freq_old));
           FRU64_LOG_U64_NONZERO_CACHED(term_minus, log_idx_max, log_list_base, log_parameter_list_base, (u64)(freq_plus_1));
           if(pop!=1){
             FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(pop));
             FRU64_ADD_FRU64_SELF(term_plus, log, overflow_status);
           }
-          POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_old_minus_1, freq_pop_list_base0, freq_pop_list_base1, poissocache_base);
-          pop=freq_pop_list_base1[freq_pop_ulong_idx+1];
+          if(freq_pop_dense_list_base){
+            pop_base=&freq_pop_dense_list_base[freq_old_minus_1];
+          }else{
+            POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_old_minus_1, freq_pop_list_base0, freq_pop_list_base1, overflow_status, poissocache_base);
+            pop_base=&freq_pop_list_base1[freq_pop_ulong_idx+1];
+          }
+          pop=*pop_base;
           pop++;
-          freq_pop_list_base1[freq_pop_ulong_idx+1]=pop;
+          *pop_base=pop;
           if(pop!=1){
             FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(pop));
             FRU64_ADD_FRU64_SELF(term_minus, log, overflow_status);
           }
-          POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq, freq_pop_list_base0, freq_pop_list_base1, poissocache_base);
-          pop=freq_pop_list_base1[freq_pop_ulong_idx+1];
-          freq_pop_list_base1[freq_pop_ulong_idx+1]=pop-1;
+          if(freq_pop_dense_list_base){
+            pop_base=&freq_pop_dense_list_base[freq];
+          }else{
+            POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq, freq_pop_list_base0, freq_pop_list_base1, overflow_status, poissocache_base);
+            pop_base=&freq_pop_list_base1[freq_pop_ulong_idx+1];
+          }
+          pop=*pop_base;
+          *pop_base=pop-1;
           if(pop!=1){
             FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(pop));
             FRU64_ADD_FRU64_SELF(term_plus, log, overflow_status);
           }
-          POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_plus_1, freq_pop_list_base0, freq_pop_list_base1, poissocache_base);
-          pop=freq_pop_list_base1[freq_pop_ulong_idx+1];
+          if(freq_pop_dense_list_base){
+            pop_base=&freq_pop_dense_list_base[freq_plus_1];
+          }else{
+            POISSOCACHE_ITEM_ULONG_IDX_GET(freq_pop_ulong_idx, freq_pop_idx_max, freq_plus_1, freq_pop_list_base0, freq_pop_list_base1, overflow_status, poissocache_base);
+            pop_base=&freq_pop_list_base1[freq_pop_ulong_idx+1];
+          }
+          pop=*pop_base;
           pop++;
-          freq_pop_list_base1[freq_pop_ulong_idx+1]=pop;
+          *pop_base=pop;
           if(pop!=1){
             FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(pop));
             FRU64_ADD_FRU64_SELF(term_minus, log, overflow_status);
@@ -1785,6 +1874,9 @@ Out:
     fracterval_u64_free(agnentroprox_base->log_list_base);
     fracterval_u64_free(agnentroprox_base->log_delta_parameter_list_base);
     fracterval_u64_free(agnentroprox_base->log_delta_list_base);
+    agnentroprox_free(agnentroprox_base->loggamma_batch_parameter_list_base);
+    fracterval_u128_free(agnentroprox_base->loggamma_batch_list_base);
+    agnentroprox_free(agnentroprox_base->freq_pop_dense_list_base);
     poissocache_free_all(agnentroprox_base->poissocache_base);
     agnentroprox_free(agnentroprox_base->freq_list_base1);
     agnentroprox_free(agnentroprox_base->freq_list_base0);
@@ -1912,6 +2004,8 @@ Out:
   ULONG cache_idx_max;
   ULONG *freq_list_base0;
   ULONG *freq_list_base1;
+  ULONG freq_pop_dense_idx_max;
+  ULONG *freq_pop_dense_list_base;
   ULONG log_delta_idx_max;
   fru64 *log_delta_list_base;
   u64 *log_delta_parameter_list_base;
@@ -1922,6 +2016,8 @@ Out:
   fru128 *log_u128_list_base;
   u128 *log_u128_parameter_list_base;
   u128 log2_recip_half;
+  fru128 *loggamma_batch_list_base;
+  u64 *loggamma_batch_parameter_list_base;
   ULONG loggamma_idx_max;
   fru128 *loggamma_list_base;
   u64 *loggamma_parameter_list_base;
@@ -2017,9 +2113,34 @@ Allocate private storage. We need to use calloc() instead of malloc() because if
       status=(u8)(status|!freq_list_base1);
       agnentroprox_base->freq_list_base1=freq_list_base1;
       if(mode_bitmap&AGNENTROPROX_MODE_LOGFREEDOM){
-        poissocache_base=poissocache_init(POISSOCACHE_BUILD_BREAK_COUNT_EXPECTED, 0, poissocache_item_idx_max);
+        poissocache_base=poissocache_init(POISSOCACHE_BUILD_BREAK_COUNT_EXPECTED, 3, poissocache_item_idx_max);
         status=(u8)(status|!poissocache_base);
         agnentroprox_base->poissocache_base=poissocache_base;
+/*
+Population updates hit the Poisson cache on every mask, so a brief stall to add a level beats a migration, which taxes subsequent updates by searching both generations until it completes.
+*/
+        if(poissocache_base){
+          poissocache_growth_set(AGNENTROPROX_POISSOCACHE_LEVEL_COUNT_EXTRA, poissocache_base);
+        }
+/*
+Transforms whose sweeps are small enough can track frequency populations in a dense list, which is much faster than the Poisson cache. Frequencies within a sweep are on [0, sweep_mask_idx_max_max+1]. Because the dense list is sorted by frequency, it comes with a pair of lists for evaluating loggammas in batches via loggamma_u64_list(). Failure to allocate them isn't fatal, as the Poisson cache can do the same job.
+*/
+        if(sweep_mask_idx_max_max<AGNENTROPROX_FREQ_POP_DENSE_IDX_MAX_MAX){
+          freq_pop_dense_idx_max=sweep_mask_idx_max_max+1;
+          freq_pop_dense_list_base=agnentroprox_ulong_list_malloc(freq_pop_dense_idx_max);
+          loggamma_batch_list_base=fracterval_u128_list_malloc(AGNENTROPROX_LOGGAMMA_BATCH_IDX_MAX);
+          loggamma_batch_parameter_list_base=agnentroprox_u64_list_malloc(AGNENTROPROX_LOGGAMMA_BATCH_IDX_MAX);
+          if(freq_pop_dense_list_base&&loggamma_batch_list_base&&loggamma_batch_parameter_list_base){
+            agnentroprox_base->freq_pop_dense_idx_max=freq_pop_dense_idx_max;
+            agnentroprox_base->freq_pop_dense_list_base=freq_pop_dense_list_base;
+            agnentroprox_base->loggamma_batch_list_base=loggamma_batch_list_base;
+            agnentroprox_base->loggamma_batch_parameter_list_base=loggamma_batch_parameter_list_base;
+          }else{
+            agnentroprox_free(loggamma_batch_parameter_list_base);
+            fracterval_u128_free(loggamma_batch_list_base);
+            agnentroprox_free(freq_pop_dense_list_base);
+          }
+        }
       }
       if(!status){
 /*
@@ -3368,6 +3489,74 @@ Unless mask_max equals agnentroprox_init():In:mask_max_max, agnentroprox_base->m
   return;
 }
 
+u8
+agnentroprox_match_check(u8 case_insensitive_status, u8 *haystack_u8_list_base, ULONG needle_u8_idx_max, u8 *needle_u8_list_base){
+/*
+Compare a needle to a haystack location, with or without ASCII case folding.
+
+In:
+
+  case_insensitive_status is one to treat upper and lower case letters the same, else zero.
+
+  *haystack_u8_list_base is the haystack location, which must contain at least (needle_u8_idx_max+1) readable bytes.
+
+  needle_u8_idx_max is one less than the size of *needle_u8_list_base.
+
+  *needle_u8_list_base is the needle.
+
+Out:
+
+  Returns zero if *haystack_u8_list_base begins with a copy of *needle_u8_list_base, else one.
+*/
+  ULONG haystack_ulong;
+  u8 haystack_u8;
+  ULONG needle_ulong;
+  u8 needle_u8;
+  ULONG needle_u8_idx;
+  u8 status;
+  ULONG ulong_high_mask;
+  ULONG ulong_low_mask;
+  ULONG ulong_ones;
+
+  if(!case_insensitive_status){
+    status=!!memcmp(haystack_u8_list_base, needle_u8_list_base, (size_t)(needle_u8_idx_max+1));
+  }else{
+/*
+Compare a ULONG at a time, folding "A" through "Z" to lower case in all bytes at once: a byte is upper case if and only if its low 7 bits plus 0x3F carry into bit 7 and its low 7 bits plus 0x25 do not, and its own bit 7 is clear. Neither sum can carry out of its byte. The stragglers are compared one byte at a time.
+*/
+    needle_u8_idx=0;
+    status=0;
+    ulong_ones=ULONG_MAX/U8_MAX;
+    ulong_high_mask=ulong_ones<<U8_BIT_MAX;
+    ulong_low_mask=~ulong_high_mask;
+    while((ULONG_BYTE_MAX<=needle_u8_idx_max)&&(needle_u8_idx<=(needle_u8_idx_max-ULONG_BYTE_MAX))){
+      memcpy(&haystack_ulong, &haystack_u8_list_base[needle_u8_idx], (size_t)(ULONG_SIZE));
+      memcpy(&needle_ulong, &needle_u8_list_base[needle_u8_idx], (size_t)(ULONG_SIZE));
+      haystack_ulong|=((((haystack_ulong&ulong_low_mask)+(ulong_ones*0x3FU))&~((haystack_ulong&ulong_low_mask)+(ulong_ones*0x25U))&~haystack_ulong&ulong_high_mask)>>2);
+      needle_ulong|=((((needle_ulong&ulong_low_mask)+(ulong_ones*0x3FU))&~((needle_ulong&ulong_low_mask)+(ulong_ones*0x25U))&~needle_ulong&ulong_high_mask)>>2);
+      if(haystack_ulong!=needle_ulong){
+        status=1;
+        break;
+      }
+      needle_u8_idx+=ULONG_SIZE;
+    }
+    if(!status){
+      while(needle_u8_idx<=needle_u8_idx_max){
+        haystack_u8=haystack_u8_list_base[needle_u8_idx];
+        haystack_u8=(u8)(haystack_u8|((((u8)(haystack_u8-'A'))<=('Z'-'A'))<<5));
+        needle_u8=needle_u8_list_base[needle_u8_idx];
+        needle_u8=(u8)(needle_u8|((((u8)(needle_u8-'A'))<=('Z'-'A'))<<5));
+        if(haystack_u8!=needle_u8){
+          status=1;
+          break;
+        }
+        needle_u8_idx++;
+      }
+    }
+  }
+  return status;
+}
+
 ULONG
 agnentroprox_match_find(u8 ascending_status, u8 case_insensitive_status, u8 granularity, ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG match_idx_max_max, ULONG *match_u8_idx_list_base, ULONG needle_mask_idx_max, u8 *needle_mask_list_base, u8 overlap_status){
 /*
@@ -3401,89 +3590,1451 @@ Out:
 
   *match_u8_idx_list_base contains (return value) u8 indexes, each pointing to the base of a copy of *needle_list_base. As explained above, match regions may overlap, regardless of overlap_status.
 */
+  u8 candidate_count;
+  u8 candidate_count_max;
   u8 haystack_u8;
   ULONG haystack_u8_idx;
   ULONG haystack_u8_idx_max;
+  ULONG haystack_u8_idx_min;
+  ULONG haystack_u8_idx_min_max;
+  u8 haystack_u8_last;
+  ULONG haystack_ulong;
+  ULONG haystack_ulong_last;
   ULONG mask_list_size_delta;
   ULONG match_idx;
   ULONG needle_mask_list_size;
   u8 needle_u8;
   u8 needle_u8_first;
-  u8 needle_u8_first_alternate;
   ULONG needle_u8_idx;
   ULONG needle_u8_idx_max;
+  u8 needle_u8_key;
+  u8 needle_u8_last;
+  ULONG needle_ulong_first;
+  ULONG needle_ulong_last;
+  ULONG skip_list[U8_SPAN];
+  ULONG skip_u8_idx_delta;
   u8 status;
   ULONG u8_idx_delta;
+  ULONG u8_idx_offset;
+  ULONG ulong_high_mask;
+  ULONG ulong_low_mask;
+  ULONG ulong_ones;
+  ULONG ulong_u8_idx_delta;
 
   match_idx=0;
   if(needle_mask_idx_max<=haystack_mask_idx_max){
-    needle_u8_first=needle_mask_list_base[0];
     u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
     haystack_u8_idx_max=(haystack_mask_idx_max*u8_idx_delta)+granularity;
     needle_u8_idx_max=(needle_mask_idx_max*u8_idx_delta)+granularity;
     mask_list_size_delta=haystack_u8_idx_max-needle_u8_idx_max;
     needle_mask_list_size=needle_u8_idx_max+1;
-    haystack_u8_idx=0;
-    if(!ascending_status){
-      haystack_u8_idx=mask_list_size_delta;
-      u8_idx_delta=0U-u8_idx_delta;
+    needle_u8_first=needle_mask_list_base[0];
+    needle_u8_last=needle_mask_list_base[needle_u8_idx_max];
+    if(case_insensitive_status){
+      needle_u8_first=(u8)(needle_u8_first|((((u8)(needle_u8_first-'A'))<=('Z'-'A'))<<5));
+      needle_u8_last=(u8)(needle_u8_last|((((u8)(needle_u8_last-'A'))<=('Z'-'A'))<<5));
     }
-    if(!case_insensitive_status){
+    haystack_u8_idx=0;
+    if(needle_mask_list_size<AGNENTROPROX_MATCH_SKIP_SIZE_MIN){
+/*
+Short needle. Compare the first and last bytes of the needle to those of ULONG_SIZE consecutive candidate windows at once, and skip them all if none has both in the right places. Otherwise, or when fewer than ULONG_SIZE windows remain, check one window at a time. We don't care which byte of the ULONG triggered, so this is endian-neutral. When overlap_status is zero, ulong_u8_idx_delta is rounded down to a multiple of u8_idx_delta so that the windows at misaligned offsets just come along for the ride.
+*/
+      candidate_count_max=(u8)(ULONG_SIZE/u8_idx_delta);
+      ulong_u8_idx_delta=candidate_count_max*u8_idx_delta;
+      ulong_ones=ULONG_MAX/U8_MAX;
+      ulong_high_mask=ulong_ones<<U8_BIT_MAX;
+      ulong_low_mask=~ulong_high_mask;
+      needle_ulong_first=ulong_ones*needle_u8_first;
+      needle_ulong_last=ulong_ones*needle_u8_last;
+      u8_idx_offset=0;
+      if(!ascending_status){
+        haystack_u8_idx=mask_list_size_delta;
+        u8_idx_delta=0U-u8_idx_delta;
+        u8_idx_offset=ULONG_BYTE_MAX;
+        ulong_u8_idx_delta=0U-ulong_u8_idx_delta;
+      }
+      haystack_u8_idx_min_max=mask_list_size_delta-ULONG_BYTE_MAX;
       do{
-        if(haystack_mask_list_base[haystack_u8_idx]==needle_u8_first){
-          status=!!memcmp(&haystack_mask_list_base[haystack_u8_idx], needle_mask_list_base, (size_t)(needle_mask_list_size));
-          if(!status){
-            if(match_u8_idx_list_base){
-              match_u8_idx_list_base[match_idx]=haystack_u8_idx;
-            }
-            match_idx++;
-            if(match_idx_max_max<match_idx){
-              break;
-            }
+        candidate_count=1;
+        haystack_u8_idx_min=haystack_u8_idx-u8_idx_offset;
+        if((ULONG_BYTE_MAX<=mask_list_size_delta)&&(haystack_u8_idx_min<=haystack_u8_idx_min_max)){
+          memcpy(&haystack_ulong, &haystack_mask_list_base[haystack_u8_idx_min], (size_t)(ULONG_SIZE));
+          memcpy(&haystack_ulong_last, &haystack_mask_list_base[haystack_u8_idx_min+needle_u8_idx_max], (size_t)(ULONG_SIZE));
+          if(case_insensitive_status){
+            haystack_ulong|=((((haystack_ulong&ulong_low_mask)+(ulong_ones*0x3FU))&~((haystack_ulong&ulong_low_mask)+(ulong_ones*0x25U))&~haystack_ulong&ulong_high_mask)>>2);
+            haystack_ulong_last|=((((haystack_ulong_last&ulong_low_mask)+(ulong_ones*0x3FU))&~((haystack_ulong_last&ulong_low_mask)+(ulong_ones*0x25U))&~haystack_ulong_last&ulong_high_mask)>>2);
+          }
+/*
+Set the high bit of each byte of haystack_ulong if and only if both the first and last bytes of the corresponding window match.
+*/
+          haystack_ulong=(haystack_ulong^needle_ulong_first)|(haystack_ulong_last^needle_ulong_last);
+          haystack_ulong=~(((haystack_ulong&ulong_low_mask)+ulong_low_mask)|haystack_ulong|ulong_low_mask);
+          candidate_count=candidate_count_max;
+          if(!haystack_ulong){
+            candidate_count=0;
+            haystack_u8_idx+=ulong_u8_idx_delta;
           }
         }
-        haystack_u8_idx+=u8_idx_delta;
-      }while(haystack_u8_idx<=mask_list_size_delta);
-    }else{
-      needle_u8_first_alternate=needle_u8_first;
-      if((u8)((needle_u8_first|('a'-'A'))-'a')<=('z'-'a')){
-        needle_u8_first_alternate=(u8)(needle_u8_first^('a'-'A'));
-      }
-      do{
-        haystack_u8=haystack_mask_list_base[haystack_u8_idx];
-        if((haystack_u8==needle_u8_first)||(haystack_u8==needle_u8_first_alternate)){
-          status=0;
-          for(needle_u8_idx=1; needle_u8_idx<needle_mask_list_size; needle_u8_idx++){
-            haystack_u8=haystack_mask_list_base[haystack_u8_idx+needle_u8_idx];
-            needle_u8=needle_mask_list_base[needle_u8_idx];
-            if((haystack_u8^needle_u8)&(~('a'-'A'))){
-              status=1;
-              break;
-            }
-            if((haystack_u8^needle_u8)==('a'-'A')){
-              if(('z'-'a')<(u8)((haystack_u8|('a'-'A'))-'a')){
-                status=1;
+        while(candidate_count){
+          haystack_u8=haystack_mask_list_base[haystack_u8_idx];
+          haystack_u8_last=haystack_mask_list_base[haystack_u8_idx+needle_u8_idx_max];
+          if(case_insensitive_status){
+            haystack_u8=(u8)(haystack_u8|((((u8)(haystack_u8-'A'))<=('Z'-'A'))<<5));
+            haystack_u8_last=(u8)(haystack_u8_last|((((u8)(haystack_u8_last-'A'))<=('Z'-'A'))<<5));
+          }
+          if((haystack_u8==needle_u8_first)&&(haystack_u8_last==needle_u8_last)){
+            status=agnentroprox_match_check(case_insensitive_status, &haystack_mask_list_base[haystack_u8_idx], needle_u8_idx_max, needle_mask_list_base);
+            if(!status){
+              if(match_u8_idx_list_base){
+                match_u8_idx_list_base[match_idx]=haystack_u8_idx;
+              }
+              match_idx++;
+              if(match_idx_max_max<match_idx){
                 break;
               }
             }
           }
+          haystack_u8_idx+=u8_idx_delta;
+          candidate_count--;
+        }
+      }while((haystack_u8_idx<=mask_list_size_delta)&&(match_idx<=match_idx_max_max));
+    }else{
+/*
+Long needle. Use Boyer-Moore-Horspool keyed on the last byte of the window when ascending, or the first byte when descending. Skips are rounded down to a multiple of u8_idx_delta so that we never land on a misaligned window, and are stored negated when descending so that the loop is the same in both directions.
+*/
+      skip_u8_idx_delta=needle_mask_list_size-(needle_mask_list_size%u8_idx_delta);
+      needle_u8_idx=0;
+      do{
+        skip_list[needle_u8_idx]=skip_u8_idx_delta;
+      }while((++needle_u8_idx)!=U8_SPAN);
+      needle_u8_key=needle_u8_last;
+      u8_idx_offset=needle_u8_idx_max;
+      if(ascending_status){
+        needle_u8_idx=0;
+        do{
+          needle_u8=needle_mask_list_base[needle_u8_idx];
+          if(case_insensitive_status){
+            needle_u8=(u8)(needle_u8|((((u8)(needle_u8-'A'))<=('Z'-'A'))<<5));
+          }
+          skip_list[needle_u8]=needle_u8_idx_max-needle_u8_idx;
+        }while((++needle_u8_idx)!=needle_u8_idx_max);
+      }else{
+        haystack_u8_idx=mask_list_size_delta;
+        needle_u8_key=needle_u8_first;
+        u8_idx_offset=0;
+        needle_u8_idx=needle_u8_idx_max;
+        do{
+          needle_u8=needle_mask_list_base[needle_u8_idx];
+          if(case_insensitive_status){
+            needle_u8=(u8)(needle_u8|((((u8)(needle_u8-'A'))<=('Z'-'A'))<<5));
+          }
+          skip_list[needle_u8]=needle_u8_idx;
+        }while((--needle_u8_idx)!=0);
+      }
+      needle_u8_idx=0;
+      do{
+        skip_u8_idx_delta=skip_list[needle_u8_idx];
+        skip_u8_idx_delta-=skip_u8_idx_delta%u8_idx_delta;
+        if(!skip_u8_idx_delta){
+          skip_u8_idx_delta=u8_idx_delta;
+        }
+        if(!ascending_status){
+          skip_u8_idx_delta=0U-skip_u8_idx_delta;
+        }
+        skip_list[needle_u8_idx]=skip_u8_idx_delta;
+      }while((++needle_u8_idx)!=U8_SPAN);
+      do{
+        haystack_u8=haystack_mask_list_base[haystack_u8_idx+u8_idx_offset];
+        if(case_insensitive_status){
+          haystack_u8=(u8)(haystack_u8|((((u8)(haystack_u8-'A'))<=('Z'-'A'))<<5));
+        }
+        if(haystack_u8==needle_u8_key){
+          status=agnentroprox_match_check(case_insensitive_status, &haystack_mask_list_base[haystack_u8_idx], needle_u8_idx_max, needle_mask_list_base);
           if(!status){
             if(match_u8_idx_list_base){
               match_u8_idx_list_base[match_idx]=haystack_u8_idx;
             }
             match_idx++;
-            if(match_idx_max_max<match_idx){
-              break;
-            }
           }
         }
-        haystack_u8_idx+=u8_idx_delta;
-      }while(haystack_u8_idx<=mask_list_size_delta);
+        haystack_u8_idx+=skip_list[haystack_u8];
+      }while((haystack_u8_idx<=mask_list_size_delta)&&(match_idx<=match_idx_max_max));
     }
   }
   return match_idx;
 }
 
+void
+agnentroprox_multidiventropy_transform(agnentroprox_t *agnentroprox_base, u8 append_mode, fru128 *diventropy_list_base, ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG *match_count_list_base, ULONG match_idx_max_max, ULONG *match_u8_idx_list_base, agnentroprox_multineedle_t *multineedle_base, u8 *overflow_status_base, ULONG sweep_mask_idx_max){
+/*
+Compute the diventropy transforms of a haystack with respect to each of a list of preloaded needles, sharing a single pass over the haystack.
+
+In:
+
+  agnentroprox_base is the return value of agenentroprox_init().
+
+  append_mode is agnentroprox_diventropy_transform():In:append_mode, which applies to each needle separately.
+
+  *diventropy_list_base contains ((multineedle_base->needle_idx_max+1)*(match_idx_max_max+2)) undefined items. The items of each needle start at (needle_idx*(match_idx_max_max+2)). The last of them is merely scratch space for rank list insertion.
+
+  haystack_mask_idx_max is agnentroprox_diventropy_transform():In:haystack_mask_idx_max.
+
+  *haystack_mask_list_base is the haystack.
+
+  *match_count_list_base contains (multineedle_base->needle_idx_max+1) undefined items.
+
+  match_idx_max_max is one less than the maximum number of matches to report for each needle.
+
+  *match_u8_idx_list_base is NULL if the sweep base indexes associated with matches can be discarded, else the base of as many undefined items as *diventropy_list_base, laid out in the same manner.
+
+  multineedle_base is the return value of agnentroprox_multineedle_init().
+
+  *overflow_status_base is the OR-cummulative fracterval overflow status.
+
+  sweep_mask_idx_max is agnentroprox_diventropy_transform():In:sweep_mask_idx_max.
+
+Out:
+
+  *diventropy_list_base and *match_u8_idx_list_base contain, for each needle, what agnentroprox_diventropy_transform() would have produced after loading only that needle with agnentroprox_mask_list_load(). The results are bitwise identical.
+
+  *match_count_list_base contains the number of matches found for each needle.
+
+  *overflow_status_base is one if a fracterval overflow occurred, else unchanged.
+*/
+  fru128 diventropy;
+  fru128 diventropy_delta;
+  fru128 diventropy_delta_zero;
+  u128 diventropy_mean;
+  u128 diventropy_threshold;
+  u8 granularity;
+  ULONG haystack_freq;
+  ULONG haystack_freq_agnostic;
+  ULONG *haystack_freq_list_base;
+  ULONG haystack_freq_old;
+  ULONG haystack_mask_count_plus_span;
+  fru64 log;
+  fru64 log_delta;
+  ULONG log_delta_idx_max;
+  fru64 *log_delta_list_base;
+  fru64 log_delta_old;
+  u64 *log_delta_parameter_list_base;
+  ULONG log_idx_max;
+  fru64 *log_list_base;
+  u64 *log_parameter_list_base;
+  u32 mask;
+  u32 mask_max;
+  u32 mask_old;
+  u8 mask_u8;
+  ULONG match_count;
+  ULONG match_idx;
+  ULONG match_idx_min;
+  ULONG match_list_idx;
+  ULONG match_list_idx_delta;
+  u8 match_status_not;
+  ULONG needle_count;
+  fru128 *needle_diventropy_list_base;
+  u128 *needle_diventropy_mean_list_base;
+  u128 *needle_diventropy_threshold_list_base;
+  ULONG needle_freq;
+  ULONG needle_freq_idx;
+  ULONG needle_freq_idx_old;
+  ULONG *needle_freq_list_base;
+  ULONG needle_freq_old;
+  ULONG needle_idx;
+  ULONG needle_idx_max;
+  ULONG *needle_mask_count_list_base;
+  u8 overflow_status;
+  u8 overlap_status;
+  ULONG u8_idx;
+  ULONG u8_idx_old;
+  ULONG u8_idx_delta;
+  ULONG u8_idx_max;
+
+  overflow_status=*overflow_status_base;
+  granularity=agnentroprox_base->granularity;
+  haystack_freq_list_base=agnentroprox_base->freq_list_base1;
+  log_delta_idx_max=agnentroprox_base->log_delta_idx_max;
+  log_delta_list_base=agnentroprox_base->log_delta_list_base;
+  log_delta_parameter_list_base=agnentroprox_base->log_delta_parameter_list_base;
+  log_idx_max=agnentroprox_base->log_idx_max;
+  log_list_base=agnentroprox_base->log_list_base;
+  log_parameter_list_base=agnentroprox_base->log_parameter_list_base;
+  mask_max=agnentroprox_base->mask_max;
+  match_list_idx_delta=match_idx_max_max+2;
+  needle_diventropy_list_base=multineedle_base->diventropy_list_base;
+  needle_diventropy_mean_list_base=multineedle_base->diventropy_mean_list_base;
+  needle_diventropy_threshold_list_base=multineedle_base->diventropy_threshold_list_base;
+  needle_freq_list_base=multineedle_base->freq_list_base;
+  needle_idx_max=multineedle_base->needle_idx_max;
+  needle_mask_count_list_base=multineedle_base->mask_count_list_base;
+  needle_count=needle_idx_max+1;
+  overlap_status=agnentroprox_base->overlap_status;
+/*
+Compute the diventropy of each needle with respect to the first sweep, as in agnentroprox_diventropy_get(). Each log depends only on the haystack, so compute it once and then apply it to the frequencies of the same mask in all the needles, which are adjacent in memory.
+
+Rather than shifting each product from 6.58 to 6.64 fixed point, shift the integer by which the log is multiplied. Both bounds of the product then come out exactly as they would have after a fracterval shift, but without the cost of calling one. agnentroprox_multineedle_init() has ensured that the shifted needle frequencies fit in 64 bits. The exception is a zero frequency, whose shifted product would have been [0, ((1<<(64-58))-1)] rather than zero, so use diventropy_delta_zero in that case.
+*/
+  U128_SET_ZERO(diventropy_delta_zero.a);
+  U128_FROM_U64_LO(diventropy_delta_zero.b, (1U<<(64-58))-1);
+  agnentroprox_ulong_list_zero((ULONG)(mask_max), haystack_freq_list_base);
+  agnentroprox_base->mask_count1=0;
+  agnentroprox_mask_list_accrue(agnentroprox_base, 1, sweep_mask_idx_max, haystack_mask_list_base);
+  haystack_mask_count_plus_span=sweep_mask_idx_max+1+(ULONG)(mask_max)+1;
+  FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(haystack_mask_count_plus_span));
+  needle_idx=0;
+  do{
+    FRU128_FROM_FRU64_MULTIPLY_U64(diventropy, log, (u64)(needle_mask_count_list_base[needle_idx])<<(64-58));
+    needle_diventropy_list_base[needle_idx]=diventropy;
+  }while((needle_idx++)!=needle_idx_max);
+  mask=0;
+  needle_freq_idx=0;
+  do{
+    haystack_freq=haystack_freq_list_base[mask];
+    if(haystack_freq){
+      haystack_freq_agnostic=haystack_freq+1;
+      FRU64_LOG_U64_NONZERO_CACHED(log, log_idx_max, log_list_base, log_parameter_list_base, (u64)(haystack_freq_agnostic));
+      needle_idx=0;
+      do{
+        needle_freq=needle_freq_list_base[needle_freq_idx+needle_idx];
+        diventropy=needle_diventropy_list_base[needle_idx];
+        diventropy_delta=diventropy_delta_zero;
+        if(needle_freq){
+          FRU128_FROM_FRU64_MULTIPLY_U64(diventropy_delta, log, (u64)(needle_freq)<<(64-58));
+        }
+        FRU128_SUBTRACT_FRU128_SELF(diventropy, diventropy_delta, overflow_status);
+        needle_diventropy_list_base[needle_idx]=diventropy;
+      }while((needle_idx++)!=needle_idx_max);
+    }
+    needle_freq_idx+=needle_count;
+  }while((mask++)!=mask_max);
+  U128_FROM_BOOL(diventropy_threshold, append_mode);
+  match_list_idx=0;
+  needle_idx=0;
+  do{
+    diventropy=needle_diventropy_list_base[needle_idx];
+    FRU128_MEAN_TO_FTD128(diventropy_mean, diventropy);
+    needle_diventropy_mean_list_base[needle_idx]=diventropy_mean;
+    needle_diventropy_threshold_list_base[needle_idx]=diventropy_threshold;
+    if(!match_idx_max_max){
+      needle_diventropy_threshold_list_base[needle_idx]=diventropy_mean;
+    }
+    diventropy_list_base[match_list_idx]=diventropy;
+    if(match_u8_idx_list_base){
+      match_u8_idx_list_base[match_list_idx]=0;
+    }
+    match_count_list_base[needle_idx]=1;
+    match_list_idx+=match_list_idx_delta;
+  }while((needle_idx++)!=needle_idx_max);
+  u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
+  u8_idx=(sweep_mask_idx_max+1)*u8_idx_delta;
+  u8_idx_max=haystack_mask_idx_max*u8_idx_delta;
+  u8_idx_old=0;
+  while(u8_idx<=u8_idx_max){
+    mask=haystack_mask_list_base[u8_idx];
+    mask_old=haystack_mask_list_base[u8_idx_old];
+    if(granularity){
+      mask_u8=haystack_mask_list_base[u8_idx+U16_BYTE_MAX];
+      mask|=(u32)(mask_u8)<<U8_BITS;
+      mask_u8=haystack_mask_list_base[u8_idx_old+U16_BYTE_MAX];
+      mask_old|=(u32)(mask_u8)<<U8_BITS;
+      if(U16_BYTE_MAX<granularity){
+        mask_u8=haystack_mask_list_base[u8_idx+U24_BYTE_MAX];
+        mask|=(u32)(mask_u8)<<U16_BITS;
+        mask_u8=haystack_mask_list_base[u8_idx_old+U24_BYTE_MAX];
+        mask_old|=(u32)(mask_u8)<<U16_BITS;
+        if(U24_BYTE_MAX<granularity){
+          mask_u8=haystack_mask_list_base[u8_idx+U32_BYTE_MAX];
+          mask|=(u32)(mask_u8)<<U24_BITS;
+          mask_u8=haystack_mask_list_base[u8_idx_old+U32_BYTE_MAX];
+          mask_old|=(u32)(mask_u8)<<U24_BITS;
+        }
+      }
+    }
+    u8_idx+=u8_idx_delta;
+    u8_idx_old+=u8_idx_delta;
+    if(mask!=mask_old){
+/*
+Update the haystack frequencies and their log deltas once, then account for the diventropy difference of each needle as agnentroprox_diventropy_transform() would.
+*/
+      haystack_freq=haystack_freq_list_base[mask];
+      haystack_freq_old=haystack_freq_list_base[mask_old];
+      haystack_freq_list_base[mask_old]=haystack_freq_old-1;
+      FRU64_LOG_DELTA_U64_NONZERO_CACHED(log_delta_old, log_delta_idx_max, log_delta_list_base, log_delta_parameter_list_base, (u64)(haystack_freq_old));
+      haystack_freq_agnostic=haystack_freq+1;
+      haystack_freq_list_base[mask]=haystack_freq_agnostic;
+      FRU64_LOG_DELTA_U64_NONZERO_CACHED(log_delta, log_delta_idx_max, log_delta_list_base, log_delta_parameter_list_base, (u64)(haystack_freq_agnostic));
+      needle_freq_idx=(ULONG)(mask)*needle_count;
+      needle_freq_idx_old=(ULONG)(mask_old)*needle_count;
+      needle_idx=0;
+      do{
+        needle_freq=needle_freq_list_base[needle_freq_idx+needle_idx];
+        needle_freq_old=needle_freq_list_base[needle_freq_idx_old+needle_idx];
+        diventropy=needle_diventropy_list_base[needle_idx];
+        diventropy_delta=diventropy_delta_zero;
+        if(needle_freq_old){
+          FRU128_FROM_FRU64_MULTIPLY_U64(diventropy_delta, log_delta_old, (u64)(needle_freq_old)<<(64-58));
+        }
+        FRU128_ADD_FRU128_SELF(diventropy, diventropy_delta, overflow_status);
+        diventropy_delta=diventropy_delta_zero;
+        if(needle_freq){
+          FRU128_FROM_FRU64_MULTIPLY_U64(diventropy_delta, log_delta, (u64)(needle_freq)<<(64-58));
+        }
+        FRU128_SUBTRACT_FRU128_SELF(diventropy, diventropy_delta, overflow_status);
+        needle_diventropy_list_base[needle_idx]=diventropy;
+        FRU128_MEAN_TO_FTD128(diventropy_mean, diventropy);
+        needle_diventropy_mean_list_base[needle_idx]=diventropy_mean;
+      }while((needle_idx++)!=needle_idx_max);
+    }
+    match_list_idx=0;
+    needle_idx=0;
+    do{
+      diventropy_mean=needle_diventropy_mean_list_base[needle_idx];
+      diventropy_threshold=needle_diventropy_threshold_list_base[needle_idx];
+      match_count=match_count_list_base[needle_idx];
+      if(!append_mode){
+        match_status_not=U128_IS_LESS(diventropy_mean, diventropy_threshold);
+        if(!match_status_not){
+          diventropy=needle_diventropy_list_base[needle_idx];
+          match_status_not=fracterval_u128_rank_list_insert_descending(diventropy, &match_count, &match_idx, match_idx_max_max, &diventropy_list_base[match_list_idx], &diventropy_threshold);
+          needle_diventropy_threshold_list_base[needle_idx]=diventropy_threshold;
+        }
+      }else if(append_mode==1){
+        match_status_not=U128_IS_LESS(diventropy_threshold, diventropy_mean);
+        if(!match_status_not){
+          diventropy=needle_diventropy_list_base[needle_idx];
+          match_status_not=fracterval_u128_rank_list_insert_ascending(diventropy, &match_count, &match_idx, match_idx_max_max, &diventropy_list_base[match_list_idx], &diventropy_threshold);
+          needle_diventropy_threshold_list_base[needle_idx]=diventropy_threshold;
+        }
+      }else{
+        match_idx=match_count;
+        match_status_not=1;
+        if(match_count<=match_idx_max_max){
+          match_status_not=0;
+          diventropy_list_base[match_list_idx+match_count]=needle_diventropy_list_base[needle_idx];
+          match_count++;
+        }
+      }
+      if(!match_status_not){
+        match_count_list_base[needle_idx]=match_count;
+        if(match_u8_idx_list_base){
+          match_idx_min=match_list_idx+match_idx;
+          match_idx=match_list_idx+match_count-1;
+          while(match_idx!=match_idx_min){
+            match_u8_idx_list_base[match_idx]=match_u8_idx_list_base[match_idx-1];
+            match_idx--;
+          }
+          match_u8_idx_list_base[match_idx]=u8_idx_old;
+        }
+      }
+      match_list_idx+=match_list_idx_delta;
+    }while((needle_idx++)!=needle_idx_max);
+  }
+  *overflow_status_base=overflow_status;
+  return;
+}
+
+ULONG
+agnentroprox_multimatch_find(ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG match_idx_max_max, ULONG *match_needle_idx_list_base, ULONG *match_u8_idx_list_base, agnentroprox_multimatch_t *multimatch_base){
+/*
+Find exact matches of any of a list of needles in a haystack, in a single pass.
+
+In:
+
+  haystack_mask_idx_max is agnentroprox_match_find():In:haystack_mask_idx_max.
+
+  *haystack_mask_list_base is the haystack.
+
+  match_idx_max_max is one less than the maximum number of matches to report starting from either end of the haystack, depending on agnentroprox_multimatch_init():In:ascending_status.
+
+  *match_needle_idx_list_base is NULL if the needle indexes associated with matches can be discarded, else the base of (match_idx_max_max+1) undefined items to hold such indexes.
+
+  *match_u8_idx_list_base is NULL if the base indexes associated with matches can be discarded, else the base of (match_idx_max_max+1) undefined items to hold such indexes.
+
+  multimatch_base is the return value of agnentroprox_multimatch_init().
+
+Out:
+
+  Returns the number of matches found, on [0, match_idx_max_max+1].
+
+  *match_needle_idx_list_base and *match_u8_idx_list_base contain (return value) pairs, each of which is the index of a needle in the agnentroprox_multimatch_init():In:needle_mask_idx_max_list_base and the u8 index of the base of a copy of that needle in *haystack_mask_list_base. Matches are reported in the order in which their last bytes (or first bytes, if searching backward) were encountered. Matches which end (or begin) at the same byte are reported from longest to shortest needle, and identical needles in ascending order. As with agnentroprox_match_find(), matches which aren't aligned to a (granularity+1)-byte boundary are ignored if overlap_status is zero.
+*/
+  u8 ascending_status;
+  u8 case_insensitive_status;
+  ULONG child_state_idx;
+  ULONG *child_state_idx_list_base;
+  ULONG dense_state_idx_idx;
+  ULONG *dense_state_idx_list_base;
+  ULONG *fail_state_idx_list_base;
+  u8 granularity;
+  u8 haystack_u8;
+  ULONG haystack_u8_idx;
+  ULONG haystack_u8_idx_delta;
+  ULONG haystack_u8_idx_max;
+  ULONG match_idx;
+  ULONG match_u8_idx;
+  ULONG needle_idx;
+  ULONG *needle_idx_list_base;
+  ULONG *needle_next_idx_list_base;
+  ULONG output_state_idx;
+  ULONG *output_state_idx_list_base;
+  ULONG *sibling_state_idx_list_base;
+  ULONG state_idx;
+  ULONG u8_idx_delta;
+  ULONG *u8_idx_max_list_base;
+  u8 *u8_list_base;
+
+  ascending_status=multimatch_base->ascending_status;
+  case_insensitive_status=multimatch_base->case_insensitive_status;
+  child_state_idx_list_base=multimatch_base->child_state_idx_list_base;
+  dense_state_idx_list_base=multimatch_base->dense_state_idx_list_base;
+  fail_state_idx_list_base=multimatch_base->fail_state_idx_list_base;
+  granularity=multimatch_base->granularity;
+  needle_idx_list_base=multimatch_base->needle_idx_list_base;
+  needle_next_idx_list_base=multimatch_base->needle_next_idx_list_base;
+  output_state_idx_list_base=multimatch_base->output_state_idx_list_base;
+  sibling_state_idx_list_base=multimatch_base->sibling_state_idx_list_base;
+  u8_idx_max_list_base=multimatch_base->u8_idx_max_list_base;
+  u8_list_base=multimatch_base->u8_list_base;
+  u8_idx_delta=(u8)((u8)(granularity*(!multimatch_base->overlap_status))+1);
+  haystack_u8_idx_max=(haystack_mask_idx_max*u8_idx_delta)+granularity;
+  haystack_u8_idx=0;
+  haystack_u8_idx_delta=1;
+  if(!ascending_status){
+    haystack_u8_idx=haystack_u8_idx_max;
+    haystack_u8_idx_delta=ULONG_MAX;
+  }
+  match_idx=0;
+  state_idx=0;
+  do{
+    haystack_u8=haystack_mask_list_base[haystack_u8_idx];
+    if(case_insensitive_status){
+      haystack_u8=(u8)(haystack_u8|((((u8)(haystack_u8-'A'))<=('Z'-'A'))<<5));
+    }
+/*
+Follow failure links until we find a state with a child labelled haystack_u8, or reach the root or one of its children, all of which have dense transition lists which already account for failure.
+*/
+    child_state_idx=0;
+    while(u8_idx_max_list_base[state_idx]){
+      child_state_idx=child_state_idx_list_base[state_idx];
+      while(child_state_idx&&(u8_list_base[child_state_idx]!=haystack_u8)){
+        child_state_idx=sibling_state_idx_list_base[child_state_idx];
+      }
+      if(child_state_idx){
+        break;
+      }
+      state_idx=fail_state_idx_list_base[state_idx];
+    }
+    if(!u8_idx_max_list_base[state_idx]){
+      dense_state_idx_idx=0;
+      if(state_idx){
+        dense_state_idx_idx=(ULONG)(u8_list_base[state_idx]+1U)<<U8_BITS;
+      }
+      child_state_idx=dense_state_idx_list_base[dense_state_idx_idx+haystack_u8];
+    }
+    state_idx=child_state_idx;
+    output_state_idx=state_idx;
+    if(needle_idx_list_base[output_state_idx]==ULONG_MAX){
+      output_state_idx=output_state_idx_list_base[output_state_idx];
+    }
+    while(output_state_idx){
+      match_u8_idx=haystack_u8_idx;
+      if(ascending_status){
+        match_u8_idx-=u8_idx_max_list_base[output_state_idx];
+      }
+      if(!(match_u8_idx%u8_idx_delta)){
+        needle_idx=needle_idx_list_base[output_state_idx];
+        do{
+          if(match_needle_idx_list_base){
+            match_needle_idx_list_base[match_idx]=needle_idx;
+          }
+          if(match_u8_idx_list_base){
+            match_u8_idx_list_base[match_idx]=match_u8_idx;
+          }
+          match_idx++;
+          if(match_idx_max_max<match_idx){
+            break;
+          }
+          needle_idx=needle_next_idx_list_base[needle_idx];
+        }while(needle_idx!=ULONG_MAX);
+        if(match_idx_max_max<match_idx){
+          break;
+        }
+      }
+      output_state_idx=output_state_idx_list_base[output_state_idx];
+    }
+    haystack_u8_idx+=haystack_u8_idx_delta;
+  }while((haystack_u8_idx<=haystack_u8_idx_max)&&(match_idx<=match_idx_max_max));
+  return match_idx;
+}
+
+agnentroprox_multimatch_t *
+agnentroprox_multimatch_free_all(agnentroprox_multimatch_t *multimatch_base){
+/*
+Free an Aho-Corasick automaton.
+
+In:
+
+  multimatch_base is the return value of agnentroprox_multimatch_init(). May be NULL.
+
+Out:
+
+  Returns NULL so that the caller can easily maintain the good practice of NULLing out invalid pointers.
+
+  *multimatch_base and all its child allocations are freed.
+*/
+  if(multimatch_base){
+    agnentroprox_free(multimatch_base->u8_list_base);
+    agnentroprox_free(multimatch_base->u8_idx_max_list_base);
+    agnentroprox_free(multimatch_base->sibling_state_idx_list_base);
+    agnentroprox_free(multimatch_base->output_state_idx_list_base);
+    agnentroprox_free(multimatch_base->needle_next_idx_list_base);
+    agnentroprox_free(multimatch_base->needle_idx_list_base);
+    agnentroprox_free(multimatch_base->fail_state_idx_list_base);
+    agnentroprox_free(multimatch_base->dense_state_idx_list_base);
+    agnentroprox_free(multimatch_base->child_state_idx_list_base);
+    multimatch_base=agnentroprox_free(multimatch_base);
+  }
+  return multimatch_base;
+}
+
+agnentroprox_multimatch_t *
+agnentroprox_multimatch_init(u8 ascending_status, u8 case_insensitive_status, u8 granularity, ULONG needle_idx_max, ULONG *needle_mask_idx_max_list_base, u8 *needle_mask_list_base, u8 overlap_status){
+/*
+Build an Aho-Corasick automaton for finding exact matches of any of a list of needles in a single pass over a haystack.
+
+In:
+
+  ascending_status is one to search from the beginning of the haystack forward, else zero to search from the end backward. In the latter case, the automaton is built from the needles in reverse.
+
+  case_insensitive_status is agnentroprox_match_find():In:case_insensitive_status.
+
+  granularity is agnentroprox_match_find():In:granularity.
+
+  needle_idx_max is one less than the number of needles.
+
+  *needle_mask_idx_max_list_base contains (needle_idx_max+1) needle sizes, each of which is in the sense of agnentroprox_match_find():In:needle_mask_idx_max.
+
+  *needle_mask_list_base is the concatenation of all the needles, each of which spans the number of bytes implied by its entry in *needle_mask_idx_max_list_base, and nothing more. This list can be freed as soon as this function returns.
+
+  overlap_status is agnentroprox_match_find():In:overlap_status.
+
+Out:
+
+  Returns NULL on failure, else the base of an automaton to pass to agnentroprox_multimatch_find(), which must eventually be freed via agnentroprox_multimatch_free_all().
+*/
+  ULONG child_state_idx;
+  ULONG *child_state_idx_list_base;
+  ULONG dense_state_idx_idx;
+  ULONG *dense_state_idx_list_base;
+  ULONG fail_state_idx;
+  ULONG *fail_state_idx_list_base;
+  ULONG goto_state_idx;
+  agnentroprox_multimatch_t *multimatch_base;
+  ULONG needle_idx;
+  ULONG *needle_idx_list_base;
+  ULONG *needle_next_idx_list_base;
+  u8 needle_u8;
+  ULONG needle_u8_idx;
+  ULONG needle_u8_idx_base;
+  ULONG needle_u8_idx_max;
+  ULONG needle_u8_idx_min;
+  ULONG *output_state_idx_list_base;
+  ULONG queue_idx;
+  ULONG queue_idx_post;
+  ULONG *queue_state_idx_list_base;
+  ULONG *sibling_state_idx_list_base;
+  ULONG state_idx;
+  ULONG state_idx_max;
+  ULONG state_idx_max_max;
+  u8 status;
+  ULONG u8_idx_delta;
+  ULONG *u8_idx_max_list_base;
+  u8 *u8_list_base;
+
+  needle_idx=0;
+  state_idx_max_max=0;
+  status=0;
+  u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
+/*
+There can be at most one state per needle byte, plus the root. Don't allow the count to wrap.
+*/
+  do{
+    needle_u8_idx_max=(needle_mask_idx_max_list_base[needle_idx]*u8_idx_delta)+granularity;
+    state_idx_max_max+=needle_u8_idx_max+1;
+    status=(u8)(status|(state_idx_max_max<=needle_u8_idx_max));
+  }while((needle_idx++)!=needle_idx_max);
+  multimatch_base=NULL;
+  status=(u8)(status|(state_idx_max_max==ULONG_MAX));
+  if(!status){
+/*
+Use calloc() so that agnentroprox_multimatch_free_all() can clean up after a partial allocation failure.
+*/
+    multimatch_base=DEBUG_CALLOC_PARANOID((ULONG)(sizeof(agnentroprox_multimatch_t)));
+  }
+  if(multimatch_base){
+    child_state_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->child_state_idx_list_base=child_state_idx_list_base;
+    status=!child_state_idx_list_base;
+    dense_state_idx_list_base=agnentroprox_ulong_list_malloc(((U8_SPAN+1)<<U8_BITS)-1);
+    multimatch_base->dense_state_idx_list_base=dense_state_idx_list_base;
+    status=(u8)(status|!dense_state_idx_list_base);
+    fail_state_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->fail_state_idx_list_base=fail_state_idx_list_base;
+    status=(u8)(status|!fail_state_idx_list_base);
+    needle_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->needle_idx_list_base=needle_idx_list_base;
+    status=(u8)(status|!needle_idx_list_base);
+    needle_next_idx_list_base=agnentroprox_ulong_list_malloc(needle_idx_max);
+    multimatch_base->needle_next_idx_list_base=needle_next_idx_list_base;
+    status=(u8)(status|!needle_next_idx_list_base);
+    output_state_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->output_state_idx_list_base=output_state_idx_list_base;
+    status=(u8)(status|!output_state_idx_list_base);
+    sibling_state_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->sibling_state_idx_list_base=sibling_state_idx_list_base;
+    status=(u8)(status|!sibling_state_idx_list_base);
+    u8_idx_max_list_base=agnentroprox_ulong_list_malloc(state_idx_max_max);
+    multimatch_base->u8_idx_max_list_base=u8_idx_max_list_base;
+    status=(u8)(status|!u8_idx_max_list_base);
+    u8_list_base=agnentroprox_mask_list_malloc(0, state_idx_max_max, 1);
+    multimatch_base->u8_list_base=u8_list_base;
+    status=(u8)(status|!u8_list_base);
+    if(!status){
+      multimatch_base->ascending_status=ascending_status;
+      multimatch_base->case_insensitive_status=case_insensitive_status;
+      multimatch_base->granularity=granularity;
+      multimatch_base->overlap_status=overlap_status;
+      agnentroprox_ulong_list_zero(U8_MAX, dense_state_idx_list_base);
+      child_state_idx_list_base[0]=0;
+      fail_state_idx_list_base[0]=0;
+      needle_idx_list_base[0]=ULONG_MAX;
+      output_state_idx_list_base[0]=0;
+      u8_idx_max_list_base[0]=0;
+/*
+Build the trie. Insert the needles in reverse order, so that each needle is prepended to the chain of identical needles, leaving the chain in ascending order. Children are linked to their siblings, except under the root, which has a dense transition list. The dense transition lists of the root's children are filled in after the failure links are known.
+*/
+      needle_u8_idx_base=0;
+      needle_idx=0;
+      do{
+        needle_u8_idx_max=(needle_mask_idx_max_list_base[needle_idx]*u8_idx_delta)+granularity;
+        needle_u8_idx_base+=needle_u8_idx_max+1;
+      }while((needle_idx++)!=needle_idx_max);
+      state_idx_max=0;
+      needle_idx=needle_idx_max;
+      do{
+        needle_u8_idx_max=(needle_mask_idx_max_list_base[needle_idx]*u8_idx_delta)+granularity;
+        needle_u8_idx_base-=needle_u8_idx_max+1;
+        needle_u8_idx=0;
+        state_idx=0;
+        do{
+          needle_u8_idx_min=needle_u8_idx;
+          if(!ascending_status){
+            needle_u8_idx_min=needle_u8_idx_max-needle_u8_idx;
+          }
+          needle_u8=needle_mask_list_base[needle_u8_idx_base+needle_u8_idx_min];
+          if(case_insensitive_status){
+            needle_u8=(u8)(needle_u8|((((u8)(needle_u8-'A'))<=('Z'-'A'))<<5));
+          }
+          if(!state_idx){
+            child_state_idx=dense_state_idx_list_base[needle_u8];
+          }else{
+            child_state_idx=child_state_idx_list_base[state_idx];
+            while(child_state_idx&&(u8_list_base[child_state_idx]!=needle_u8)){
+              child_state_idx=sibling_state_idx_list_base[child_state_idx];
+            }
+          }
+          if(!child_state_idx){
+            state_idx_max++;
+            child_state_idx=state_idx_max;
+            child_state_idx_list_base[child_state_idx]=0;
+            needle_idx_list_base[child_state_idx]=ULONG_MAX;
+            u8_idx_max_list_base[child_state_idx]=needle_u8_idx;
+            u8_list_base[child_state_idx]=needle_u8;
+            if(!state_idx){
+              dense_state_idx_list_base[needle_u8]=child_state_idx;
+              sibling_state_idx_list_base[child_state_idx]=0;
+            }else{
+              sibling_state_idx_list_base[child_state_idx]=child_state_idx_list_base[state_idx];
+              child_state_idx_list_base[state_idx]=child_state_idx;
+            }
+          }
+          state_idx=child_state_idx;
+        }while((needle_u8_idx++)!=needle_u8_idx_max);
+        needle_next_idx_list_base[needle_idx]=needle_idx_list_base[state_idx];
+        needle_idx_list_base[state_idx]=needle_idx;
+      }while(needle_idx--);
+/*
+Compute the failure and output links in breadth-first order, so that the links of all shallower states are known by the time we need them. The output link of a state is the nearest state along its failure chain at which a needle ends, or the root if none.
+*/
+      queue_state_idx_list_base=agnentroprox_ulong_list_malloc(state_idx_max);
+      status=!queue_state_idx_list_base;
+      if(!status){
+        queue_idx_post=0;
+        needle_u8=0;
+        do{
+          child_state_idx=dense_state_idx_list_base[needle_u8];
+          if(child_state_idx){
+            fail_state_idx_list_base[child_state_idx]=0;
+            output_state_idx_list_base[child_state_idx]=0;
+            queue_state_idx_list_base[queue_idx_post]=child_state_idx;
+            queue_idx_post++;
+          }
+        }while((needle_u8++)!=U8_MAX);
+        queue_idx=0;
+        while(queue_idx!=queue_idx_post){
+          state_idx=queue_state_idx_list_base[queue_idx];
+          queue_idx++;
+          child_state_idx=child_state_idx_list_base[state_idx];
+          while(child_state_idx){
+            needle_u8=u8_list_base[child_state_idx];
+            fail_state_idx=fail_state_idx_list_base[state_idx];
+            goto_state_idx=0;
+            while(fail_state_idx){
+              goto_state_idx=child_state_idx_list_base[fail_state_idx];
+              while(goto_state_idx&&(u8_list_base[goto_state_idx]!=needle_u8)){
+                goto_state_idx=sibling_state_idx_list_base[goto_state_idx];
+              }
+              if(goto_state_idx){
+                break;
+              }
+              fail_state_idx=fail_state_idx_list_base[fail_state_idx];
+            }
+            if(!fail_state_idx){
+              goto_state_idx=dense_state_idx_list_base[needle_u8];
+            }
+            fail_state_idx=goto_state_idx;
+            fail_state_idx_list_base[child_state_idx]=fail_state_idx;
+            if(needle_idx_list_base[fail_state_idx]==ULONG_MAX){
+              fail_state_idx=output_state_idx_list_base[fail_state_idx];
+            }
+            output_state_idx_list_base[child_state_idx]=fail_state_idx;
+            queue_state_idx_list_base[queue_idx_post]=child_state_idx;
+            queue_idx_post++;
+            child_state_idx=sibling_state_idx_list_base[child_state_idx];
+          }
+        }
+        agnentroprox_free(queue_state_idx_list_base);
+/*
+Give each child of the root a dense transition list indexed by its label, starting with the root's own because that's where it fails to, then overlaying its children. The search loop then needs no sibling scans or failure links in the shallow states where it spends most of its time.
+*/
+        needle_u8=0;
+        do{
+          state_idx=dense_state_idx_list_base[needle_u8];
+          if(state_idx){
+            dense_state_idx_idx=(ULONG)(needle_u8+1U)<<U8_BITS;
+            agnentroprox_ulong_list_copy(U8_MAX, dense_state_idx_list_base, &dense_state_idx_list_base[dense_state_idx_idx]);
+            child_state_idx=child_state_idx_list_base[state_idx];
+            while(child_state_idx){
+              dense_state_idx_list_base[dense_state_idx_idx+u8_list_base[child_state_idx]]=child_state_idx;
+              child_state_idx=sibling_state_idx_list_base[child_state_idx];
+            }
+          }
+        }while((needle_u8++)!=U8_MAX);
+      }
+    }
+    if(status){
+      multimatch_base=agnentroprox_multimatch_free_all(multimatch_base);
+    }
+  }
+  return multimatch_base;
+}
+
+agnentroprox_multineedle_t *
+agnentroprox_multineedle_free_all(agnentroprox_multineedle_t *multineedle_base){
+/*
+Free a list of needle frequency lists.
+
+In:
+
+  multineedle_base is the return value of agnentroprox_multineedle_init(). May be NULL.
+
+Out:
+
+  Returns NULL so that the caller can easily maintain the good practice of NULLing out invalid pointers.
+
+  *multineedle_base and all its child allocations are freed.
+*/
+  if(multineedle_base){
+    agnentroprox_free(multineedle_base->mask_count_list_base);
+    agnentroprox_free(multineedle_base->freq_list_base);
+    agnentroprox_free(multineedle_base->diventropy_threshold_list_base);
+    agnentroprox_free(multineedle_base->diventropy_mean_list_base);
+    fracterval_u128_free(multineedle_base->diventropy_list_base);
+    multineedle_base=agnentroprox_free(multineedle_base);
+  }
+  return multineedle_base;
+}
+
+agnentroprox_multineedle_t *
+agnentroprox_multineedle_init(agnentroprox_t *agnentroprox_base, ULONG needle_idx_max, ULONG *needle_mask_idx_max_list_base, u8 *needle_mask_list_base){
+/*
+Load the mask frequencies of a list of needles in preparation for a series of agnentroprox_multidiventropy_transform() calls.
+
+In:
+
+  agnentroprox_base is the return value of agenentroprox_init(). Its mask_max must not change (see agnentroprox_mask_max_set()) until the return value has been freed.
+
+  needle_idx_max is one less than the number of needles.
+
+  *needle_mask_idx_max_list_base contains (needle_idx_max+1) needle sizes, each of which is in the sense of agnentroprox_mask_list_load():In:mask_idx_max.
+
+  *needle_mask_list_base is the concatenation of all the needles, each of which spans the number of bytes implied by its entry in *needle_mask_idx_max_list_base, and nothing more. This list can be freed as soon as this function returns.
+
+Out:
+
+  Returns NULL on failure, else the base of a list of needle frequency lists which must eventually be freed via agnentroprox_multineedle_free_all(). The frequencies of a given mask in all the needles are adjacent, so a single haystack frequency change touches as few cache lines as possible. This costs ((needle_idx_max+1)*(mask_max+1)) of (ULONG)s, so it's best suited to small masks.
+*/
+  fru128 *diventropy_list_base;
+  u128 *diventropy_mean_list_base;
+  u128 *diventropy_threshold_list_base;
+  ULONG freq;
+  ULONG freq_count;
+  ULONG freq_idx;
+  ULONG *freq_list_base;
+  u8 granularity;
+  u32 mask;
+  ULONG *mask_count_list_base;
+  u32 mask_max;
+  ULONG mask_span;
+  u8 mask_u8;
+  agnentroprox_multineedle_t *multineedle_base;
+  ULONG needle_count;
+  ULONG needle_idx;
+  ULONG needle_mask_idx_max;
+  ULONG needle_u8_idx_base;
+  u8 overlap_status;
+  u8 status;
+  ULONG u8_idx;
+  ULONG u8_idx_delta;
+  ULONG u8_idx_max;
+
+  granularity=agnentroprox_base->granularity;
+  mask_max=agnentroprox_base->mask_max;
+  overlap_status=agnentroprox_base->overlap_status;
+  multineedle_base=NULL;
+/*
+Don't allow the frequency list size to wrap, nor any needle to contain so many masks (2^57 or more) that agnentroprox_multidiventropy_transform() couldn't shift its mask count from 6.58 to 6.64 fixed point.
+*/
+  mask_span=(ULONG)(mask_max)+1;
+  needle_count=needle_idx_max+1;
+  status=!(mask_span&&needle_count);
+  needle_idx=0;
+  do{
+    status=(u8)(status|!!((u64)(needle_mask_idx_max_list_base[needle_idx])>>(58-1)));
+  }while((needle_idx++)!=needle_idx_max);
+  freq_count=0;
+  if(!status){
+    freq_count=mask_span*needle_count;
+    status=((freq_count/needle_count)!=mask_span);
+  }
+  if(!status){
+/*
+Use calloc() so that agnentroprox_multineedle_free_all() can clean up after a partial allocation failure.
+*/
+    multineedle_base=DEBUG_CALLOC_PARANOID((ULONG)(sizeof(agnentroprox_multineedle_t)));
+  }
+  if(multineedle_base){
+    diventropy_list_base=fracterval_u128_rank_list_malloc(needle_idx_max);
+    multineedle_base->diventropy_list_base=diventropy_list_base;
+    status=!diventropy_list_base;
+    diventropy_mean_list_base=agnentroprox_u128_list_malloc(needle_idx_max);
+    multineedle_base->diventropy_mean_list_base=diventropy_mean_list_base;
+    status=(u8)(status|!diventropy_mean_list_base);
+    diventropy_threshold_list_base=agnentroprox_u128_list_malloc(needle_idx_max);
+    multineedle_base->diventropy_threshold_list_base=diventropy_threshold_list_base;
+    status=(u8)(status|!diventropy_threshold_list_base);
+    freq_list_base=agnentroprox_ulong_list_malloc(freq_count-1);
+    multineedle_base->freq_list_base=freq_list_base;
+    status=(u8)(status|!freq_list_base);
+    mask_count_list_base=agnentroprox_ulong_list_malloc(needle_idx_max);
+    multineedle_base->mask_count_list_base=mask_count_list_base;
+    status=(u8)(status|!mask_count_list_base);
+    if(!status){
+      multineedle_base->needle_idx_max=needle_idx_max;
+      agnentroprox_ulong_list_zero(freq_count-1, freq_list_base);
+      u8_idx_delta=(u8)((u8)(granularity*(!overlap_status))+1);
+      needle_idx=0;
+      needle_u8_idx_base=0;
+      do{
+        needle_mask_idx_max=needle_mask_idx_max_list_base[needle_idx];
+        mask_count_list_base[needle_idx]=needle_mask_idx_max+1;
+        u8_idx=needle_u8_idx_base;
+        u8_idx_max=needle_u8_idx_base+(needle_mask_idx_max*u8_idx_delta);
+        do{
+          mask=needle_mask_list_base[u8_idx];
+          if(granularity){
+            mask_u8=needle_mask_list_base[u8_idx+U16_BYTE_MAX];
+            mask|=(u32)(mask_u8)<<U8_BITS;
+            if(U16_BYTE_MAX<granularity){
+              mask_u8=needle_mask_list_base[u8_idx+U24_BYTE_MAX];
+              mask|=(u32)(mask_u8)<<U16_BITS;
+              if(U24_BYTE_MAX<granularity){
+                mask_u8=needle_mask_list_base[u8_idx+U32_BYTE_MAX];
+                mask|=(u32)(mask_u8)<<U24_BITS;
+              }
+            }
+          }
+          freq_idx=((ULONG)(mask)*needle_count)+needle_idx;
+          freq=freq_list_base[freq_idx];
+          freq++;
+          u8_idx+=u8_idx_delta;
+          freq_list_base[freq_idx]=freq;
+        }while(u8_idx<=u8_idx_max);
+        needle_u8_idx_base=u8_idx_max+granularity+1;
+      }while((needle_idx++)!=needle_idx_max);
+    }else{
+      multineedle_base=agnentroprox_multineedle_free_all(multineedle_base);
+    }
+  }
+  return multineedle_base;
+}
+
+u8
+agnentroprox_rank_compare(u8 ascending_status, agnentroprox_rank_t *rank_base0, agnentroprox_rank_t *rank_base1){
+/*
+Determine whether one rank must precede another in a rank list. The ordering is total, so ranks produced by different threads or machines can be merged with a deterministic result.
+
+In:
+
+  ascending_status is one if the rank list is sorted ascending by entropy mean, else zero if descending.
+
+  rank_base0 is the base of the first rank to compare.
+
+  rank_base1 is the base of the second rank to compare.
+
+Out:
+
+  Returns one if *rank_base0 must precede *rank_base1, else zero. Ranks are ordered by the mean of (agnentroprox_rank_t).entropy in the direction given by ascending_status, then ascending by file_idx, then ascending by u8_idx, then ascending by the lower and upper bounds of entropy. Thus two ranks which precede neither one another are identical.
+*/
+  fru128 entropy0;
+  fru128 entropy1;
+  u64 file_idx0;
+  u64 file_idx1;
+  u128 mean0;
+  u128 mean1;
+  u8 status;
+  u64 u8_idx0;
+  u64 u8_idx1;
+
+  entropy0=rank_base0->entropy;
+  entropy1=rank_base1->entropy;
+  FRU128_MEAN_TO_FTD128(mean0, entropy0);
+  FRU128_MEAN_TO_FTD128(mean1, entropy1);
+  status=U128_IS_LESS(mean1, mean0);
+  if(ascending_status){
+    status=U128_IS_LESS(mean0, mean1);
+  }
+  if(U128_IS_EQUAL(mean0, mean1)){
+/*
+Break ties in favor of the earlier file, as would happen anyway when ranking files in order.
+*/
+    file_idx0=rank_base0->file_idx;
+    file_idx1=rank_base1->file_idx;
+    status=(file_idx0<file_idx1);
+    if(file_idx0==file_idx1){
+      u8_idx0=rank_base0->u8_idx;
+      u8_idx1=rank_base1->u8_idx;
+      status=(u8_idx0<u8_idx1);
+      if(u8_idx0==u8_idx1){
+        status=U128_IS_LESS(entropy0.a, entropy1.a);
+        if(U128_IS_EQUAL(entropy0.a, entropy1.a)){
+          status=U128_IS_LESS(entropy0.b, entropy1.b);
+        }
+      }
+    }
+  }
+  return status;
+}
+
+u8
+agnentroprox_rank_list_deserialize(u8 *ascending_status_base, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, ULONG serial_size, u64 *serial_u64_list_base){
+/*
+Import a rank list which was exported by agnentroprox_rank_list_serialize(), possibly on another machine of the same endianness.
+
+In:
+
+  *ascending_status_base is undefined.
+
+  *rank_count_base is undefined.
+
+  rank_idx_max_max is (agnentroprox_rank_list_malloc():In:rank_idx_max_max).
+
+  rank_list_base is the return value of agnentroprox_rank_list_malloc().
+
+  serial_size is the size of the serialized rank list in bytes.
+
+  serial_u64_list_base is the base of the serialized rank list.
+
+Out:
+
+  Returns zero on success, else one if the serialized rank list was invalid, misordered, or too long to fit in rank_idx_max_max.
+
+  *ascending_status_base is one if the rank list is sorted ascending, else zero if descending. Undefined on failure.
+
+  *rank_count_base is the number of ranks imported. Undefined on failure.
+
+  *rank_list_base contains the imported ranks. Undefined on failure.
+*/
+  u8 ascending_status;
+  u128 entropy_a;
+  u128 entropy_b;
+  agnentroprox_rank_t rank;
+  ULONG rank_count;
+  ULONG rank_idx;
+  ULONG serial_size_expected;
+  ULONG serial_u64_idx;
+  u8 status;
+  u64 u64_hi;
+  u64 u64_lo;
+
+  status=1;
+  do{
+    if(serial_size<(AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT<<U64_SIZE_LOG2)){
+      break;
+    }
+    if(serial_u64_list_base[0]!=AGNENTROPROX_RANK_LIST_SIGNATURE){
+      break;
+    }
+    if(1<serial_u64_list_base[2]){
+      break;
+    }
+    ascending_status=(u8)(serial_u64_list_base[2]);
+    rank_count=(ULONG)(serial_u64_list_base[1]);
+    if((rank_count!=serial_u64_list_base[1])||(rank_count&&(rank_idx_max_max<(rank_count-1)))){
+      break;
+    }
+    serial_size_expected=agnentroprox_rank_list_serialize(ascending_status, rank_count, rank_list_base, NULL);
+    if(serial_size!=serial_size_expected){
+      break;
+    }
+    status=0;
+    rank_idx=0;
+    serial_u64_idx=AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT;
+    while(rank_idx<rank_count){
+      u64_lo=serial_u64_list_base[serial_u64_idx];
+      u64_hi=serial_u64_list_base[serial_u64_idx+1];
+      U128_FROM_U64_PAIR(entropy_a, u64_lo, u64_hi);
+      u64_lo=serial_u64_list_base[serial_u64_idx+2];
+      u64_hi=serial_u64_list_base[serial_u64_idx+3];
+      U128_FROM_U64_PAIR(entropy_b, u64_lo, u64_hi);
+      rank.entropy.a=entropy_a;
+      rank.entropy.b=entropy_b;
+      rank.file_idx=serial_u64_list_base[serial_u64_idx+4];
+      rank.u8_idx=serial_u64_list_base[serial_u64_idx+5];
+      status=U128_IS_LESS(entropy_b, entropy_a);
+      if(rank_idx){
+        status=(u8)(status|!agnentroprox_rank_compare(ascending_status, &rank_list_base[rank_idx-1], &rank));
+      }
+      if(status){
+        break;
+      }
+      rank_list_base[rank_idx]=rank;
+      rank_idx++;
+      serial_u64_idx+=AGNENTROPROX_RANK_U64_COUNT;
+    }
+    *ascending_status_base=ascending_status;
+    *rank_count_base=rank_count;
+  }while(0);
+  return status;
+}
+
+u8
+agnentroprox_rank_list_insert(u8 ascending_status, fru128 entropy, u64 file_idx, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, u128 *threshold_base, u64 u8_idx){
+/*
+Insert a rank into a rank list sorted in the order defined by agnentroprox_rank_compare(). Unlike fracterval_u128_rank_list_insert_ascending() and fracterval_u128_rank_list_insert_descending(), the file and offset indexes travel with the entropy, so no parallel list needs to be maintained by the caller.
+
+In:
+
+  ascending_status is one if the rank list is sorted ascending by entropy mean, else zero if descending.
+
+  entropy is the fracterval to attempt to insert into the list.
+
+  file_idx is an arbitrary caller-defined identifier of the file containing the match, which should increase with file order in order to preserve traditional tie-breaking behavior.
+
+  *rank_count_base is the number of ranks already in the list.
+
+  rank_idx_max_max is (agnentroprox_rank_list_malloc():In:rank_idx_max_max).
+
+  rank_list_base is the return value of agnentroprox_rank_list_malloc().
+
+  *threshold_base is the maximum (if ascending_status is one) or minimum (if ascending_status is zero) entropy mean to allow in the list on the first call, then fed back thereafter. Its purpose is identical to that of (fracterval_u128_rank_list_insert_ascending():In:*threshold_base). However, because ties are broken by file_idx and u8_idx, entropies whose means equal the threshold must still be submitted if the caller does not submit file_idx in increasing order.
+
+  u8_idx is the u8 index of the match within the file, or zero if irrelevant.
+
+Out:
+
+  Returns zero if the insertion was successful, else one if the rank didn't qualify.
+
+  *rank_count_base is updated.
+
+  *threshold_base is updated and has not become less restrictive.
+*/
+  agnentroprox_rank_t rank;
+  ULONG rank_count;
+  fru128 rank_entropy;
+  ULONG rank_idx0;
+  ULONG rank_idx1;
+  u8 status;
+  u128 threshold;
+
+  rank.entropy=entropy;
+  rank.file_idx=file_idx;
+  rank.u8_idx=u8_idx;
+  rank_count=*rank_count_base;
+  rank_idx0=rank_count;
+  status=1;
+  if(rank_count){
+    status=0;
+    do{
+      rank_idx1=rank_idx0-1;
+      if(!agnentroprox_rank_compare(ascending_status, &rank, &rank_list_base[rank_idx1])){
+        status=(rank_idx0==rank_count);
+        break;
+      }
+      rank_list_base[rank_idx0]=rank_list_base[rank_idx1];
+      rank_idx0=rank_idx1;
+    }while(rank_idx1);
+  }
+  if(rank_count<=rank_idx_max_max){
+    rank_count++;
+    status=0;
+    *rank_count_base=rank_count;
+  }
+  if(!status){
+    rank_list_base[rank_idx0]=rank;
+    if((rank_count-1)==rank_idx_max_max){
+      rank_entropy=rank_list_base[rank_idx_max_max].entropy;
+      FRU128_MEAN_TO_FTD128(threshold, rank_entropy);
+      *threshold_base=threshold;
+    }
+  }
+  return status;
+}
+
+agnentroprox_rank_t *
+agnentroprox_rank_list_malloc(ULONG rank_idx_max_max){
+/*
+Allocate a list of ranks to serve as a list of the greatest or least entropy means, along with the locations at which they were found.
+
+In:
+
+  rank_idx_max_max is one less than the number of ranks to allocate.
+
+Out:
+
+  Returns NULL on failure, else the base of (rank_idx_max_max+2) undefined ranks. The extra rank allows for simpler insertion by permitting one item of overflow. It must be freed via agnentroprox_free().
+*/
+  agnentroprox_rank_t *list_base;
+  u64 list_bit_count;
+  ULONG list_size;
+  ULONG rank_count;
+  ULONG rank_size;
+
+  list_base=NULL;
+  rank_count=rank_idx_max_max+2;
+  rank_size=(ULONG)(sizeof(agnentroprox_rank_t));
+  if(2<=rank_count){
+    list_size=rank_count*rank_size;
+    if((list_size/rank_size)==rank_count){
+/*
+Ensure that the allocated size in bits can be described in 64 bits.
+*/
+      list_bit_count=(u64)(list_size)<<U8_BITS_LOG2;
+      if((list_bit_count>>U8_BITS_LOG2)==list_size){
+        list_base=DEBUG_MALLOC_PARANOID(list_size);
+      }
+    }
+  }
+  return list_base;
+}
+
+u8
+agnentroprox_rank_list_merge(u8 ascending_status, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, ULONG shard_idx_max, ULONG *shard_rank_count_list_base, agnentroprox_rank_t **shard_rank_list_base_list_base){
+/*
+Merge any number of rank lists ("shards"), all sorted in the same direction, into a single rank list of bounded size. The shards could have been produced by different threads, or imported from other machines via agnentroprox_rank_list_deserialize(). Because agnentroprox_rank_compare() defines a total order, the result is independent of the order of the shards, and identical to the result of inserting all ranks into a single list.
+
+In:
+
+  ascending_status is one if all lists are sorted ascending by entropy mean, else zero if descending.
+
+  *rank_count_base is undefined.
+
+  rank_idx_max_max is (agnentroprox_rank_list_malloc():In:rank_idx_max_max) as it pertains to rank_list_base.
+
+  rank_list_base is the return value of agnentroprox_rank_list_malloc(), and is disjoint from all shards.
+
+  shard_idx_max is the number of shards, less one.
+
+  shard_rank_count_list_base is the base of (shard_idx_max+1) rank counts, one per shard, any of which may be zero.
+
+  shard_rank_list_base_list_base is the base of (shard_idx_max+1) rank list bases, one per shard, each sorted as required by agnentroprox_rank_list_insert().
+
+Out:
+
+  Returns zero on success, else one if memory could not be allocated.
+
+  *rank_count_base is the number of ranks in the merged list, which is at most (rank_idx_max_max+1). Undefined on failure.
+
+  *rank_list_base contains the merged list. Undefined on failure.
+*/
+  ULONG heap_count;
+  ULONG heap_idx0;
+  ULONG heap_idx1;
+  ULONG heap_idx2;
+  ULONG *heap_list_base;
+  agnentroprox_rank_t *rank_base0;
+  agnentroprox_rank_t *rank_base1;
+  agnentroprox_rank_t *rank_base2;
+  ULONG rank_count;
+  ULONG shard_idx;
+  ULONG shard_idx1;
+  ULONG shard_idx2;
+  ULONG shard_rank_idx;
+  ULONG *shard_rank_idx_list_base;
+  u8 status;
+
+  heap_list_base=agnentroprox_ulong_list_malloc(shard_idx_max);
+  shard_rank_idx_list_base=agnentroprox_ulong_list_malloc(shard_idx_max);
+  status=!heap_list_base;
+  status=(u8)(status|!shard_rank_idx_list_base);
+  if(!status){
+/*
+Build a heap of shard indexes keyed by the first rank remaining in each shard, so that the next rank to merge is always at the top.
+*/
+    heap_count=0;
+    shard_idx=0;
+    do{
+      shard_rank_idx_list_base[shard_idx]=0;
+      if(shard_rank_count_list_base[shard_idx]){
+        rank_base0=shard_rank_list_base_list_base[shard_idx];
+        heap_idx0=heap_count;
+        heap_count++;
+        while(heap_idx0){
+          heap_idx1=(heap_idx0-1)>>1;
+          shard_idx1=heap_list_base[heap_idx1];
+          rank_base1=shard_rank_list_base_list_base[shard_idx1];
+          if(!agnentroprox_rank_compare(ascending_status, rank_base0, rank_base1)){
+            break;
+          }
+          heap_list_base[heap_idx0]=shard_idx1;
+          heap_idx0=heap_idx1;
+        }
+        heap_list_base[heap_idx0]=shard_idx;
+      }
+    }while((shard_idx++)!=shard_idx_max);
+    rank_count=0;
+    while(heap_count&&(rank_count<=rank_idx_max_max)){
+      shard_idx=heap_list_base[0];
+      shard_rank_idx=shard_rank_idx_list_base[shard_idx];
+      rank_list_base[rank_count]=shard_rank_list_base_list_base[shard_idx][shard_rank_idx];
+      rank_count++;
+      shard_rank_idx++;
+      shard_rank_idx_list_base[shard_idx]=shard_rank_idx;
+      if(shard_rank_idx==shard_rank_count_list_base[shard_idx]){
+        heap_count--;
+        if(!heap_count){
+          break;
+        }
+        shard_idx=heap_list_base[heap_count];
+      }
+/*
+Sift the updated shard down to its proper place in the heap.
+*/
+      shard_rank_idx=shard_rank_idx_list_base[shard_idx];
+      rank_base0=&shard_rank_list_base_list_base[shard_idx][shard_rank_idx];
+      heap_idx0=0;
+      do{
+        heap_idx1=(heap_idx0<<1)+1;
+        if(heap_count<=heap_idx1){
+          break;
+        }
+        shard_idx1=heap_list_base[heap_idx1];
+        shard_rank_idx=shard_rank_idx_list_base[shard_idx1];
+        rank_base1=&shard_rank_list_base_list_base[shard_idx1][shard_rank_idx];
+        heap_idx2=heap_idx1+1;
+        if(heap_idx2<heap_count){
+          shard_idx2=heap_list_base[heap_idx2];
+          shard_rank_idx=shard_rank_idx_list_base[shard_idx2];
+          rank_base2=&shard_rank_list_base_list_base[shard_idx2][shard_rank_idx];
+          if(agnentroprox_rank_compare(ascending_status, rank_base2, rank_base1)){
+            heap_idx1=heap_idx2;
+            rank_base1=rank_base2;
+            shard_idx1=shard_idx2;
+          }
+        }
+        if(!agnentroprox_rank_compare(ascending_status, rank_base1, rank_base0)){
+          break;
+        }
+        heap_list_base[heap_idx0]=shard_idx1;
+        heap_idx0=heap_idx1;
+      }while(1);
+      heap_list_base[heap_idx0]=shard_idx;
+    }
+    *rank_count_base=rank_count;
+  }
+  agnentroprox_free(shard_rank_idx_list_base);
+  agnentroprox_free(heap_list_base);
+  return status;
+}
+
+ULONG
+agnentroprox_rank_list_serialize(u8 ascending_status, ULONG rank_count, agnentroprox_rank_t *rank_list_base, u64 *serial_u64_list_base){
+/*
+Export a rank list as a flat list of (u64)s suitable for writing to a file or socket, so that it can be merged elsewhere via agnentroprox_rank_list_deserialize() and agnentroprox_rank_list_merge().
+
+The serialized format is: AGNENTROPROX_RANK_LIST_SIGNATURE, rank_count, ascending_status, then for each rank: (entropy.a low u64, entropy.a high u64, entropy.b low u64, entropy.b high u64, file_idx, u8_idx), all in native byte order.
+
+In:
+
+  ascending_status is one if the rank list is sorted ascending by entropy mean, else zero if descending.
+
+  rank_count is the number of ranks in the list, which may be zero.
+
+  rank_list_base is the base of the rank list.
+
+  serial_u64_list_base is NULL to merely compute the serialized size, else the base of at least (Out:return value) bytes to receive the serialized rank list.
+
+Out:
+
+  Returns the size of the serialized rank list in bytes.
+
+  *serial_u64_list_base contains the serialized rank list if serial_u64_list_base was not NULL.
+*/
+  u128 entropy_a;
+  u128 entropy_b;
+  ULONG rank_idx;
+  ULONG serial_size;
+  ULONG serial_u64_idx;
+  u64 u64_hi;
+  u64 u64_lo;
+
+  serial_size=rank_count*AGNENTROPROX_RANK_U64_COUNT;
+  serial_size+=AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT;
+  serial_size<<=U64_SIZE_LOG2;
+  if(serial_u64_list_base){
+    serial_u64_list_base[0]=AGNENTROPROX_RANK_LIST_SIGNATURE;
+    serial_u64_list_base[1]=rank_count;
+    serial_u64_list_base[2]=ascending_status;
+    rank_idx=0;
+    serial_u64_idx=AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT;
+    while(rank_idx<rank_count){
+      entropy_a=rank_list_base[rank_idx].entropy.a;
+      entropy_b=rank_list_base[rank_idx].entropy.b;
+      U128_TO_U64_PAIR(u64_lo, u64_hi, entropy_a);
+      serial_u64_list_base[serial_u64_idx]=u64_lo;
+      serial_u64_list_base[serial_u64_idx+1]=u64_hi;
+      U128_TO_U64_PAIR(u64_lo, u64_hi, entropy_b);
+      serial_u64_list_base[serial_u64_idx+2]=u64_lo;
+      serial_u64_list_base[serial_u64_idx+3]=u64_hi;
+      serial_u64_list_base[serial_u64_idx+4]=rank_list_base[rank_idx].file_idx;
+      serial_u64_list_base[serial_u64_idx+5]=rank_list_base[rank_idx].u8_idx;
+      rank_idx++;
+      serial_u64_idx+=AGNENTROPROX_RANK_U64_COUNT;
+    }
+  }
+  return serial_size;
+}
+
 fru128
 agnentroprox_shannon_entropy_get(agnentroprox_t *agnentroprox_base, u8 freq_list_idx, u8 *overflow_status_base){
 /*
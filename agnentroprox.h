@@ -33,6 +33,7 @@ TYPEDEF_START
   u128 needle_mask_count_recip_half;
   ULONG *freq_list_base0;
   ULONG *freq_list_base1;
+  ULONG *freq_pop_dense_list_base;
   fru64 *log_delta_list_base;
   u64 *log_delta_parameter_list_base;
   fru64 *log_list_base;
@@ -40,9 +41,12 @@ TYPEDEF_START
   fru128 *log_u128_list_base;
   u128 *log_u128_parameter_list_base;
   loggamma_t *loggamma_base;
+  fru128 *loggamma_batch_list_base;
+  u64 *loggamma_batch_parameter_list_base;
   fru128 *loggamma_list_base;
   u64 *loggamma_parameter_list_base;
   poissocache_t *poissocache_base;
+  ULONG freq_pop_dense_idx_max;
   ULONG log_delta_idx_max;
   ULONG log_delta_u128_u64_idx_max;
   ULONG log_idx_max;
@@ -66,8 +70,42 @@ TYPEDEF_START
   u8 variance_shift;
 TYPEDEF_END(agnentroprox_t)
 
+TYPEDEF_START
+  ULONG *child_state_idx_list_base;
+  ULONG *dense_state_idx_list_base;
+  ULONG *fail_state_idx_list_base;
+  ULONG *needle_idx_list_base;
+  ULONG *needle_next_idx_list_base;
+  ULONG *output_state_idx_list_base;
+  ULONG *sibling_state_idx_list_base;
+  ULONG *u8_idx_max_list_base;
+  u8 *u8_list_base;
+  u8 ascending_status;
+  u8 case_insensitive_status;
+  u8 granularity;
+  u8 overlap_status;
+TYPEDEF_END(agnentroprox_multimatch_t)
+
+TYPEDEF_START
+  fru128 *diventropy_list_base;
+  u128 *diventropy_mean_list_base;
+  u128 *diventropy_threshold_list_base;
+  ULONG *freq_list_base;
+  ULONG *mask_count_list_base;
+  ULONG needle_idx_max;
+TYPEDEF_END(agnentroprox_multineedle_t)
+
+TYPEDEF_START
+  fru128 entropy;
+  u64 file_idx;
+  u64 u8_idx;
+TYPEDEF_END(agnentroprox_rank_t)
+
+#define AGNENTROPROX_FREQ_POP_DENSE_IDX_MAX_MAX 0x3FFFFFU
 #define AGNENTROPROX_LOG2_RECIP_HALF_HI 0xB8AA3B295C17F0BBULL
 #define AGNENTROPROX_LOG2_RECIP_HALF_LO 0xBE87FED0691D3E88ULL
+#define AGNENTROPROX_LOGGAMMA_BATCH_IDX_MAX 0xFFU
+#define AGNENTROPROX_MATCH_SKIP_SIZE_MIN 0x20U
 #define AGNENTROPROX_MODE_AGNENTROPY (1U<<AGNENTROPROX_MODE_AGNENTROPY_BIT_IDX)
 #define AGNENTROPROX_MODE_AGNENTROPY_BIT_IDX 0U
 #define AGNENTROPROX_MODE_DIVENTROPY (1U<<AGNENTROPROX_MODE_DIVENTROPY_BIT_IDX)
@@ -92,3 +130,7 @@ TYPEDEF_END(agnentroprox_t)
 #define AGNENTROPROX_MODE_SHANNON_BIT_IDX 6U
 #define AGNENTROPROX_MODE_VARIANCE (1U<<AGNENTROPROX_MODE_VARIANCE_BIT_IDX)
 #define AGNENTROPROX_MODE_VARIANCE_BIT_IDX 7U
+#define AGNENTROPROX_POISSOCACHE_LEVEL_COUNT_EXTRA 2U
+#define AGNENTROPROX_RANK_LIST_HEADER_U64_COUNT 3U
+#define AGNENTROPROX_RANK_LIST_SIGNATURE 0x8E2D1F6A4C3B5A71ULL
+#define AGNENTROPROX_RANK_U64_COUNT 6U
@@ -47,7 +47,20 @@ extern u8 *agnentroprox_mask_list_realloc(u8 granularity, ULONG mask_idx_max, u8
 extern void agnentroprox_mask_list_unaccrue(agnentroprox_t *agnentroprox_base, u8 freq_list_idx, ULONG mask_idx_max, u8 *mask_list_base);
 extern void agnentroprox_mask_max_reset(agnentroprox_t *agnentroprox_base);
 extern void agnentroprox_mask_max_set(agnentroprox_t *agnentroprox_base, u32 mask_max);
+extern u8 agnentroprox_match_check(u8 case_insensitive_status, u8 *haystack_u8_list_base, ULONG needle_u8_idx_max, u8 *needle_u8_list_base);
 extern ULONG agnentroprox_match_find(u8 ascending_status, u8 case_insensitive_status, u8 granularity, ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG match_idx_max_max, ULONG *match_u8_idx_list_base, ULONG needle_mask_idx_max, u8 *needle_mask_list_base, u8 overlap_status);
+extern void agnentroprox_multidiventropy_transform(agnentroprox_t *agnentroprox_base, u8 append_mode, fru128 *diventropy_list_base, ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG *match_count_list_base, ULONG match_idx_max_max, ULONG *match_u8_idx_list_base, agnentroprox_multineedle_t *multineedle_base, u8 *overflow_status_base, ULONG sweep_mask_idx_max);
+extern ULONG agnentroprox_multimatch_find(ULONG haystack_mask_idx_max, u8 *haystack_mask_list_base, ULONG match_idx_max_max, ULONG *match_needle_idx_list_base, ULONG *match_u8_idx_list_base, agnentroprox_multimatch_t *multimatch_base);
+extern agnentroprox_multimatch_t *agnentroprox_multimatch_free_all(agnentroprox_multimatch_t *multimatch_base);
+extern agnentroprox_multimatch_t *agnentroprox_multimatch_init(u8 ascending_status, u8 case_insensitive_status, u8 granularity, ULONG needle_idx_max, ULONG *needle_mask_idx_max_list_base, u8 *needle_mask_list_base, u8 overlap_status);
+extern agnentroprox_multineedle_t *agnentroprox_multineedle_free_all(agnentroprox_multineedle_t *multineedle_base);
+extern agnentroprox_multineedle_t *agnentroprox_multineedle_init(agnentroprox_t *agnentroprox_base, ULONG needle_idx_max, ULONG *needle_mask_idx_max_list_base, u8 *needle_mask_list_base);
+extern u8 agnentroprox_rank_compare(u8 ascending_status, agnentroprox_rank_t *rank_base0, agnentroprox_rank_t *rank_base1);
+extern u8 agnentroprox_rank_list_deserialize(u8 *ascending_status_base, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, ULONG serial_size, u64 *serial_u64_list_base);
+extern u8 agnentroprox_rank_list_insert(u8 ascending_status, fru128 entropy, u64 file_idx, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, u128 *threshold_base, u64 u8_idx);
+extern agnentroprox_rank_t *agnentroprox_rank_list_malloc(ULONG rank_idx_max_max);
+extern u8 agnentroprox_rank_list_merge(u8 ascending_status, ULONG *rank_count_base, ULONG rank_idx_max_max, agnentroprox_rank_t *rank_list_base, ULONG shard_idx_max, ULONG *shard_rank_count_list_base, agnentroprox_rank_t **shard_rank_list_base_list_base);
+extern ULONG agnentroprox_rank_list_serialize(u8 ascending_status, ULONG rank_count, agnentroprox_rank_t *rank_list_base, u64 *serial_u64_list_base);
 extern fru128 agnentroprox_shannon_entropy_get(agnentroprox_t *agnentroprox_base, u8 freq_list_idx, u8 *overflow_status_base);
 extern u128 *agnentroprox_u128_list_malloc(ULONG u128_idx_max);
 extern u32 *agnentroprox_u32_list_malloc(ULONG u32_idx_max);
@@ -28,9 +28,11 @@ Mask Quantization Utility
 #include "flag_filesys.h"
 #include "flag_fracterval_u128.h"
 #include "flag_fracterval_u64.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include "flag_agnentroquant.h"
 #include <stdint.h>
+#include <stdlib.h>
 #include <string.h>
 #include "constant.h"
 #include "debug.h"
@@ -44,7 +46,67 @@ Mask Quantization Utility
 #include "fracterval_u64_xtrn.h"
 #include "maskops.h"
 #include "maskops_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 
+#define AGNENTROQUANT_CHUNK_SIZE_MAX 0x4000000U
+/*
+The kernel macros below are each expanded once per possible mask size by AGNENTROQUANT_MASK_SIZE_SWITCH, so that (_mask_size) is a constant, whereupon the compiler can turn every memcpy() into a direct load or store and vectorize where the width allows. They operate on the locals of the function which expands them.
+*/
+#define AGNENTROQUANT_DELTAFY_CHANNEL_KERNEL(_mask_size) \
+  mask_u64_new=0; \
+  memcpy(&mask_u64_new, &in_u8_list_base[in_u8_idx_max+1-(_mask_size)], (size_t)(_mask_size)); \
+  in_u8_idx=in_u8_idx_max; \
+  if((_mask_size)<=in_u8_idx){ \
+    do{ \
+      in_u8_list_base[in_u8_idx]=(u8)(in_u8_list_base[in_u8_idx]-in_u8_list_base[in_u8_idx-(_mask_size)]); \
+      in_u8_idx--; \
+    }while(in_u8_idx!=((_mask_size)-1)); \
+  } \
+  mask_bit_idx=0; \
+  in_u8_idx=0; \
+  do{ \
+    in_u8_list_base[in_u8_idx]=(u8)(in_u8_list_base[in_u8_idx]-(mask_u64_old>>mask_bit_idx)); \
+    mask_bit_idx=(u8)(mask_bit_idx+U8_BITS); \
+    in_u8_idx++; \
+  }while(in_u8_idx!=(_mask_size))
+#define AGNENTROQUANT_DELTAFY_KERNEL(_mask_size) \
+  in_u8_idx=0; \
+  mask_u64_prev=mask_u64_old; \
+  do{ \
+    mask_u64_new=0; \
+    memcpy(&mask_u64_new, &in_u8_list_base[in_u8_idx], (size_t)(_mask_size)); \
+    mask_u64=mask_u64_new-mask_u64_prev; \
+    mask_u64_prev=mask_u64_new; \
+    memcpy(&in_u8_list_base[in_u8_idx], &mask_u64, (size_t)(_mask_size)); \
+    in_u8_idx+=(_mask_size); \
+  }while(in_u8_idx<=in_u8_idx_max)
+#define AGNENTROQUANT_MASK_SIZE_SWITCH(_kernel, _mask_size) \
+  switch(_mask_size){ \
+  case 1: \
+    _kernel(1); \
+    break; \
+  case 2: \
+    _kernel(2); \
+    break; \
+  case 3: \
+    _kernel(3); \
+    break; \
+  case 4: \
+    _kernel(4); \
+    break; \
+  case 5: \
+    _kernel(5); \
+    break; \
+  case 6: \
+    _kernel(6); \
+    break; \
+  case 7: \
+    _kernel(7); \
+    break; \
+  default: \
+    _kernel(8); \
+  }
 #define AGNENTROQUANT_MODE_CHANNELIZE 1U
 #define AGNENTROQUANT_MODE_CHANNELIZE_BIT_IDX 6U
 #define AGNENTROQUANT_MODE_DELTAS 3U
@@ -55,10 +117,170 @@ Mask Quantization Utility
 #define AGNENTROQUANT_MODE_SATURATE_BIT_IDX 2U
 #define AGNENTROQUANT_MODE_SURROUNDIFY 1U
 #define AGNENTROQUANT_MODE_SURROUNDIFY_BIT_IDX 1U
+#define AGNENTROQUANT_PASS_FOOTPRINT 1U
+#define AGNENTROQUANT_PASS_SPAN 0U
+#define AGNENTROQUANT_PASS_WRITE 2U
+/*
+Each quantize kernel stores (_mask_size) bytes at out_u8_idx. This is safe because out_u8_idx never exceeds in_u8_idx, and the excess bytes are either overwritten by the next output mask or lie beyond the last one.
+*/
+#define AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, _saturate_mode) \
+  do{ \
+    mask_u64=0; \
+    memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(_mask_size)); \
+    in_u8_idx+=(_mask_size); \
+    if((_saturate_mode)==AGNENTROQUANT_SATURATE_NORMALIZE){ \
+      if(mask_span_in){ \
+        mask_u64-=mask_u64_min; \
+        AGNENTROQUANT_RATIO_U64_SELF(mask_u64, mask_span_in, mask_span_in_reciprocal); \
+        mask_u64++; \
+      } \
+      if(mask_span_out_power_of_2_status){ \
+        mask_u64>>=mask_bit_count_delta; \
+      }else{ \
+        U128_FROM_U64_PRODUCT(mask_u128, mask_u64, mask_span_out); \
+        U128_TO_U64_HI(mask_u64, mask_u128); \
+      } \
+    }else if((_saturate_mode)==AGNENTROQUANT_SATURATE_UNSIGNED){ \
+      mask_u64=MIN(mask_u64, mask_u64_saturate_max); \
+    }else if((_saturate_mode)==AGNENTROQUANT_SATURATE_SIGNED){ \
+      mask_u64^=mask_u64_sign; \
+      mask_u64=MIN(mask_u64, mask_u64_saturate_max); \
+      mask_u64=MAX(mask_u64, mask_u64_saturate_min); \
+      mask_u64-=mask_u64_saturate_min; \
+    }else if((_saturate_mode)==AGNENTROQUANT_SATURATE_MODULO_POWER_OF_2){ \
+      mask_u64&=mask_u64_saturate_max; \
+    }else{ \
+      U128_FROM_U64_PRODUCT(mask_u128, mask_u64, mask_span_out_reciprocal); \
+      U128_TO_U64_HI(mask_u64_quotient, mask_u128); \
+      mask_u64-=mask_u64_quotient*mask_span_out; \
+      while(mask_span_out<=mask_u64){ \
+        mask_u64-=mask_span_out; \
+      } \
+    } \
+    mask=(u32)(mask_u64); \
+    mask_max=MAX(mask, mask_max); \
+    mask_min=MIN(mask, mask_min); \
+    memcpy(&in_u8_list_base[out_u8_idx], &mask_u64, (size_t)(_mask_size)); \
+    out_u8_idx+=mask_size_out_channelized; \
+  }while(in_u8_idx<=in_u8_idx_max)
+#define AGNENTROQUANT_QUANTIZE_MODULO_KERNEL(_mask_size) AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, AGNENTROQUANT_SATURATE_MODULO)
+#define AGNENTROQUANT_QUANTIZE_MODULO_POWER_OF_2_KERNEL(_mask_size) AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, AGNENTROQUANT_SATURATE_MODULO_POWER_OF_2)
+#define AGNENTROQUANT_QUANTIZE_NORMALIZE_KERNEL(_mask_size) AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, AGNENTROQUANT_SATURATE_NORMALIZE)
+#define AGNENTROQUANT_QUANTIZE_SIGNED_KERNEL(_mask_size) AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, AGNENTROQUANT_SATURATE_SIGNED)
+#define AGNENTROQUANT_QUANTIZE_UNSIGNED_KERNEL(_mask_size) AGNENTROQUANT_QUANTIZE_KERNEL(_mask_size, AGNENTROQUANT_SATURATE_UNSIGNED)
+/*
+AGNENTROQUANT_RATIO_U64_SELF() is equivalent to FTD64_RATIO_U64_SELF(), given that (_a) is less than (_w), except that it multiplies by the reciprocal (_r), which is (U128_MAX/(_w)), instead of dividing. The quotient estimate so obtained is at most 2 less than the truth, so it's corrected using the exact remainder. On 32-bit platforms, it just falls back to FTD64_RATIO_U64_SELF().
+*/
+#ifdef _64_
+  #define AGNENTROQUANT_RATIO_U64_SELF(_a, _w, _r) \
+    do{ \
+      mask_u64_quotient=(u64)(((u128)(_a)*(_r))>>U64_BITS); \
+      mask_u128=((u128)(_a)<<U64_BITS)-((u128)(mask_u64_quotient)*(_w)); \
+      while((_w)<=mask_u128){ \
+        mask_u64_quotient++; \
+        mask_u128-=(_w); \
+      } \
+      if(!mask_u128){ \
+        mask_u64_quotient-=!!mask_u64_quotient; \
+      } \
+      (_a)=mask_u64_quotient; \
+    }while(0)
+#else
+  #define AGNENTROQUANT_RATIO_U64_SELF(_a, _w, _r) FTD64_RATIO_U64_SELF(_a, _w, overflow_status)
+#endif
 #define AGNENTROQUANT_SATURATE_MODULO 3U
+#define AGNENTROQUANT_SATURATE_MODULO_POWER_OF_2 4U
 #define AGNENTROQUANT_SATURATE_NORMALIZE 0U
 #define AGNENTROQUANT_SATURATE_SIGNED 2U
 #define AGNENTROQUANT_SATURATE_UNSIGNED 1U
+#define AGNENTROQUANT_SPAN_GET_KERNEL(_mask_size) \
+  do{ \
+    mask_u64=0; \
+    memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(_mask_size)); \
+    in_u8_idx+=(_mask_size); \
+    mask_u64_max=MAX(mask_u64, mask_u64_max); \
+    mask_u64_min=MIN(mask_u64, mask_u64_min); \
+  }while(in_u8_idx<=in_u8_idx_max)
+#define AGNENTROQUANT_THREAD_FOOTPRINT_MAX 0x40000000U
+
+TYPEDEF_START
+  ULONG *in_filename_char_idx_list_base;
+  char *in_filename_list_base;
+  u8 *in_u8_list_base;
+  ULONG *maskops_bitmap_base;
+  u32 *maskops_u32_list_base;
+  ULONG *out_filename_char_idx_list_base;
+  char *out_filename_list_base;
+  u8 *status_list_base;
+  ULONG in_chunk_size_max;
+  ULONG in_filename_count;
+  u64 mask_span_out;
+  u32 mask_max;
+  u32 maskops_thread_idx_max;
+  u32 thread_idx;
+  u32 thread_idx_max;
+  u8 channel_status;
+  u8 delta_count;
+  u8 densify_status;
+  u8 granularity;
+  u8 mask_bit_count_delta;
+  u8 mask_size_in;
+  u8 mask_size_in_channelized;
+  u8 mask_size_out_channelized;
+  u8 mask_span_out_power_of_2_status;
+  u8 saturate_mode;
+  u8 surroundify_status;
+TYPEDEF_END(agnentroquant_thread_t)
+
+void
+agnentroquant_deltafy(u8 channel_status, u8 delta_count, ULONG in_u8_idx_max, u8 *in_u8_list_base, u8 mask_size_in, u64 *mask_u64_old_list_base){
+/*
+Deltafy one chunk of a mask list, carrying the previous mask at each delta level over from the previous chunk.
+
+In:
+
+  channel_status is one if masks consist of parallel byte channels, else zero.
+
+  delta_count is the number of deltas to take, on [1, AGNENTROQUANT_MODE_DELTAS].
+
+  in_u8_idx_max is one less than the size of the chunk, which is a multiple of mask_size_in.
+
+  *in_u8_list_base is the chunk.
+
+  mask_size_in is the size of each mask.
+
+  *mask_u64_old_list_base is delta_count (u64)s, each of which is the last mask seen at the corresponding delta level, or zero at the start of the file.
+
+Out:
+
+  *in_u8_list_base has been deltafied delta_count times.
+
+  *mask_u64_old_list_base is updated for the next chunk.
+*/
+  u8 delta_idx;
+  ULONG in_u8_idx;
+  u8 mask_bit_idx;
+  u64 mask_u64;
+  u64 mask_u64_new;
+  u64 mask_u64_old;
+  u64 mask_u64_prev;
+
+/*
+With channelization, each delta level is taken from the end of the chunk backwards, so that every byte is still intact by the time its successor needs it. Otherwise the previous mask is carried forward in a register.
+*/
+  delta_idx=0;
+  do{
+    mask_u64_old=mask_u64_old_list_base[delta_idx];
+    if(!channel_status){
+      AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_DELTAFY_KERNEL, mask_size_in);
+    }else{
+      AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_DELTAFY_CHANNEL_KERNEL, mask_size_in);
+    }
+    mask_u64_old_list_base[delta_idx]=mask_u64_new;
+    delta_idx++;
+  }while(delta_idx!=delta_count);
+  return;
+}
 
 void
 agnentroquant_error_print(char *char_list_base){
@@ -82,82 +304,465 @@ agnentroquant_parameter_error_print(char *char_list_base){
   return;
 }
 
+ULONG
+agnentroquant_quantize(ULONG in_u8_idx_max, u8 *in_u8_list_base, u8 mask_bit_count_delta, u32 mask_max_out, u32 *mask_max_base, u32 *mask_min_base, u8 mask_size_in_channelized, u8 mask_size_out_channelized, u64 mask_span_in, u64 mask_span_out, u8 mask_span_out_power_of_2_status, u64 mask_u64_min, u8 saturate_mode){
+/*
+Saturate one chunk of a mask list and convert it to output masks, in place.
+
+In:
+
+  in_u8_idx_max is one less than the size of the chunk, which is a multiple of mask_size_in_channelized.
+
+  *in_u8_list_base is the chunk.
+
+  mask_bit_count_delta is the number of bits by which to shift normalized masks right when mask_span_out_power_of_2_status is one.
+
+  mask_max_out is the maximum output mask.
+
+  *mask_max_base is the maximum output mask seen so far in the file, or zero at the start of the file.
+
+  *mask_min_base is the minimum output mask seen so far in the file, or U32_MAX at the start of the file.
+
+  mask_size_in_channelized is the size of each input mask, or one if masks are channelized.
+
+  mask_size_out_channelized is the size of each output mask, or one if masks are channelized.
+
+  mask_span_in is the number of possible masks between the minimum and maximum deltafied input masks in the entire file, inclusive, as found by agnentroquant_span_get(). It's zero if that's (U64_MAX+1), and ignored unless saturate_mode is AGNENTROQUANT_SATURATE_NORMALIZE.
+
+  mask_span_out is (mask_max_out+1).
+
+  mask_span_out_power_of_2_status is one if mask_span_out is a power of 2, else zero.
+
+  mask_u64_min is the minimum deltafied input mask in the entire file, and is ignored unless saturate_mode is AGNENTROQUANT_SATURATE_NORMALIZE.
+
+  saturate_mode is the AGNENTROQUANT_SATURATE constant in use.
+
+Out:
+
+  Returns the size of the output masks at in_u8_list_base.
+
+  *in_u8_list_base contains the output masks, followed by undefined bytes.
+
+  *mask_max_base and *mask_min_base have been updated to include the output masks.
+*/
+  ULONG in_u8_idx;
+  u32 mask;
+  u32 mask_max;
+  u32 mask_min;
+  #ifdef _64_
+    u128 mask_span_in_reciprocal;
+  #endif
+  u64 mask_span_out_reciprocal;
+  u128 mask_u128;
+  u64 mask_u64;
+  u64 mask_u64_quotient;
+  u64 mask_u64_saturate_max;
+  u64 mask_u64_saturate_min;
+  u64 mask_u64_sign;
+  ULONG out_u8_idx;
+  #ifndef _64_
+    u8 overflow_status;
+  #endif
+
+  in_u8_idx=0;
+  mask_max=*mask_max_base;
+  mask_min=*mask_min_base;
+/*
+Dividing by a file-wide constant for every mask is slow, so precompute the reciprocals needed by AGNENTROQUANT_RATIO_U64_SELF() and the modulo kernel.
+*/
+  #ifdef _64_
+    mask_span_in_reciprocal=0;
+    if(mask_span_in){
+      mask_span_in_reciprocal=(~mask_span_in_reciprocal)/mask_span_in;
+    }
+  #else
+    overflow_status=0;
+  #endif
+  mask_span_out_reciprocal=U64_MAX/mask_span_out;
+  mask_u64_saturate_max=mask_max_out;
+  mask_u64_saturate_min=0;
+  mask_u64_sign=0;
+  out_u8_idx=0;
+  if((saturate_mode==AGNENTROQUANT_SATURATE_MODULO)&&mask_span_out_power_of_2_status){
+    saturate_mode=AGNENTROQUANT_SATURATE_MODULO_POWER_OF_2;
+  }else if(saturate_mode==AGNENTROQUANT_SATURATE_SIGNED){
+    mask_u64_sign=1ULL<<((mask_size_in_channelized<<U8_BITS_LOG2)-1);
+    mask_u64_saturate_max=mask_u64_sign+(mask_max_out>>1);
+    mask_u64_saturate_min=mask_u64_sign-(mask_max_out>>1)-(mask_max_out&1);
+  }
+  switch(saturate_mode){
+  case AGNENTROQUANT_SATURATE_NORMALIZE:
+    AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_QUANTIZE_NORMALIZE_KERNEL, mask_size_in_channelized);
+    break;
+  case AGNENTROQUANT_SATURATE_UNSIGNED:
+    AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_QUANTIZE_UNSIGNED_KERNEL, mask_size_in_channelized);
+    break;
+  case AGNENTROQUANT_SATURATE_SIGNED:
+    AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_QUANTIZE_SIGNED_KERNEL, mask_size_in_channelized);
+    break;
+  case AGNENTROQUANT_SATURATE_MODULO:
+    AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_QUANTIZE_MODULO_KERNEL, mask_size_in_channelized);
+    break;
+  default:
+    AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_QUANTIZE_MODULO_POWER_OF_2_KERNEL, mask_size_in_channelized);
+  }
+  *mask_max_base=mask_max;
+  *mask_min_base=mask_min;
+  return out_u8_idx;
+}
+
+void
+agnentroquant_span_get(ULONG in_u8_idx_max, u8 *in_u8_list_base, u8 mask_size_in_channelized, u64 *mask_u64_max_base, u64 *mask_u64_min_base){
+/*
+Accumulate the maximum and minimum masks in one chunk of a mask list, for the sake of AGNENTROQUANT_SATURATE_NORMALIZE.
+
+In:
+
+  in_u8_idx_max is one less than the size of the chunk, which is a multiple of mask_size_in_channelized.
+
+  *in_u8_list_base is the chunk.
+
+  mask_size_in_channelized is the size of each input mask, or one if masks are channelized.
+
+  *mask_u64_max_base is the maximum mask seen so far in the file, or zero at the start of the file.
+
+  *mask_u64_min_base is the minimum mask seen so far in the file, or U64_MAX at the start of the file.
+
+Out:
+
+  *mask_u64_max_base and *mask_u64_min_base have been updated to include the masks in the chunk.
+*/
+  ULONG in_u8_idx;
+  u64 mask_u64;
+  u64 mask_u64_max;
+  u64 mask_u64_min;
+
+  in_u8_idx=0;
+  mask_u64_max=*mask_u64_max_base;
+  mask_u64_min=*mask_u64_min_base;
+  AGNENTROQUANT_MASK_SIZE_SWITCH(AGNENTROQUANT_SPAN_GET_KERNEL, mask_size_in_channelized);
+  *mask_u64_max_base=mask_u64_max;
+  *mask_u64_min_base=mask_u64_min;
+  return;
+}
+
+u8
+agnentroquant_stream(ULONG in_filename_list_char_idx, ULONG out_filename_char_idx, agnentroquant_thread_t *thread_base){
+/*
+Quantize one file to one output file, streaming it through in chunks.
+
+In:
+
+  in_filename_list_char_idx is the offset of the input filename at thread_base->in_filename_list_base.
+
+  out_filename_char_idx is the offset of the corresponding output filename at thread_base->out_filename_list_base.
+
+  *thread_base is the agnentroquant_thread_t, including the work buffers, which is private to the calling thread.
+
+Out:
+
+  Returns zero on success, else the FILESYS_STATUS constant describing the failure.
+*/
+  u8 channel_status;
+  u8 *chunk_u8_list_base;
+  u8 delta_count;
+  u32 densify_mask_max;
+  u32 densify_mask_min;
+  u8 densify_status;
+  u8 filesys_status;
+  u8 granularity;
+  u8 granularity_channelized;
+  u8 granularity_surround;
+  ULONG in_chunk_size;
+  ULONG in_chunk_size_max;
+  u64 in_file_size;
+  u64 in_file_u8_idx;
+  ULONG in_filename_char_idx;
+  char *in_filename_list_base;
+  ULONG in_u8_idx_max;
+  u8 *in_u8_list_base;
+  u8 mask_bit_count_delta;
+  ULONG mask_idx_max_channelized;
+  ULONG mask_idx_max_surround;
+  u32 mask_max;
+  u32 mask_max_new;
+  u32 mask_max_quantize;
+  u32 mask_min_new;
+  u32 mask_min_quantize;
+  u8 mask_size_in;
+  u8 mask_size_in_channelized;
+  u8 mask_size_out_channelized;
+  u8 mask_size_surround;
+  u64 mask_span_in;
+  u64 mask_span_out;
+  u8 mask_span_out_power_of_2_status;
+  u64 mask_u64_max;
+  u64 mask_u64_min;
+  u64 mask_u64_old_list_base[AGNENTROQUANT_MODE_DELTAS];
+  u64 mask_u64_surround;
+  ULONG *maskops_bitmap_base;
+  u32 maskops_thread_idx_max;
+  u32 *maskops_u32_list_base;
+  char *out_filename_list_base;
+  ULONG out_u8_idx;
+  u8 pass;
+  u8 quantized_status;
+  u8 read_status;
+  u8 resident_status;
+  u8 saturate_mode;
+  u8 *surround_u8_list_base;
+  u8 surroundify_status;
+
+  channel_status=thread_base->channel_status;
+  delta_count=thread_base->delta_count;
+  densify_status=thread_base->densify_status;
+  granularity=thread_base->granularity;
+  in_chunk_size_max=thread_base->in_chunk_size_max;
+  in_filename_list_base=thread_base->in_filename_list_base;
+  in_u8_list_base=thread_base->in_u8_list_base;
+  mask_bit_count_delta=thread_base->mask_bit_count_delta;
+  mask_max=thread_base->mask_max;
+  mask_size_in=thread_base->mask_size_in;
+  mask_size_in_channelized=thread_base->mask_size_in_channelized;
+  mask_size_out_channelized=thread_base->mask_size_out_channelized;
+  mask_span_out=thread_base->mask_span_out;
+  mask_span_out_power_of_2_status=thread_base->mask_span_out_power_of_2_status;
+  maskops_bitmap_base=thread_base->maskops_bitmap_base;
+  maskops_thread_idx_max=thread_base->maskops_thread_idx_max;
+  maskops_u32_list_base=thread_base->maskops_u32_list_base;
+  out_filename_list_base=thread_base->out_filename_list_base;
+  saturate_mode=thread_base->saturate_mode;
+  surroundify_status=thread_base->surroundify_status;
+  chunk_u8_list_base=&in_u8_list_base[U64_SIZE];
+  densify_mask_max=mask_max;
+  densify_mask_min=0;
+  granularity_channelized=(u8)(mask_size_out_channelized-1);
+  granularity_surround=granularity_channelized;
+  if(channel_status){
+    granularity_surround=granularity;
+  }
+  mask_size_surround=(u8)(granularity_surround+1);
+  mask_u64_surround=0;
+  out_u8_idx=0;
+  quantized_status=0;
+  filesys_status=filesys_file_size_get(&in_file_size, &in_filename_list_base[in_filename_list_char_idx]);
+  if((!filesys_status)&&((!in_file_size)||(in_file_size%mask_size_in))){
+    filesys_status=FILESYS_STATUS_CALLER_CUSTOM;
+  }
+  if(!filesys_status){
+/*
+Stream the file through as many as 3 passes of at most in_chunk_size_max bytes at a time: (1) find the span of deltafied masks for normalization, (2) find the span and footprint of output masks for densification and surroundification, and (3) transform and write the output masks. Only the last is always required. If the file fits in a single chunk, then it's only read once.
+*/
+    pass=AGNENTROQUANT_PASS_WRITE;
+    if(densify_status|surroundify_status){
+      pass=AGNENTROQUANT_PASS_FOOTPRINT;
+    }
+    if(saturate_mode==AGNENTROQUANT_SATURATE_NORMALIZE){
+      pass=AGNENTROQUANT_PASS_SPAN;
+    }
+    mask_max_new=0;
+    mask_max_quantize=0;
+    mask_min_new=0;
+    mask_min_quantize=~mask_max_quantize;
+    mask_span_in=0;
+    mask_u64_max=0;
+    mask_u64_min=~mask_u64_max;
+    read_status=1;
+    resident_status=(in_file_size<=in_chunk_size_max);
+    do{
+      in_file_u8_idx=0;
+      mask_u64_old_list_base[0]=0;
+      mask_u64_old_list_base[1]=0;
+      mask_u64_old_list_base[2]=0;
+      do{
+        in_chunk_size=in_chunk_size_max;
+        if((in_file_size-in_file_u8_idx)<in_chunk_size){
+          in_chunk_size=(ULONG)(in_file_size-in_file_u8_idx);
+        }
+        in_u8_idx_max=in_chunk_size-1;
+        if(read_status){
+          in_filename_char_idx=in_filename_list_char_idx;
+          filesys_status=filesys_subfile_read_next(0, &in_filename_char_idx, in_filename_list_base, in_chunk_size, in_file_u8_idx, chunk_u8_list_base);
+          if(filesys_status){
+            break;
+          }
+          if(delta_count){
+            agnentroquant_deltafy(channel_status, delta_count, in_u8_idx_max, chunk_u8_list_base, mask_size_in, mask_u64_old_list_base);
+          }
+          quantized_status=0;
+        }
+        if(pass==AGNENTROQUANT_PASS_SPAN){
+          agnentroquant_span_get(in_u8_idx_max, chunk_u8_list_base, mask_size_in_channelized, &mask_u64_max, &mask_u64_min);
+        }else{
+          if(!quantized_status){
+            out_u8_idx=agnentroquant_quantize(in_u8_idx_max, chunk_u8_list_base, mask_bit_count_delta, mask_max, &mask_max_quantize, &mask_min_quantize, mask_size_in_channelized, mask_size_out_channelized, mask_span_in, mask_span_out, mask_span_out_power_of_2_status, mask_u64_min, saturate_mode);
+            quantized_status=1;
+          }
+          mask_idx_max_channelized=(out_u8_idx/mask_size_out_channelized)-1;
+          if(pass==AGNENTROQUANT_PASS_FOOTPRINT){
+            if(densify_status){
+/*
+The output mask span of a file which spans multiple chunks isn't known until all of them have been seen, so mark the footprint over all possible output masks in that case.
+*/
+              if(resident_status){
+                densify_mask_max=mask_max_quantize;
+                densify_mask_min=mask_min_quantize;
+              }
+              maskops_densify_bitmap_prepare_parallel(maskops_bitmap_base, granularity_channelized, mask_idx_max_channelized, chunk_u8_list_base, densify_mask_max, densify_mask_min, !in_file_u8_idx, maskops_thread_idx_max);
+            }
+          }else{
+            if(densify_status){
+              maskops_densify_parallel(1, granularity_channelized, mask_idx_max_channelized, chunk_u8_list_base, densify_mask_min, maskops_u32_list_base, maskops_thread_idx_max);
+            }
+            if(surroundify_status){
+/*
+Prepend the last mask of the previous chunk, as it was prior to surroundification, so that the first mask of this one is surrounded relative to it. The result at the prepended mask is discarded.
+*/
+              mask_idx_max_surround=(out_u8_idx/mask_size_surround)-1;
+              surround_u8_list_base=chunk_u8_list_base;
+              if(in_file_u8_idx){
+                surround_u8_list_base=&in_u8_list_base[U64_SIZE-mask_size_surround];
+                memcpy(surround_u8_list_base, &mask_u64_surround, (size_t)(mask_size_surround));
+                mask_idx_max_surround++;
+              }
+              memcpy(&mask_u64_surround, &chunk_u8_list_base[out_u8_idx-mask_size_surround], (size_t)(mask_size_surround));
+              maskops_surroundify(channel_status, 1, granularity_surround, mask_idx_max_surround, surround_u8_list_base, mask_max_new, mask_min_new);
+            }
+            if(!in_file_u8_idx){
+              filesys_status=filesys_file_write_obnoxious(out_u8_idx, &out_filename_list_base[out_filename_char_idx], chunk_u8_list_base);
+            }else{
+              filesys_status=filesys_file_append(out_u8_idx, &out_filename_list_base[out_filename_char_idx], chunk_u8_list_base);
+            }
+            if(filesys_status){
+              break;
+            }
+          }
+        }
+        in_file_u8_idx+=in_chunk_size;
+      }while(in_file_u8_idx!=in_file_size);
+      if(filesys_status){
+        break;
+      }
+      if(pass==AGNENTROQUANT_PASS_SPAN){
+        mask_span_in=mask_u64_max-mask_u64_min+1;
+        if(!(densify_status|surroundify_status)){
+          pass=AGNENTROQUANT_PASS_FOOTPRINT;
+        }
+      }else if(pass==AGNENTROQUANT_PASS_FOOTPRINT){
+        mask_max_new=mask_max_quantize;
+        mask_min_new=mask_min_quantize;
+        if(densify_status){
+          mask_max_new=maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 1, mask_max_new, densify_mask_min, maskops_u32_list_base, maskops_thread_idx_max);
+          mask_min_new=0;
+        }
+      }
+      read_status=!resident_status;
+      pass++;
+    }while(pass<=AGNENTROQUANT_PASS_WRITE);
+  }
+  return filesys_status;
+}
+
+void *
+agnentroquant_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for main().
+
+Quantize every (thread_idx_max+1)th file, starting with file number thread_idx, so that the threads collectively cover the entire file list.
+
+In:
+
+  *thread_base is an agnentroquant_thread_t. Filenames are located through in_filename_char_idx_list_base and out_filename_char_idx_list_base because FileSys temporarily modifies the filenames belonging to other threads while writing them.
+
+Out:
+
+  Returns NULL.
+
+  thread_base->status_list_base[N] is the return value of agnentroquant_stream() for each file number N covered by this thread.
+*/
+  ULONG *in_filename_char_idx_list_base;
+  ULONG in_file_idx;
+  ULONG in_filename_count;
+  ULONG *out_filename_char_idx_list_base;
+  u8 *status_list_base;
+  agnentroquant_thread_t *thread_base_u;
+  u32 thread_count;
+
+  thread_base_u=(agnentroquant_thread_t *)(thread_base);
+  in_filename_char_idx_list_base=thread_base_u->in_filename_char_idx_list_base;
+  in_filename_count=thread_base_u->in_filename_count;
+  out_filename_char_idx_list_base=thread_base_u->out_filename_char_idx_list_base;
+  status_list_base=thread_base_u->status_list_base;
+  in_file_idx=thread_base_u->thread_idx;
+  thread_count=thread_base_u->thread_idx_max+1;
+  do{
+    status_list_base[in_file_idx]=agnentroquant_stream(in_filename_char_idx_list_base[in_file_idx], out_filename_char_idx_list_base[in_file_idx], thread_base_u);
+    in_file_idx+=thread_count;
+  }while(in_file_idx<in_filename_count);
+  return NULL;
+}
+
 int
 main(int argc, char *argv[]){
   ULONG arg_idx;
   u8 channel_status;
   u8 delta_count;
-  u8 delta_idx;
   u8 densify_status;
-  u8 fatal_status;
   u8 file_status;
   u8 filesys_status;
   u8 granularity;
-  u8 granularity_channelized;
+  ULONG in_chunk_size_max;
   ULONG in_file_idx;
-  ULONG in_file_size;
   ULONG in_file_size_max;
+  u8 *in_file_status_list_base;
   char *in_filename_base;
+  ULONG *in_filename_char_idx_list_base;
   ULONG in_filename_count;
   char *in_filename_list_base;
   ULONG in_filename_list_char_idx;
-  ULONG in_filename_list_char_idx_max;
-  ULONG in_filename_list_char_idx_new;
   ULONG in_filename_list_size;
-  ULONG in_filename_list_size_new;
-  ULONG in_u8_idx;
-  ULONG in_u8_idx_max;
   u8 *in_u8_list_base;
-  u32 mask;
   u8 mask_bit_count_delta;
   u8 mask_bit_count_in;
   u8 mask_bit_count_out;
-  u8 mask_bit_idx;
-  ULONG mask_idx_max_channelized;
   u32 mask_max;
-  u32 mask_max_new;
-  u32 mask_min_new;
   u8 mask_size_in;
   u8 mask_size_in_channelized;
   u8 mask_size_out;
   u8 mask_size_out_channelized;
-  u64 mask_span_in;
   u64 mask_span_out;
-  u8 mask_span_out_u8;
   u8 mask_span_out_power_of_2_status;
-  u64 mask_u64;
-  u64 mask_u64_max;
-  u64 mask_u64_min;
-  u64 mask_u64_new;
-  u64 mask_u64_old;
-  u64 mask_u64_sign;
-  u8 mask_u8;
-  u8 mask_u8_idx;
-  u128 mask_u128;
   ULONG *maskops_bitmap_base;
   u32 *maskops_u32_list_base;
   char *out_filename_base;
   ULONG out_filename_char_idx;
+  ULONG *out_filename_char_idx_list_base;
   ULONG out_filename_char_idx_max;
-  ULONG out_filename_char_idx_new;
   char *out_filename_list_base;
   ULONG out_filename_list_size;
-  ULONG out_u8_idx;
-  u8 overflow_status;
   u64 parameter;
-  u8 retry_status;
   u8 saturate_mode;
   u8 status;
   u8 surroundify_status;
+  u64 thread_footprint;
+  u32 thread_idx;
+  u32 thread_idx_max;
+  u32 thread_idx_max_file;
+  agnentroquant_thread_t thread_list_base[THREAD_COUNT_MAX];
 
-  overflow_status=0;
   status=ascii_init(ASCII_BUILD_BREAK_COUNT_EXPECTED, 0);
-  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 4));
+  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 7));
+  status=(u8)(status|thread_init(THREAD_BUILD_BREAK_COUNT_EXPECTED, 0));
+  thread_idx_max=thread_count_get()-1;
+  in_file_status_list_base=NULL;
+  in_filename_char_idx_list_base=NULL;
   in_filename_list_base=NULL;
   in_u8_list_base=NULL;
   maskops_bitmap_base=NULL;
   maskops_u32_list_base=NULL;
+  out_filename_char_idx_list_base=NULL;
   out_filename_list_base=NULL;
+  thread_idx_max_file=0;
   do{
     if(status){
       agnentroquant_error_print("Outdated source code");
@@ -173,7 +778,7 @@ main(int argc, char *argv[]){
       DEBUG_PRINT("(mode) controls behavior.\n\n  Agnentro Quant converts up-to-64-bit (un)signed integers into a stream of\n  whole numbers optimized for analysis by Agnentro. Its pipeline operates as\n  follows, where each stage can be enabled or disabled at your option. Note\n  that some parts of the pipeline can also be done at runtime by Agnentro\n  Find or Agnentro Scan, which could be more or less efficient, depending on\n  the situation.\n\n    Deltafy -> Saturate -> Densify -> Surroundify\n\n  where all of the stages above are documented in the papers available at the\n  webpage above.\n\n  bit 0: (densify) Set to enable densification (mask utilization footprint\n  minimization).\n\n  bit 1: (surroundify) After densification, subtract the minimum mask from all\n  masks, so as to make the new minimum 0. Then convert all masks to their\n  surround codes relative to their new maximum. Note that surroundification is\n  a sparser way of taking the first derivative, so it may be more effective\n  than setting (deltas) to a nonzero value.\n\n  bit 2-3: (saturate) controls how masks are to be clipped:\n\n    00: Normalization: Scales the actual range of minimum to maximum input mask\n    to [0, mask_max], rounding down to the nearest output mask.\n\n    01: Positive saturation: All input masks greater than mask_max will be set\n    to mask_max.\n\n    10: Signed saturation: First compute (N=ceiling(mask_max/2)). Add N to\n    every signed mask. If the result with infinite precision is negative,\n    replace it with 0; else if it exceeds mask_max, replace it with mask_max.\n\n    11: Modulo saturation: Replace the mask (or its delta) with itself modulo\n    (mask_max+1).\n\n  bit 4-5: (deltas) The number of times to compute the delta (discrete\n  derivative) of the mask list prior to considering (overlap). Each delta, if\n  any, will transform {A, B, C...} to  {A, (B-A), (C-B)...}. This is useful\n  for improving the entropy contrast of signals containing masks which\n  represent magnitudes, as opposed to merely symbols. Experiment to find the\n  optimum value for your data set.\n\n  bit 6: (channelize) Set if masks consist of parallel byte channels, for\n  example the red, green, and blue bytes of 24-bit pixels. This will cause\n  deltafication and surroundification, if enabled, to occur on parallel bytes.\n  In any event, densification, if enabled, will be executed on a serial byte\n  list, as though (granularity) were 0.\n\n");
       DEBUG_PRINT("(granularity) is one less than the number of bytes per input mask, on [0, 7].\n\n");
       DEBUG_PRINT("(mask_max) is a nonzero hex value up to 32 bits wide which is the maximum\nmask that this program will output. All output masks will have the minimum\npossible granularity required to store this value.\n\n");
-      DEBUG_PRINT("(input) is the file or folder from which to read multiples of (granularity+1)\nbytes.\n\n");
+      DEBUG_PRINT("(input) is the file or folder from which to read multiples of (granularity+1)\nbytes. Files need not fit in memory, as they're processed in chunks.\n\n");
       DEBUG_PRINT("(output) is the folder, corresponding to but different from (input), to which\nto write the corresponding output masks in files of identical names.\n\n");
       break;
     }
@@ -267,33 +872,18 @@ main(int argc, char *argv[]){
     }
     in_filename_base=argv[4];
     out_filename_base=argv[5];
-    fatal_status=0;
     in_file_size_max=0;
     in_filename_count=0;
     in_filename_list_size=U16_MAX;
     mask_bit_count_delta=(u8)(mask_bit_count_delta-mask_bit_count_out);
-    mask_span_in=0;
-    retry_status=0;
-    do{
-      in_filename_list_char_idx_max=in_filename_list_size-1;
-      in_filename_list_base=filesys_char_list_malloc(in_filename_list_char_idx_max);
-      if(!in_filename_list_base){
-        fatal_status=1;
-        agnentroquant_out_of_memory_print();
-        break;
-      }
-      in_filename_list_size_new=in_filename_list_size;
-      retry_status=filesys_filename_list_get(&fatal_status, &in_file_size_max, &file_status, &in_filename_count, in_filename_list_base, &in_filename_list_size_new, in_filename_base);
-      if(fatal_status){
-        agnentroquant_error_print("(input) not found or inaccessible");
-        break;
-      }
-      if(retry_status){
-        in_filename_list_base=filesys_free(in_filename_list_base);
-        in_filename_list_size=in_filename_list_size_new;
-      }
-    }while(retry_status);
-    if(fatal_status){
+    in_filename_list_base=filesys_char_list_malloc(in_filename_list_size);
+    if(!in_filename_list_base){
+      agnentroquant_out_of_memory_print();
+      break;
+    }
+    status=filesys_filename_list_get(&in_file_size_max, &file_status, &in_filename_count, &in_filename_list_base, &in_filename_list_size, in_filename_base);
+    if(status){
+      agnentroquant_error_print("(input) not found or inaccessible");
       break;
     }
     status=filesys_filename_list_sort(in_filename_count, in_filename_list_base);
@@ -302,8 +892,21 @@ main(int argc, char *argv[]){
       break;
     }
     status=1;
-    in_u8_list_base=maskops_mask_list_malloc(U8_BYTE_MAX, in_file_size_max);
+    in_chunk_size_max=(AGNENTROQUANT_CHUNK_SIZE_MAX/mask_size_in)*mask_size_in;
+    if(in_file_size_max<in_chunk_size_max){
+      in_chunk_size_max=in_file_size_max;
+    }
+/*
+Leave room for one mask ahead of each chunk so that surroundification can carry over from the previous chunk.
+*/
+    in_u8_list_base=maskops_mask_list_malloc(U8_BYTE_MAX, in_chunk_size_max+U64_SIZE);
     status=!in_u8_list_base;
+    in_file_status_list_base=(u8 *)(DEBUG_MALLOC_PARANOID(in_filename_count));
+    status=(u8)(status|!in_file_status_list_base);
+    in_filename_char_idx_list_base=(ULONG *)(DEBUG_MALLOC_PARANOID(in_filename_count*(ULONG)(sizeof(ULONG))));
+    status=(u8)(status|!in_filename_char_idx_list_base);
+    out_filename_char_idx_list_base=(ULONG *)(DEBUG_MALLOC_PARANOID(in_filename_count*(ULONG)(sizeof(ULONG))));
+    status=(u8)(status|!out_filename_char_idx_list_base);
     out_filename_list_size=filesys_filename_list_morph_size_get(in_filename_count, in_filename_base, in_filename_list_base, out_filename_base);
     out_filename_char_idx_max=out_filename_list_size-1;
     out_filename_list_base=filesys_char_list_malloc(out_filename_char_idx_max);
@@ -315,177 +918,95 @@ main(int argc, char *argv[]){
     filesys_filename_list_morph(in_filename_count, in_filename_base, in_filename_list_base, out_filename_base, out_filename_list_base);
     in_file_idx=0;
     in_filename_list_char_idx=0;
-    mask_u64_max=0;
-    mask_u64_min=0;
     out_filename_char_idx=0;
     do{
-      in_file_size=in_file_size_max;
-      in_filename_list_char_idx_new=in_filename_list_char_idx;
-      filesys_status=filesys_file_read_next(&in_file_size, &in_filename_list_char_idx_new, in_filename_list_base, in_u8_list_base);
-      if((!in_file_size)||(in_file_size%mask_size_in)){
-        filesys_status=FILESYS_STATUS_CALLER_CUSTOM;
+      in_filename_char_idx_list_base[in_file_idx]=in_filename_list_char_idx;
+      out_filename_char_idx_list_base[in_file_idx]=out_filename_char_idx;
+      in_filename_list_char_idx+=(ULONG)(strlen(&in_filename_list_base[in_filename_list_char_idx]))+1;
+      out_filename_char_idx+=(ULONG)(strlen(&out_filename_list_base[out_filename_char_idx]))+1;
+      in_file_idx++;
+    }while(in_file_idx!=in_filename_count);
+/*
+Quantize files in parallel, each one entirely on a single thread, so that output doesn't depend on the thread count. Limit the number of threads so that their work buffers don't exceed AGNENTROQUANT_THREAD_FOOTPRINT_MAX in total, as far as possible. Only if there's just one thread should it spawn more threads within each file.
+*/
+    thread_footprint=in_chunk_size_max+U64_SIZE;
+    if(densify_status){
+      thread_footprint+=(((u64)(mask_max)>>U8_BITS_LOG2)+U64_SIZE)+(((u64)(mask_max)+1)<<U32_SIZE_LOG2);
+    }
+    thread_idx_max_file=(u32)(MIN((ULONG)(thread_idx_max), in_filename_count-1));
+    if((AGNENTROQUANT_THREAD_FOOTPRINT_MAX/thread_footprint)<=thread_idx_max_file){
+      thread_idx_max_file=(u32)(AGNENTROQUANT_THREAD_FOOTPRINT_MAX/thread_footprint);
+      if(thread_idx_max_file){
+        thread_idx_max_file--;
       }
-      status=!!filesys_status;
-      if(!status){
-        in_u8_idx_max=(ULONG)(in_file_size-1);
-        if(delta_count){
-          delta_idx=0;
-          do{
-            in_u8_idx=0;
-            mask_u64_old=0;
-            if(!channel_status){
-              do{
-                mask_u64=0;
-                memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in));
-                mask_u64_new=mask_u64-mask_u64_old;
-                mask_u64_old=mask_u64;
-                memcpy(&in_u8_list_base[in_u8_idx], &mask_u64_new, (size_t)(mask_size_in));
-                in_u8_idx+=mask_size_in;
-              }while(in_u8_idx<=in_u8_idx_max);
-            }else{
-              do{
-                mask_u64=0;
-                memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in));
-                mask_bit_idx=0;
-                mask_u64_new=0;
-                mask_u8_idx=0;
-                do{
-                  mask_u8=(u8)(mask_u64>>mask_bit_idx);
-                  mask_u8=(u8)(mask_u8-(mask_u64_old>>mask_bit_idx));
-                  mask_u64_new|=(u64)(mask_u8)<<mask_bit_idx;
-                  mask_bit_idx=(u8)(mask_bit_idx+U8_BITS);
-                  mask_u8_idx++;
-                }while(mask_u8_idx!=mask_size_in);
-                mask_u64_old=mask_u64;
-                memcpy(&in_u8_list_base[in_u8_idx], &mask_u64_new, (size_t)(mask_size_in));
-                in_u8_idx+=mask_size_in;
-              }while(in_u8_idx<=in_u8_idx_max);
-            }
-            delta_idx++;
-          }while(delta_idx!=delta_count);
-        }
-        in_u8_idx=0;
-        switch(saturate_mode){
-        case AGNENTROQUANT_SATURATE_NORMALIZE:
-          in_u8_idx=0;
-          mask_u64_max=0;
-          mask_u64_min=~mask_u64_max;
-          do{
-            mask_u64=0;
-            memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-            in_u8_idx+=mask_size_in_channelized;
-            mask_u64_max=MAX(mask_u64, mask_u64_max);
-            mask_u64_min=MIN(mask_u64, mask_u64_min);
-          }while(in_u8_idx<=in_u8_idx_max);
-          mask_span_in=mask_u64_max-mask_u64_min+1;
-          break;
-        case AGNENTROQUANT_SATURATE_UNSIGNED:
-          mask_u64_max=mask_max;
-          do{
-            mask_u64=0;
-            memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-            if(mask_u64_max<mask_u64){
-              memcpy(&in_u8_list_base[in_u8_idx], &mask_u64_max, (size_t)(mask_size_in_channelized));
-            }
-            in_u8_idx+=mask_size_in_channelized;
-          }while(in_u8_idx<=in_u8_idx_max);
-          break;
-        case AGNENTROQUANT_SATURATE_SIGNED:
-          mask_u64_sign=1ULL<<((mask_size_in_channelized<<U8_BITS_LOG2)-1);
-          mask_u64_max=mask_u64_sign+(mask_max>>1);
-          mask_u64_min=mask_u64_sign-(mask_max>>1)-(mask_max&1);
-          in_u8_idx=0;
-          do{
-            mask_u64=0;
-            memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-            mask_u64^=mask_u64_sign;
-            mask_u64=MIN(mask_u64, mask_u64_max);
-            mask_u64=MAX(mask_u64, mask_u64_min);
-            mask_u64-=mask_u64_min;
-            memcpy(&in_u8_list_base[in_u8_idx], &mask_u64, (size_t)(mask_size_in_channelized));
-            in_u8_idx+=mask_size_in_channelized;
-          }while(in_u8_idx<=in_u8_idx_max);
-          break;
-        case AGNENTROQUANT_SATURATE_MODULO:
-          if(mask_span_out_power_of_2_status){
-            do{
-              mask_u64=0;
-              memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-              mask_u64&=mask_max;
-              memcpy(&in_u8_list_base[in_u8_idx], &mask_u64, (size_t)(mask_size_in_channelized));
-              in_u8_idx+=mask_size_in_channelized;
-            }while(in_u8_idx<=in_u8_idx_max);
-          }else if(mask_span_out==(u8)(mask_span_out)){
-            mask_span_out_u8=(u8)(mask_span_out);
-            do{
-              mask_u64=0;
-              memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-              mask_u64%=mask_span_out_u8;
-              memcpy(&in_u8_list_base[in_u8_idx], &mask_u64, (size_t)(mask_size_in_channelized));
-              in_u8_idx+=mask_size_in_channelized;
-            }while(in_u8_idx<=in_u8_idx_max);
-          }else{
-            do{
-              mask_u64=0;
-              memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-              mask_u64%=mask_span_out;
-              memcpy(&in_u8_list_base[in_u8_idx], &mask_u64, (size_t)(mask_size_in_channelized));
-              in_u8_idx+=mask_size_in_channelized;
-            }while(in_u8_idx<=in_u8_idx_max);
-          }
-          break;
-        }
-        in_u8_idx=0;
-        mask_max_new=0;
-        mask_min_new=~mask_max_new;
-        out_u8_idx=0;
-        do{
-          mask_u64=0;
-          memcpy(&mask_u64, &in_u8_list_base[in_u8_idx], (size_t)(mask_size_in_channelized));
-          in_u8_idx+=mask_size_in_channelized;
-          if(saturate_mode==AGNENTROQUANT_SATURATE_NORMALIZE){
-            if(mask_span_in){
-              mask_u64-=mask_u64_min;
-              FTD64_RATIO_U64_SELF(mask_u64, mask_span_in, overflow_status);
+    }
+    thread_list_base[0].in_filename_char_idx_list_base=in_filename_char_idx_list_base;
+    thread_list_base[0].in_filename_list_base=in_filename_list_base;
+    thread_list_base[0].in_u8_list_base=in_u8_list_base;
+    thread_list_base[0].maskops_bitmap_base=maskops_bitmap_base;
+    thread_list_base[0].maskops_u32_list_base=maskops_u32_list_base;
+    thread_list_base[0].out_filename_char_idx_list_base=out_filename_char_idx_list_base;
+    thread_list_base[0].out_filename_list_base=out_filename_list_base;
+    thread_list_base[0].status_list_base=in_file_status_list_base;
+    thread_list_base[0].in_chunk_size_max=in_chunk_size_max;
+    thread_list_base[0].in_filename_count=in_filename_count;
+    thread_list_base[0].mask_span_out=mask_span_out;
+    thread_list_base[0].mask_max=mask_max;
+    thread_list_base[0].thread_idx=0;
+    thread_list_base[0].channel_status=channel_status;
+    thread_list_base[0].delta_count=delta_count;
+    thread_list_base[0].densify_status=densify_status;
+    thread_list_base[0].granularity=granularity;
+    thread_list_base[0].mask_bit_count_delta=mask_bit_count_delta;
+    thread_list_base[0].mask_size_in=mask_size_in;
+    thread_list_base[0].mask_size_in_channelized=mask_size_in_channelized;
+    thread_list_base[0].mask_size_out_channelized=mask_size_out_channelized;
+    thread_list_base[0].mask_span_out_power_of_2_status=mask_span_out_power_of_2_status;
+    thread_list_base[0].saturate_mode=saturate_mode;
+    thread_list_base[0].surroundify_status=surroundify_status;
 /*
-There's one ambiguous case, namely where the fraction bits of mask_u64 are all ones. Rounding up may be wrong, as the uncertainty is 1ULP. However, if we don't round up, then we'll never actually utilize the full range. So just do it. Wrap is impossible because mask_u64 was less than mask_span_in prior to taking the ratio.
+Allocate private work buffers for each additional thread. If that fails, then just run fewer threads.
 */
-              mask_u64++;
-            }
-            if(mask_span_out_power_of_2_status){
-              mask_u64>>=mask_bit_count_delta;
-            }else{
-              U128_FROM_U64_PRODUCT(mask_u128, mask_u64, mask_span_out);
-              U128_TO_U64_HI(mask_u64, mask_u128);
-            }
-          }
-          mask=(u32)(mask_u64);
-          mask_max_new=MAX(mask, mask_max_new);
-          mask_min_new=MIN(mask, mask_min_new);
-          memcpy(&in_u8_list_base[out_u8_idx], &mask, (size_t)(mask_size_out_channelized));
-          out_u8_idx+=mask_size_out_channelized;
-        }while(in_u8_idx<=in_u8_idx_max);
-        mask_idx_max_channelized=(out_u8_idx/mask_size_out)-1;
+    if(thread_idx_max_file){
+      thread_idx=1;
+      do{
+        thread_list_base[thread_idx]=thread_list_base[0];
+        thread_list_base[thread_idx].thread_idx=thread_idx;
+        thread_list_base[thread_idx].in_u8_list_base=maskops_mask_list_malloc(U8_BYTE_MAX, in_chunk_size_max+U64_SIZE);
+        status=!thread_list_base[thread_idx].in_u8_list_base;
         if(densify_status){
-          if(channel_status){
-            mask_idx_max_channelized=out_u8_idx-1;
-          }
-          granularity_channelized=(u8)(mask_size_out_channelized-1);
-          maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity_channelized, mask_idx_max_channelized, in_u8_list_base, mask_max_new, mask_min_new, 1);
-          mask_max_new=maskops_densify_remask_prepare(maskops_bitmap_base, 1, mask_max_new, mask_min_new, maskops_u32_list_base);
-          maskops_densify(1, granularity_channelized, mask_idx_max_channelized, in_u8_list_base, mask_min_new, maskops_u32_list_base);
-          mask_min_new=0;
+          thread_list_base[thread_idx].maskops_bitmap_base=maskops_bitmap_malloc((u64)(mask_max));
+          status=(u8)(status|!thread_list_base[thread_idx].maskops_bitmap_base);
+          thread_list_base[thread_idx].maskops_u32_list_base=maskops_u32_list_malloc((ULONG)(mask_max));
+          status=(u8)(status|!thread_list_base[thread_idx].maskops_u32_list_base);
         }
-        if(surroundify_status){
-          if(channel_status){
-            mask_idx_max_channelized=(out_u8_idx/(u8)(granularity+1))-1;            
-          }
-          maskops_surroundify(channel_status, 1, granularity, mask_idx_max_channelized, in_u8_list_base, mask_max_new, mask_min_new);
+        if(status){
+          maskops_free(thread_list_base[thread_idx].maskops_u32_list_base);
+          maskops_free(thread_list_base[thread_idx].maskops_bitmap_base);
+          maskops_free(thread_list_base[thread_idx].in_u8_list_base);
+          thread_idx_max_file=thread_idx-1;
+          break;
         }
-        out_filename_char_idx_new=out_filename_char_idx;
-        filesys_status=filesys_file_write_next_obnoxious(out_u8_idx, &out_filename_char_idx_new, out_filename_list_base, in_u8_list_base);
-        status=!!filesys_status;
+      }while((thread_idx++)!=thread_idx_max_file);
+    }
+    thread_idx=0;
+    do{
+      thread_list_base[thread_idx].maskops_thread_idx_max=0;
+      if(!thread_idx_max_file){
+        thread_list_base[thread_idx].maskops_thread_idx_max=thread_idx_max;
       }
+      thread_list_base[thread_idx].thread_idx_max=thread_idx_max_file;
+    }while((thread_idx++)!=thread_idx_max_file);
+    thread_list_run(&agnentroquant_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(agnentroquant_thread_t)), thread_idx_max_file);
+/*
+Report errors in file order, as though the files had been processed serially.
+*/
+    in_file_idx=0;
+    do{
+      filesys_status=in_file_status_list_base[in_file_idx];
+      in_filename_list_char_idx=in_filename_char_idx_list_base[in_file_idx];
+      out_filename_char_idx=out_filename_char_idx_list_base[in_file_idx];
+      status=!!filesys_status;
       if(status){
         if(filesys_status!=FILESYS_STATUS_WRITE_FAIL){
           DEBUG_WRITE(&in_filename_list_base[in_filename_list_char_idx]);
@@ -515,13 +1036,22 @@ There's one ambiguous case, namely where the fraction bits of mask_u64 are all o
           agnentroquant_error_print("Internal error. Please report");
         }
       }
-      in_filename_list_char_idx=in_filename_list_char_idx_new;
       in_file_idx++;
-      out_filename_char_idx=out_filename_char_idx_new;
     }while(in_file_idx!=in_filename_count);
     status=0;
   }while(0);
+  if(thread_idx_max_file){
+    thread_idx=1;
+    do{
+      maskops_free(thread_list_base[thread_idx].maskops_u32_list_base);
+      maskops_free(thread_list_base[thread_idx].maskops_bitmap_base);
+      maskops_free(thread_list_base[thread_idx].in_u8_list_base);
+    }while((thread_idx++)!=thread_idx_max_file);
+  }
   filesys_free(out_filename_list_base);
+  DEBUG_FREE_PARANOID(out_filename_char_idx_list_base);
+  DEBUG_FREE_PARANOID(in_filename_char_idx_list_base);
+  DEBUG_FREE_PARANOID(in_file_status_list_base);
   maskops_free(in_u8_list_base);
   filesys_free(in_filename_list_base);
   maskops_free(maskops_u32_list_base);
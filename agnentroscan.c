@@ -30,6 +30,7 @@ Entropy Scanner and Weirdness Finder
 #include "flag_fracterval_u64.h"
 #include "flag_fracterval_u128.h"
 #include "flag_loggamma.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include "flag_poissocache.h"
 #include "flag_agnentroprox.h"
@@ -46,6 +47,8 @@ Entropy Scanner and Weirdness Finder
 #include "loggamma_xtrn.h"
 #include "maskops.h"
 #include "maskops_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 #include "poissocache.h"
 #include "agnentroprox.h"
 #include "agnentroprox_xtrn.h"
@@ -75,6 +78,7 @@ Entropy Scanner and Weirdness Finder
 #define AGNENTROSCAN_FORMAT_PRECISE_BIT_IDX 4U
 #define AGNENTROSCAN_FORMAT_PROGRESS 1U
 #define AGNENTROSCAN_FORMAT_PROGRESS_BIT_IDX 3U
+#define AGNENTROSCAN_PREFETCH_SIZE_MAX 0x40000000U
 #define AGNENTROSCAN_SWEEP_STATUS_CUSTOM 0U
 #define AGNENTROSCAN_SWEEP_STATUS_HAYSTACK 1U
 
@@ -194,12 +198,12 @@ main(int argc, char *argv[]){
   u128 entropy_mean;
   fru128 entropy_raw;
   u128 entropy_threshold;
-  u8 fatal_status;
   u8 file_status;
   u8 filesys_status;
   u8 granularity;
   u8 granularity_channelized;
   u8 granularity_status;
+  ULONG *haystack_bitmap_base;
   ULONG haystack_file_size;
   ULONG haystack_file_size_max;
   char *haystack_filename_base;
@@ -208,10 +212,8 @@ main(int argc, char *argv[]){
   ULONG *haystack_filename_idx_list_base;
   char *haystack_filename_list_base;
   ULONG haystack_filename_list_char_idx;
-  ULONG haystack_filename_list_char_idx_max;
   ULONG haystack_filename_list_char_idx_new;
   ULONG haystack_filename_list_size;
-  ULONG haystack_filename_list_size_new;
   ULONG haystack_mask_idx_max;
   ULONG haystack_mask_idx_max_max;
   ULONG haystack_mask_idx_max_parallel;
@@ -224,6 +226,9 @@ main(int argc, char *argv[]){
   u32 haystack_mask_min;
   u32 haystack_mask_min_densify;
   u32 haystack_mask_min_surroundify;
+  filesys_prefetch_t haystack_prefetch;
+  void *haystack_prefetch_handle_base;
+  u8 *haystack_prefetch_mask_list_base;
   u8 haystack_sign_status;
   loggamma_t *loggamma_base;
   u32 mask_max;
@@ -264,10 +269,10 @@ main(int argc, char *argv[]){
   ULONG rank_idx_max_max;
   ULONG rank_idx_min;
   fru128 *rank_list_base;
-  u8 retry_status;
   u64 score;
   ULONG score_idx;
   fru128 score_packed;
+  u8 sign_mode;
   u8 sign_status;
   u8 status;
   u8 surroundify_status;
@@ -276,13 +281,16 @@ main(int argc, char *argv[]){
   ULONG sweep_size;
   u8 sweep_status;
   char *sweep_text_base;
+  u32 thread_idx_max;
   ULONG utf8_idx_max;
 
   overflow_status=0;
   status=ascii_init(ASCII_BUILD_BREAK_COUNT_EXPECTED, 0);
-  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 4));
+  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 7));
   status=(u8)(status|fracterval_u128_init(FRU128_BUILD_BREAK_COUNT_EXPECTED, 0));
-  status=(u8)(status|maskops_init(MASKOPS_BUILD_BREAK_COUNT_EXPECTED, 0));
+  status=(u8)(status|maskops_init(MASKOPS_BUILD_BREAK_COUNT_EXPECTED, 3));
+  status=(u8)(status|thread_init(THREAD_BUILD_BREAK_COUNT_EXPECTED, 1));
+  thread_idx_max=thread_count_get()-1;
   agnentroprox_base=NULL;
   dump_u8_list_base=NULL;
   dump_delta=0;
@@ -302,6 +310,8 @@ main(int argc, char *argv[]){
   haystack_filename_idx_list_base=NULL;
   haystack_filename_list_base=NULL;
   haystack_mask_list_base=NULL;
+  haystack_prefetch_handle_base=NULL;
+  haystack_prefetch_mask_list_base=NULL;
   loggamma_base=NULL;
   maskops_bitmap_base=NULL;
   maskops_u32_list_base=NULL;
@@ -564,31 +574,17 @@ We need to allocate space for the full dump filename, which will contain the exi
       granularity_channelized=U8_BYTE_MAX;
     }
     haystack_filename_base=argv[2];
-    fatal_status=0;
     haystack_file_size_max=0;
     haystack_filename_count=0;
     haystack_filename_list_size=U16_MAX;
-    retry_status=0;
-    do{
-      haystack_filename_list_char_idx_max=haystack_filename_list_size-1;
-      haystack_filename_list_base=filesys_char_list_malloc(haystack_filename_list_char_idx_max);
-      if(!haystack_filename_list_base){
-        fatal_status=1;
-        agnentroscan_out_of_memory_print();
-        break;
-      }
-      haystack_filename_list_size_new=haystack_filename_list_size;
-      retry_status=filesys_filename_list_get(&fatal_status, &haystack_file_size_max, &file_status, &haystack_filename_count, haystack_filename_list_base, &haystack_filename_list_size_new, haystack_filename_base);
-      if(fatal_status){
-        agnentroscan_error_print("(haystack) not found or inaccessible");
-        break;
-      }
-      if(retry_status){
-        haystack_filename_list_base=filesys_free(haystack_filename_list_base);
-        haystack_filename_list_size=haystack_filename_list_size_new;
-      }
-    }while(retry_status);
-    if(fatal_status){
+    haystack_filename_list_base=filesys_char_list_malloc(haystack_filename_list_size);
+    if(!haystack_filename_list_base){
+      agnentroscan_out_of_memory_print();
+      break;
+    }
+    status=filesys_filename_list_get(&haystack_file_size_max, &file_status, &haystack_filename_count, &haystack_filename_list_base, &haystack_filename_list_size, haystack_filename_base);
+    if(status){
+      agnentroscan_error_print("(haystack) not found or inaccessible");
       break;
     }
     status=filesys_filename_list_sort(haystack_filename_count, haystack_filename_list_base);
@@ -667,6 +663,12 @@ Ignore the return status of agnentroprox_mask_idx_max_get() because it doesn't m
     status=(u8)(status|!haystack_filename_idx_list_base);
     haystack_mask_list_base=agnentroprox_mask_list_malloc(granularity, haystack_mask_idx_max_max, overlap_status);
     status=(u8)(status|!haystack_mask_list_base);
+    if((!clip_mode)&&(haystack_filename_count!=1)&&(haystack_file_size_max<=AGNENTROSCAN_PREFETCH_SIZE_MAX)){
+/*
+Allocate a second haystack buffer so that the next haystack can be read on another thread while the current one is being analyzed. This is just an optimization, so failure isn't an error.
+*/
+      haystack_prefetch_mask_list_base=agnentroprox_mask_list_malloc(granularity, haystack_mask_idx_max_max, overlap_status);
+    }
     if(file_status){
       match_u8_idx_list_base=agnentroprox_ulong_list_malloc(match_idx_max_max);
       status=(u8)(status|!match_u8_idx_list_base);
@@ -692,6 +694,8 @@ Ignore the return status of agnentroprox_mask_idx_max_get() because it doesn't m
     U128_FROM_BOOL(entropy_threshold, append_mode);
     haystack_filename_list_char_idx=0;
     haystack_filename_idx=0;
+    haystack_mask_max=0;
+    haystack_mask_min=0;
     haystack_mask_max_densify=0;
     haystack_mask_min_densify=0;
     haystack_mask_max_finalize=0;
@@ -721,7 +725,31 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
         haystack_file_size=sweep_size;
         filesys_status=filesys_subfile_read_next(direction_status, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_file_size, 0, haystack_mask_list_base);
       }else{
-        filesys_status=filesys_file_read_next(&haystack_file_size, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_mask_list_base);
+        if(!haystack_prefetch_handle_base){
+          filesys_status=filesys_file_read_next(&haystack_file_size, &haystack_filename_list_char_idx_new, haystack_filename_list_base, haystack_mask_list_base);
+        }else{
+/*
+Wait for the haystack which was prefetched during the previous iteration, then swap it in.
+*/
+          thread_async_finish(haystack_prefetch_handle_base);
+          haystack_prefetch_handle_base=NULL;
+          filesys_status=haystack_prefetch.status;
+          haystack_file_size=haystack_prefetch.file_size_max;
+          haystack_filename_list_char_idx_new=haystack_prefetch.filename_idx;
+          haystack_prefetch.void_list_base=haystack_mask_list_base;
+          haystack_mask_list_base=haystack_prefetch_mask_list_base;
+          haystack_prefetch_mask_list_base=(u8 *)(haystack_prefetch.void_list_base);
+        }
+        if(haystack_prefetch_mask_list_base&&((haystack_filename_idx+1)!=haystack_filename_count)){
+/*
+Start reading the next haystack. Only haystack_prefetch_mask_list_base will be written, and haystack_filename_list_base will only be read, so analysis of the current haystack can proceed in parallel. If the thread can't be created, then haystack_prefetch_handle_base is NULL, so the next iteration will just read the haystack itself.
+*/
+          haystack_prefetch.file_size_max=haystack_file_size_max;
+          haystack_prefetch.filename_idx=haystack_filename_list_char_idx_new;
+          haystack_prefetch.filename_list_base=haystack_filename_list_base;
+          haystack_prefetch.void_list_base=haystack_prefetch_mask_list_base;
+          haystack_prefetch_handle_base=thread_async_start(&filesys_file_read_next_thread, &haystack_prefetch);
+        }
       }
       if(!filesys_status){
         haystack_mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, haystack_file_size, overlap_status);
@@ -763,13 +791,25 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
                 }
                 DEBUG_PRINT(" channelization...\n");
               }
-              delta_idx=0;
-              do{
-                maskops_deltafy(channel_status, 1, granularity, haystack_mask_idx_max_parallel, haystack_mask_list_base);
-              }while((delta_idx++)!=delta_count);
+            }
+            if(delta_count|densify_status|surroundify_status){
+/*
+Deltafy, unsign, and mark the densification footprint in at most 2 passes. Note that nonzero (deltas) has always resulted in one more delta than its face value, which must remain the case for consistency with undeltafication below as well as preexisting results. With multiple threads available, the footprint is marked in parallel afterwards instead.
+*/
+              haystack_bitmap_base=NULL;
+              sign_mode=MASKOPS_SIGN_MODE_KEEP;
+              if(densify_status|surroundify_status){
+                sign_mode=MASKOPS_SIGN_MODE_UNSIGN;
+                if(densify_status&&!thread_idx_max){
+                  haystack_bitmap_base=maskops_bitmap_base;
+                }
+              }
+              haystack_mask_min=maskops_pipeline(haystack_bitmap_base, channel_status, (u8)(delta_count+(!!delta_count)), granularity, haystack_mask_idx_max_parallel, haystack_mask_list_base, &haystack_mask_max, sign_mode, &haystack_sign_status);
+              if(densify_status&&thread_idx_max){
+                maskops_densify_bitmap_prepare_parallel(maskops_bitmap_base, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_max, haystack_mask_min, 1, thread_idx_max);
+              }
             }
             if(densify_status|surroundify_status){
-              haystack_sign_status=maskops_unsign(granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, &haystack_mask_max, &haystack_mask_min);
               haystack_mask_max_densify=haystack_mask_max;
               haystack_mask_max_finalize=haystack_mask_max;
               haystack_mask_max_surroundify=haystack_mask_max;
@@ -779,11 +819,10 @@ Assume that the haystack is large enough to contain at least one sweep. If not,
                 if(progress_status){
                   DEBUG_PRINT("Densifying...\n");
                 }
-                maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_max_densify, haystack_mask_min_densify, 1);
-                haystack_mask_max_finalize=maskops_densify_remask_prepare(maskops_bitmap_base, 1, haystack_mask_max_densify, haystack_mask_min_densify, maskops_u32_list_base);
+                haystack_mask_max_finalize=maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 1, haystack_mask_max_densify, haystack_mask_min_densify, maskops_u32_list_base, thread_idx_max);
                 haystack_mask_max_surroundify=haystack_mask_max_finalize;
                 haystack_mask_min_surroundify=0;
-                maskops_densify(1, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_parallel(1, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_min_densify, maskops_u32_list_base, thread_idx_max);
               }
               if(surroundify_status){
                 if(progress_status){
@@ -873,8 +912,8 @@ Normalize all the matches.
                 if(progress_status){
                   DEBUG_PRINT("Undensifying...\n");
                 }
-                maskops_densify_remask_prepare(maskops_bitmap_base, 0, haystack_mask_max_densify, haystack_mask_min_densify, maskops_u32_list_base);
-                maskops_densify(0, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_min_densify, maskops_u32_list_base);
+                maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 0, haystack_mask_max_densify, haystack_mask_min_densify, maskops_u32_list_base, thread_idx_max);
+                maskops_densify_parallel(0, granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, haystack_mask_min_densify, maskops_u32_list_base, thread_idx_max);
               }
               if(haystack_sign_status){
                 maskops_negate(granularity_channelized, haystack_mask_idx_max_parallel_channelized, haystack_mask_list_base, &haystack_mask_max);
@@ -1222,10 +1261,12 @@ We shouldn't report the error because we've been told not to, which is probably
     }
     status=0;
   }while(0);
+  thread_async_finish(haystack_prefetch_handle_base);
   agnentroprox_free_all(agnentroprox_base);
   maskops_free(maskops_u32_list_base);
   maskops_free(maskops_bitmap_base);
   agnentroprox_free(match_u8_idx_list_base);
+  agnentroprox_free(haystack_prefetch_mask_list_base);
   agnentroprox_free(haystack_mask_list_base);
   agnentroprox_free(haystack_filename_idx_list_base);
   fracterval_u128_free(entropy_list_base1);
@@ -30,6 +30,7 @@ Mask List Comparison and Absorption Utility
 #include "flag_fracterval_u128.h"
 #include "flag_fracterval_u64.h"
 #include "flag_loggamma.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include "flag_poissocache.h"
 #include "flag_agnentroprox.h"
@@ -50,6 +51,8 @@ Mask List Comparison and Absorption Utility
 #include "loggamma_xtrn.h"
 #include "maskops.h"
 #include "maskops_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 #include "poissocache.h"
 #include "agnentroprox.h"
 #include "agnentroprox_xtrn.h"
@@ -59,6 +62,7 @@ Mask List Comparison and Absorption Utility
 #include "zorb.h"
 #include "zorb_xtrn.h"
 
+#define AGNENTROZORB_BATCH_ABSORPTION_COUNT_MAX 0x100U
 #define AGNENTROZORB_GEOMETRY_CHANNELIZE 1U
 #define AGNENTROZORB_GEOMETRY_CHANNELIZE_BIT_IDX 6U
 #define AGNENTROZORB_GEOMETRY_DELTAS 3U
@@ -77,6 +81,12 @@ Mask List Comparison and Absorption Utility
 #define AGNENTROZORB_MODE_ABSORB_BIT_IDX 1U
 #define AGNENTROZORB_MODE_ABSORB_REPORT 0U
 #define AGNENTROZORB_MODE_ABSORB_SUBTRACT 2U
+#define AGNENTROZORB_MODE_AGING 0xFU
+#define AGNENTROZORB_MODE_AGING_BIT_IDX 7U
+#define AGNENTROZORB_MODE_DAEMON 1U
+#define AGNENTROZORB_MODE_DAEMON_BIT_IDX 5U
+#define AGNENTROZORB_MODE_MERGE 1U
+#define AGNENTROZORB_MODE_MERGE_BIT_IDX 6U
 #define AGNENTROZORB_MODE_NLD 1U
 #define AGNENTROZORB_MODE_NLD_BIT_IDX 4U
 #define AGNENTROZORB_MODE_POLARITY 1U
@@ -117,23 +127,296 @@ agnentrozorb_warning_print(char *char_list_base){
   return;
 }
 
+u8
+agnentrozorb_zorb_file_write(u8 journal_status, u8 *pack_base, ULONG pack_size_max, zorb_t *zorb_base, ULONG zorb_file_size, char *zorb_filename_base, char *zorb_journal_filename_base){
+/*
+Write a finalized *zorb_base to (zorbfile) in its entirety, in sparse form if that's small enough, then delete the journal if one was found when (zorbfile) was loaded. Return one on failure, after having printed the error, else zero.
+*/
+  u8 filesys_status;
+  ULONG pack_size;
+  u8 status;
+
+  status=0;
+  pack_size=zorb_pack(pack_size_max, pack_base, zorb_base);
+  if(pack_size){
+    filesys_status=filesys_file_write_obnoxious(pack_size, zorb_filename_base, pack_base);
+  }else{
+    filesys_status=filesys_file_write_obnoxious(zorb_file_size, zorb_filename_base, zorb_base);
+  }
+  if(filesys_status){
+    agnentrozorb_error_print("Can't write to (zorbfile)");
+    status=1;
+  }else if(journal_status){
+    filesys_file_delete(zorb_journal_filename_base);
+  }
+  return status;
+}
+
+u8
+agnentrozorb_zorb_filename_check(char *zorb_filename_base){
+/*
+Return zero if a filename ends in ".zrb", else one.
+*/
+  u8 status;
+  ULONG zorb_filename_char_idx_max;
+
+  status=1;
+  zorb_filename_char_idx_max=(ULONG)(strlen(zorb_filename_base));
+  if(4<zorb_filename_char_idx_max){
+    if(zorb_filename_base[zorb_filename_char_idx_max-4]=='.'){
+      if(zorb_filename_base[zorb_filename_char_idx_max-3]=='z'){
+        if(zorb_filename_base[zorb_filename_char_idx_max-2]=='r'){
+          if(zorb_filename_base[zorb_filename_char_idx_max-1]=='b'){
+            status=0;
+          }
+        }
+      }
+    }
+  }
+  return status;
+}
+
+u8
+agnentrozorb_zorb_load(u8 *dense_status_base, u32 mask_max, u8 *pack_base, ULONG pack_size_max, zorb_t *zorb_base, ULONG zorb_file_size, char *zorb_filename_base){
+/*
+Read a Zorb file into *zorb_base, trying the sparse form first, without verifying its LMD2. Set *dense_status_base to one if it was dense, else zero. Return FILESYS_STATUS_NOT_FOUND if it doesn't exist, FILESYS_STATUS_SIZE_CHANGED if its size is inconsistent with mask_max, FILESYS_STATUS_CALLER_CUSTOM if it's sparse but corrupt, some other nonzero value if it can't be read, else zero.
+*/
+  u8 dense_status;
+  u8 filesys_status;
+  ULONG pack_size;
+  ULONG zorb_filename_idx;
+
+  dense_status=0;
+  pack_size=pack_size_max;
+  zorb_filename_idx=0;
+  filesys_status=filesys_file_read_next(&pack_size, &zorb_filename_idx, zorb_filename_base, pack_base);
+  if(filesys_status==FILESYS_STATUS_TOO_BIG){
+    dense_status=1;
+    filesys_status=filesys_file_read_exact(zorb_file_size, zorb_filename_base, zorb_base);
+  }else if(!filesys_status){
+    filesys_status=zorb_unpack(mask_max, pack_size, pack_base, zorb_base);
+    if(filesys_status){
+      filesys_status=FILESYS_STATUS_CALLER_CUSTOM;
+    }
+  }
+  *dense_status_base=dense_status;
+  return filesys_status;
+}
+
+u8
+agnentrozorb_zorb_merge(char *merge_filename_base, u32 mask_max, u8 reset_status, u8 split_status, u32 thread_idx_max, ULONG zorb_file_size, char *zorb_filename_base, ULONG zorb_filename_char_idx_max){
+/*
+Add each Zorb file given by (masklist), which is either one such file or a folder of them, to (zorbfile), or subtract each of them if split_status is one. The sum is formed entirely in memory and checked by a single LMD2 pass at the end, so (zorbfile) is written exactly once, and only if every Zorb file merged successfully. Return one on failure, after having printed the error, else zero.
+*/
+  u8 dense_status;
+  u8 file_status;
+  u8 filesys_status;
+  u8 folder_status;
+  ULONG journal_size;
+  u8 journal_status;
+  u64 lmd2_accumulator;
+  ULONG merge_file_size_max;
+  ULONG merge_filename_count;
+  ULONG merge_filename_idx;
+  char *merge_filename_list_base;
+  ULONG merge_filename_list_char_idx;
+  ULONG merge_filename_list_size;
+  zorb_t *merge_zorb_base;
+  u8 *pack_base;
+  ULONG pack_size_max;
+  u8 skip_status;
+  char *source_filename_base;
+  u8 status;
+  zorb_t *zorb_base;
+  ULONG zorb_filename_idx;
+  char *zorb_journal_filename_base;
+
+  journal_status=0;
+  merge_filename_list_base=NULL;
+  pack_base=NULL;
+  zorb_journal_filename_base=NULL;
+  status=1;
+  zorb_base=zorb_init(ZORB_BUILD_BREAK_COUNT_EXPECTED, 4, mask_max);
+  merge_zorb_base=zorb_init(ZORB_BUILD_BREAK_COUNT_EXPECTED, 4, mask_max);
+  do{
+    if(!(zorb_base&&merge_zorb_base)){
+      agnentrozorb_error_print("Zorb init failed, probably due to huge (granularity)");
+      break;
+    }
+    merge_filename_list_size=U16_MAX;
+    merge_filename_list_base=filesys_char_list_malloc(merge_filename_list_size);
+    pack_base=zorb_pack_malloc(mask_max, &pack_size_max);
+    zorb_journal_filename_base=filesys_char_list_malloc(zorb_filename_char_idx_max);
+    if(!(merge_filename_list_base&&pack_base&&zorb_journal_filename_base)){
+      agnentrozorb_out_of_memory_print();
+      break;
+    }
+    memcpy(zorb_journal_filename_base, zorb_filename_base, (size_t)(zorb_filename_char_idx_max+1));
+    zorb_journal_filename_base[zorb_filename_char_idx_max-1]='j';
+/*
+Load (zorbfile) unless it's to be reset, finishing any interrupted in-place update as agnentrozorb would otherwise do. A new (zorbfile) starts out empty.
+*/
+    filesys_status=FILESYS_STATUS_NOT_FOUND;
+    if(!reset_status){
+      filesys_status=agnentrozorb_zorb_load(&dense_status, mask_max, pack_base, pack_size_max, zorb_base, zorb_file_size, zorb_filename_base);
+      if(dense_status&&!filesys_status){
+        journal_size=pack_size_max;
+        zorb_filename_idx=0;
+        journal_status=filesys_file_read_next(&journal_size, &zorb_filename_idx, zorb_journal_filename_base, pack_base);
+        if(journal_status!=FILESYS_STATUS_NOT_FOUND){
+          if(!journal_status){
+            zorb_journal_replay(mask_max, journal_size, (zorb_journal_t *)(pack_base), zorb_base);
+          }
+          journal_status=1;
+        }else{
+          journal_status=0;
+        }
+      }
+    }
+    if(filesys_status==FILESYS_STATUS_NOT_FOUND){
+      if(split_status){
+        agnentrozorb_error_print("(zorbfile) doesn't exist, so there's nothing to split from it");
+        break;
+      }
+      zorb_zero(mask_max, zorb_base);
+    }else if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
+      agnentrozorb_error_print("(zorbfile) size is inconsistent with (granularity)");
+      break;
+    }else if(filesys_status){
+      agnentrozorb_error_print("(zorbfile) is corrupt or can't be read");
+      break;
+    }else{
+      status=zorb_lmd2_accumulator_check_parallel(&lmd2_accumulator, mask_max, zorb_base, zorb_file_size, thread_idx_max);
+      if(status){
+        agnentrozorb_error_print("(zorbfile) is corrupt or has wrong size");
+        break;
+      }
+    }
+/*
+If (masklist) is a folder, then merge every Zorb file in it, in sorted order, ignoring anything else, such as journals. Otherwise, it must itself be a Zorb file.
+*/
+    folder_status=0;
+    status=filesys_filename_list_get(&merge_file_size_max, &file_status, &merge_filename_count, &merge_filename_list_base, &merge_filename_list_size, merge_filename_base);
+    if(!(status|file_status)){
+      folder_status=1;
+      if(merge_filename_count){
+        status=filesys_filename_list_sort(merge_filename_count, merge_filename_list_base);
+        if(status){
+          agnentrozorb_out_of_memory_print();
+          break;
+        }
+      }
+    }else{
+      merge_filename_count=1;
+    }
+    merge_filename_idx=0;
+    merge_filename_list_char_idx=0;
+    source_filename_base=merge_filename_base;
+    status=0;
+    while(merge_filename_idx!=merge_filename_count){
+      merge_filename_idx++;
+      skip_status=0;
+      if(folder_status){
+        source_filename_base=&merge_filename_list_base[merge_filename_list_char_idx];
+        merge_filename_list_char_idx+=(ULONG)(strlen(source_filename_base))+1;
+        skip_status=agnentrozorb_zorb_filename_check(source_filename_base);
+      }
+      if(!skip_status){
+        status=1;
+        filesys_status=agnentrozorb_zorb_load(&dense_status, mask_max, pack_base, pack_size_max, merge_zorb_base, zorb_file_size, source_filename_base);
+        if(!filesys_status){
+          status=zorb_lmd2_accumulator_check_parallel(&lmd2_accumulator, mask_max, merge_zorb_base, zorb_file_size, thread_idx_max);
+          if(!status){
+            status=zorb_merge(split_status, zorb_base, merge_zorb_base);
+            if(status){
+              DEBUG_PRINT(source_filename_base);
+              DEBUG_PRINT("\n");
+              if(split_status){
+                agnentrozorb_error_print("Some frequencies in the above file exceed those in (zorbfile), or it's aging\nat a different weight. Nothing was written");
+              }else{
+                agnentrozorb_error_print("Some frequencies would overflow upon merging the above file, or it's aging\nat a different weight. Nothing was written");
+              }
+              break;
+            }
+          }
+        }
+        if(status){
+          DEBUG_PRINT(source_filename_base);
+          DEBUG_PRINT("\n");
+          if(filesys_status==FILESYS_STATUS_NOT_FOUND){
+            agnentrozorb_error_print("The above file was not found. Nothing was written");
+          }else if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
+            agnentrozorb_error_print("The above file has a size inconsistent with (granularity). Nothing was\nwritten");
+          }else{
+            agnentrozorb_error_print("The above file is corrupt or can't be read. Nothing was written");
+          }
+          break;
+        }
+      }
+    }
+    if(status){
+      break;
+    }
+    status=zorb_lmd2_set_parallel(zorb_base, thread_idx_max);
+    if(status){
+      agnentrozorb_error_print("Internal error. Please report");
+      break;
+    }
+    status=agnentrozorb_zorb_file_write(journal_status, pack_base, pack_size_max, zorb_base, zorb_file_size, zorb_filename_base, zorb_journal_filename_base);
+  }while(0);
+  filesys_free(merge_filename_list_base);
+  zorb_free(merge_zorb_base);
+  zorb_free(pack_base);
+  zorb_free(zorb_base);
+  filesys_free(zorb_journal_filename_base);
+  return status;
+}
+
+u8
+agnentrozorb_zorb_write(agnentroprox_t *agnentroprox_base, u8 journal_status, u8 *pack_base, ULONG pack_size_max, u32 thread_idx_max, u32 weight, zorb_t *zorb_base, ULONG zorb_file_size, char *zorb_filename_base, char *zorb_journal_filename_base){
+/*
+Rewrite (zorbfile) in its entirety from frequency list zero of *agnentroprox_base and the given weight, as described in agnentrozorb_zorb_file_write(). Return one on failure, after having printed the error, else zero.
+*/
+  u8 status;
+
+  status=zorb_freq_list_import(agnentroprox_base, zorb_base);
+  if(status){
+    agnentrozorb_error_print("Internal error. Please report");
+  }else{
+    zorb_finalize_parallel(agnentroprox_base, weight, zorb_base, thread_idx_max);
+    status=agnentrozorb_zorb_file_write(journal_status, pack_base, pack_size_max, zorb_base, zorb_file_size, zorb_filename_base, zorb_journal_filename_base);
+  }
+  return status;
+}
+
 int
 main(int argc, char *argv[]){
+  ULONG absorb_count;
   u8 absorb_status;
+  u8 absorb_status_requested;
+  u8 aging_log2;
   agnentroprox_t *agnentroprox_base;
   u8 alert_status;
   ULONG arg_idx;
+  u8 batch_alert_status;
+  u8 batch_status;
+  ULONG *bitmap_base;
   u8 channel_status;
+  u8 daemon_status;
   u8 delta_count;
-  u8 delta_idx;
   u8 densify_status;
+  u8 end_status;
   u8 error_status;
+  u8 file_status;
   u8 filesys_status;
   u8 granularity;
   u8 granularity_channelized;
   u8 granularity_status;
   fru128 jsd;
   u128 jsd_mean;
+  ULONG journal_size;
+  u8 journal_status;
+  u64 lmd2_accumulator;
   loggamma_t *loggamma_base;
   ULONG mask_idx_max;
   ULONG mask_idx_max_max;
@@ -141,43 +424,72 @@ main(int argc, char *argv[]){
   ULONG mask_idx_max_parallel_channelized;
   u8 *mask_list_base;
   ULONG mask_list_file_size;
+  ULONG mask_list_file_size_max;
   char *mask_list_filename_base;
+  ULONG mask_list_filename_count;
+  ULONG mask_list_filename_idx;
+  char *mask_list_filename_list_base;
+  ULONG mask_list_filename_list_char_idx;
+  ULONG mask_list_filename_list_size;
   u32 mask_max;
   u32 mask_max_densify;
   u32 mask_max_finalize;
+  u32 mask_max_max;
   u32 mask_max_surroundify;
   u32 mask_min;
   u32 mask_min_densify;
   u32 mask_min_surroundify;
   u8 mask_size;
+  u8 masklist_error_status;
   ULONG *maskops_bitmap_base;
   u32 *maskops_u32_list_base;
   ULONG match_u8_idx;
   u64 match_u8_idx_u64;
+  u8 merge_status;
   u8 nld_status;
   u8 overlap_status;
+  u8 *pack_base;
+  ULONG pack_size;
+  ULONG pack_size_max;
   u64 parameter;
+  char *pipe_filename_base;
+  void *pipe_handle_base;
+  u8 pipe_status;
   u8 polarity_status;
+  char *request_char_list_base;
+  u8 rescale_status;
   u8 reset_status;
+  u8 resident_status;
   u64 score;
+  u8 sign_mode;
+  u8 sign_status;
   u8 status;
   u8 surroundify_status;
   ULONG sweep_mask_count;
   ULONG sweep_mask_idx_max;
   u64 threshold;
+  u32 thread_idx_max;
   ULONG threshold_digit_count;
   u8 warning_status;
+  u32 weight;
+  u8 write_status;
   zorb_t *zorb_base;
   ULONG zorb_file_size;
   char *zorb_filename_base;
   ULONG zorb_filename_char_idx_max;
+  ULONG zorb_filename_idx;
+  char *zorb_journal_filename_base;
+  void *zorb_map_base;
   ULONG zorb_mask_idx_max;
 
+  absorb_count=0;
   agnentroprox_base=NULL;
   alert_status=0;
+  batch_alert_status=0;
   error_status=1;
   loggamma_base=NULL;
   mask_list_base=NULL;
+  mask_list_filename_list_base=NULL;
   mask_max_densify=0;
   mask_min_densify=0;
   mask_max_finalize=0;
@@ -185,10 +497,23 @@ main(int argc, char *argv[]){
   mask_min_surroundify=0;
   maskops_bitmap_base=NULL;
   maskops_u32_list_base=NULL;
+  journal_status=0;
+  lmd2_accumulator=0;
+  pack_base=NULL;
+  pipe_handle_base=NULL;
+  pipe_status=0;
+  request_char_list_base=NULL;
+  resident_status=0;
+  score=0;
   warning_status=0;
+  weight=0;
   zorb_base=NULL;
+  zorb_journal_filename_base=NULL;
+  zorb_map_base=NULL;
   status=ascii_init(ASCII_BUILD_BREAK_COUNT_EXPECTED, 0);
-  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 0));
+  status=(u8)(status|filesys_init(FILESYS_BUILD_BREAK_COUNT_EXPECTED, 10));
+  status=(u8)(status|thread_init(THREAD_BUILD_BREAK_COUNT_EXPECTED, 0));
+  thread_idx_max=thread_count_get()-1;
   do{
     if(status){
       agnentrozorb_error_print("Outdated source code");
@@ -200,15 +525,15 @@ main(int argc, char *argv[]){
       DEBUG_PRINT("Mask list comparison and absorption utility.\n\n");
       DEBUG_PRINT("Function:\n\n");
       DEBUG_PRINT("  Reports the (normalized) negated Jensen-Shannon divergence (NJSD, which is\n  one minus the Jensen-Shannon divergence) between a frequency list and a mask\n  list, then optionally adds or subtracts the frequency list implied by the\n  latter to or from the former.\n\n");
-      DEBUG_PRINT("Returns:\n\n  bit 0: Set if and only if an error occurred.\n\n  bit 1: Set if and only if a warning occurred.\n\n  bit 2: Set if and only if the result was out-of-bounds (as defined by\n  (threshold)).\n\n");
+      DEBUG_PRINT("Returns:\n\n  bit 0: Set if and only if an error occurred, with any (masklist) in batch\n  mode.\n\n  bit 1: Set if and only if a warning occurred.\n\n  bit 2: Set if and only if the result, or any result in batch mode, was\n  out-of-bounds (as defined by (threshold)).\n\n");
       DEBUG_PRINT("Syntax:\n\n");
       DEBUG_PRINT("  agnentrozorb geometry mode zorbfile masklist [sweep [threshold]]\n\n");
       DEBUG_PRINT("  (geometry) is a hex bitmap which controls mask processing. Do NOT use the\n  same (zorbfile) with different (geometry) values:\n\n");
       DEBUG_PRINT("    bits 0-1: (granularity) Mask size minus 1. Note that 3 (32 bits per mask)\n    requires 64GiB of memory.\n\n    bit 2: (densify) Set to enable densification (mask utilization footprint\n    minimization) after deltafication.\n\n    bit 3: (surroundify) After densification, subtract the minimum mask from\n    all masks, so as to make the new minimum 0. Then convert all masks to their\n    surround codes relative to their new maximum. Note that surroundification\n    is a sparser way of taking the first derivative, so it may be more\n    effective than setting (deltas) to a nonzero value.\n\n    bit 4-5: (deltas) The number of times to compute the delta (discrete\n    derivative) of the mask list prior to considering (overlap). Each delta, if\n    any, will transform {A, B, C...} to  {A, (B-A), (C-B)...}. This is useful\n    for improving the entropy contrast of signals containing masks which\n    represent magnitudes, as opposed to merely symbols. Experiment to find the\n    optimum value for your data set.\n\n    bit 6: (channelize) Set if masks consist of parallel byte channels, for\n    example the red, green, and blue bytes of 24-bit pixels. This will cause\n    deltafication, if enabled, to occur on individual bytes, prior to\n    considering (overlap). For example, {A0:B0, A1:B1, A2:B2} (3 masks spanning\n    6 bytes) would be transformed to {A0:B0, (A1-A0):(B1-B0), (A2-A1):(B2-B1)}.\n\n    bit 7: (overlap) Overlap masks on byte boundaries. For example, if\n    (granularity) is 2, then {A0:B0:C0, A1:B1:C1} (2 masks spanning 6 bytes,\n    with the low bytes being A0 and A1) would be processed as though it were\n    {A0:B0:C0, B0:C0:A1, C0:A1:B1, A1:B1:C1}. This can improve search quality\n    in cases where context matters, as opposed to merely the frequency\n    distribution of symbols. It only affects search -- not preprocessing.\n\n");
       DEBUG_PRINT("  (mode) is a hex bitmap which controls statistical analysis:\n\n");
-      DEBUG_PRINT("    bit 0: (polarity) is zero if (threshold) is the maximum NJSD which is to be\n    considered mundane, else one if (threshold) is the minimum such value.\n\n    bits 1-2: (absorb) tells how to integrate (masklist) into (zorbfile), if at\n    all. For the purposes of said integration, (masklist) will be presumed to\n    contain up to 256 masks if (channelize) is one, else (256^(granularity+1)).\n    If (zorbfile) doesn't exist, then no alert will be raised, and 01, 10, and\n    11 will all be treated as 01.\n\n      00 to simply report the NJSD.\n\n      01 to report the NJSD, compute the frequency list implied by (masklist),\n      then add it to the frequency list contained in (zorbfile). If (zorbfile)\n      doesn't exist, then the NJSD will be reported as (polarity) and\n      (zorbfile) will be initialized in a manner consistent with the frequency\n      list corresponding to (masklist).\n\n      10 to report the NJSD, compute the frequency list implied by (masklist),\n      then subtract it from the frequency list contained in (zorbfile). If\n      (zorbfile) doesn't exist, then behavior will be the same as with (01).\n\n      11 is like 01, but only mundane signals will be added to the frequency\n      list. This prevents anomalies from being gradually subsumed into\n      expectation.\n\n    bit 3: (reset) Reinitialize (zorbfile) by forgetting its entire history.\n\n    bit 4: (nld) Use a negated Leidich divergence in place of the NJSD. In\n    order to avoid ordering bias, this bit may only e set if (absorb) is zero.\n\n");
-      DEBUG_PRINT("  (zorbfile) will be created if it doesn't exist. Otherwise, it's the output of\n  previous Agnentrozorb sessions created with the same (geometry) settings.\n\n");
-      DEBUG_PRINT("  (masklist) is an input file which will be preprocessed according to\n  (geometry) prior to comparison with and integration into with (zorbfile), as\n  specified by (absorb).\n\n");
+      DEBUG_PRINT("    bit 0: (polarity) is zero if (threshold) is the maximum NJSD which is to be\n    considered mundane, else one if (threshold) is the minimum such value.\n\n    bits 1-2: (absorb) tells how to integrate (masklist) into (zorbfile), if at\n    all. For the purposes of said integration, (masklist) will be presumed to\n    contain up to 256 masks if (channelize) is one, else (256^(granularity+1)).\n    If (zorbfile) doesn't exist, then no alert will be raised, and 01, 10, and\n    11 will all be treated as 01.\n\n      00 to simply report the NJSD.\n\n      01 to report the NJSD, compute the frequency list implied by (masklist),\n      then add it to the frequency list contained in (zorbfile). If (zorbfile)\n      doesn't exist, then the NJSD will be reported as (polarity) and\n      (zorbfile) will be initialized in a manner consistent with the frequency\n      list corresponding to (masklist).\n\n      10 to report the NJSD, compute the frequency list implied by (masklist),\n      then subtract it from the frequency list contained in (zorbfile). If\n      (zorbfile) doesn't exist, then behavior will be the same as with (01).\n\n      11 is like 01, but only mundane signals will be added to the frequency\n      list. This prevents anomalies from being gradually subsumed into\n      expectation.\n\n    bit 3: (reset) Reinitialize (zorbfile) by forgetting its entire history.\n\n    bit 4: (nld) Use a negated Leidich divergence in place of the NJSD. In\n    order to avoid ordering bias, this bit may only e set if (absorb) is zero.\n\n    bit 5: (daemon) Keep running, with (zorbfile) loaded, and treat (masklist) as\n    a named pipe (created with mkfifo) from which to read (masklist) filenames,\n    one per line. Each is handled in turn as though it had been given instead,\n    and its result is printed on its own line. (zorbfile) is written after\n    every 256 absorptions, and whenever all writers have closed the pipe. An\n    empty line terminates. On Windows, or if (masklist) is a regular file, the\n    end of it also terminates.\n\n    bit 6: (merge) Treat (masklist) as a Zorb file created with the same\n    (geometry), or a folder of them ending in \".zrb\", and add its frequencies to (zorbfile) if\n    (absorb) is 01, or subtract them if it's 10 (split). This combines Zorb\n    files absorbed separately, for example by different machines, or removes\n    one such contribution again. Nothing is reported, and (zorbfile) is only\n    written if all the frequencies can be merged without overflow or\n    underflow. (daemon), (nld), (polarity), and (aging) must be zero.\n\n    bits 7-10: (aging) If nonzero, make (zorbfile) forget old data gradually.\n    Each absorption then weighs 1/(2^(aging)) more than the previous one, so\n    the influence of a given (masklist) halves after about 0.7*(2^(aging))\n    further absorptions. The weight is stored in (zorbfile), and frequencies\n    are only rescaled when it gets too big, so absorption remains cheap. Once\n    (zorbfile) is aging, it can no longer be subtracted from, and (aging)\n    should be the same every time.\n\n");
+      DEBUG_PRINT("  (zorbfile) will be created if it doesn't exist. Otherwise, it's the output of\n  previous Agnentrozorb sessions created with the same (geometry) settings.\n  It's written in sparse form whenever that's at most half the size of the\n  dense form. Either form is accepted.\n\n");
+      DEBUG_PRINT("  (masklist) is an input file which will be preprocessed according to\n  (geometry) prior to comparison with and integration into with (zorbfile), as\n  specified by (absorb). If it's a folder, then all the files within it will be\n  handled in sorted order as though each had been given separately, but with\n  (zorbfile) loaded only once and written only as often as in daemon mode.\n  If (merge) is one, then it's instead as described above.\n\n");
       DEBUG_PRINT("  (sweep) is an optional decimal value which specifies the number of masks in\n  the sweep window to slide across the haystack given by (masklist); or zero\n  if the sweep window is identical to the haystack itself, in which case no\n  sliding can occur. For example, 5 means: a 5-byte window if (granularity)=0,\n  a 10-byte window if (granularity)=1 and (overlap)=0, or a 7-byte window if\n  (granularity)=2 and (overlap)=1. This value must not be nonzero if (absorb)\n  is nonzero. If nonzero, this value will cause an additional parameter to be\n  displayed after the NJSD, which is the hex base offset of the sweep window\n  with the greatest or least NJSD if (polarity) is zero or one, respectively.\n  Ties will be resolved in favor of lesser base offset.\n\n");
       DEBUG_PRINT("  (threshold) is an optional hex value up to 64-bits which specifies the\n  maximum (if (polarity) is zero) or minimum (if (polarity) is one) mundane\n  NJSD. If fewer than 16 hex digits are provided, then the provided digits will\n  be interpreted as the most significant, with the rest being zeroes. Values\n  which are not mundane will contain a \"*\" after their reported NJSD. The NJSD\n  itself is of course transcendental irrational, so for these purposes the NJSD\n  is deemed to equal the mean of the interval on which it is known to exist. If\n  not specified, this value will be presumed to be zero.\n\n");
       break;
@@ -263,12 +588,16 @@ By definition, (threshold) digits are aligned high, so shift left accordingly.
     granularity=(u8)((parameter>>AGNENTROZORB_GEOMETRY_GRANULARITY_BIT_IDX)&AGNENTROZORB_GEOMETRY_GRANULARITY);
     overlap_status=(u8)((parameter>>AGNENTROZORB_GEOMETRY_OVERLAP_BIT_IDX)&AGNENTROZORB_GEOMETRY_OVERLAP);
     surroundify_status=(u8)((parameter>>AGNENTROZORB_GEOMETRY_SURROUNDIFY_BIT_IDX)&AGNENTROZORB_GEOMETRY_SURROUNDIFY);
-    status=ascii_hex_to_u64_convert(argv[2], &parameter, 0x1F);
+    status=ascii_hex_to_u64_convert(argv[2], &parameter, 0x7FF);
     if(status){
       agnentrozorb_parameter_error_print("mode");
       break;
     }
     absorb_status=(u8)((parameter>>AGNENTROZORB_MODE_ABSORB_BIT_IDX)&AGNENTROZORB_MODE_ABSORB);
+    absorb_status_requested=absorb_status;
+    aging_log2=(u8)((parameter>>AGNENTROZORB_MODE_AGING_BIT_IDX)&AGNENTROZORB_MODE_AGING);
+    daemon_status=(u8)((parameter>>AGNENTROZORB_MODE_DAEMON_BIT_IDX)&AGNENTROZORB_MODE_DAEMON);
+    merge_status=(u8)((parameter>>AGNENTROZORB_MODE_MERGE_BIT_IDX)&AGNENTROZORB_MODE_MERGE);
     nld_status=(u8)((parameter>>AGNENTROZORB_MODE_NLD_BIT_IDX)&AGNENTROZORB_MODE_NLD);
     polarity_status=(u8)((parameter>>AGNENTROZORB_MODE_POLARITY_BIT_IDX)&AGNENTROZORB_MODE_POLARITY);
     reset_status=(u8)((parameter>>AGNENTROZORB_MODE_RESET_BIT_IDX)&AGNENTROZORB_MODE_RESET);
@@ -286,238 +615,510 @@ By definition, (threshold) digits are aligned high, so shift left accordingly.
       agnentrozorb_error_print("(reset) is one but the (absorb) bits are not 01. That makes no sense");
       break;
     }
-    zorb_filename_base=argv[3];
-    zorb_filename_char_idx_max=(ULONG)(strlen(zorb_filename_base));
-    if(4<zorb_filename_char_idx_max){
-      if(zorb_filename_base[zorb_filename_char_idx_max-4]=='.'){
-        if(zorb_filename_base[zorb_filename_char_idx_max-3]=='z'){
-          if(zorb_filename_base[zorb_filename_char_idx_max-2]=='r'){
-            if(zorb_filename_base[zorb_filename_char_idx_max-1]=='b'){
-              status=0;
-            }
-          }
-        }
+    if(aging_log2&&(absorb_status==AGNENTROZORB_MODE_ABSORB_SUBTRACT)){
+      agnentrozorb_error_print("(aging) is nonzero, but the (absorb) bits are 10. Aged frequencies can't be\nsubtracted");
+      break;
+    }
+    if(merge_status){
+      if((absorb_status!=AGNENTROZORB_MODE_ABSORB_ADD)&&(absorb_status!=AGNENTROZORB_MODE_ABSORB_SUBTRACT)){
+        agnentrozorb_error_print("(merge) is one, so the (absorb) bits must be 01 or 10");
+        break;
+      }else if(aging_log2|daemon_status|nld_status|polarity_status){
+        agnentrozorb_error_print("(merge) is one, so (daemon), (nld), (polarity), and (aging) must be zero");
+        break;
+      }else if(5<argc){
+        agnentrozorb_error_print("(merge) is one, so (sweep) and (threshold) make no sense");
+        break;
       }
     }
+    zorb_filename_base=argv[3];
+    zorb_filename_char_idx_max=(ULONG)(strlen(zorb_filename_base));
+    status=agnentrozorb_zorb_filename_check(zorb_filename_base);
     if(status){
       agnentrozorb_error_print("For the sake of consistency, (zorbfile) must end in \".zrb\"");
       break;
     }
-    mask_max=(u32)((1U<<(granularity<<U8_BITS_LOG2)<<U8_BITS)-1);
-    status=zorb_size_ulong_get(mask_max, &zorb_file_size);
+    mask_max_max=(u32)((1U<<(granularity<<U8_BITS_LOG2)<<U8_BITS)-1);
+    status=zorb_size_ulong_get(mask_max_max, &zorb_file_size);
     if(status){
       agnentrozorb_error_print("Insufficient memory to support (zorbfile) consistent with (granularity)");
       break;
     }
     mask_list_filename_base=argv[4];
-    status=1;
-    filesys_status=filesys_file_size_ulong_get(&mask_list_file_size, mask_list_filename_base);
-    if(filesys_status){
-      agnentrozorb_error_print("(masklist) not found");
-      break;
-    }
-    mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, mask_list_file_size, overlap_status);
-    if(granularity_status){
-      if(mask_idx_max!=ULONG_MAX){
-        warning_status=1;
-        agnentrozorb_warning_print("(masklist) size is not a multiple of (granularity+1). Remainder bytes\nwill be ignored");
-      }else{
-        agnentrozorb_error_print("(masklist) is too small to contain even one mask");
-        break;
-      }
-    }
-    sweep_mask_idx_max=mask_idx_max;
-    if(sweep_mask_count){
-      sweep_mask_idx_max=sweep_mask_count-1;
-      if(mask_idx_max<sweep_mask_idx_max){
-        agnentrozorb_error_print("(haystack) contains fewer than (sweep) masks");
-        break;            
-      }
-    }
-    mask_list_base=agnentroprox_mask_list_malloc(granularity, mask_idx_max, overlap_status);
-    if(!mask_list_base){
-      agnentrozorb_out_of_memory_print();
+    if(merge_status){
+      status=agnentrozorb_zorb_merge(mask_list_filename_base, mask_max_max, reset_status, (absorb_status==AGNENTROZORB_MODE_ABSORB_SUBTRACT), thread_idx_max, zorb_file_size, zorb_filename_base, zorb_filename_char_idx_max);
+      error_status=status;
       break;
     }
-    filesys_status=filesys_file_read_exact(mask_list_file_size, mask_list_filename_base, mask_list_base);
-    if(filesys_status){
-      if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
-        agnentrozorb_error_print("(masklist) changed while being read");
-        break;
-      }else{
-        agnentrozorb_error_print("(masklist) read failed");
-        break;
-      }
-    }
-    zorb_base=zorb_init(ZORB_BUILD_BREAK_COUNT_EXPECTED, 0, mask_max);
-    if(!zorb_base){
-      agnentrozorb_error_print("Zorb init failed, probably due to huge (granularity)");
-      break;
-    }
-    filesys_status=filesys_file_read_exact(zorb_file_size, zorb_filename_base, zorb_base);
-    if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
-      agnentrozorb_error_print("(zorbfile) size is inconsistent with (granularity)");
-      break;
-    }
-    if(densify_status){
-      maskops_bitmap_base=maskops_bitmap_malloc((u64)(mask_max));
-      status=!maskops_bitmap_base;
-      maskops_u32_list_base=maskops_u32_list_malloc((ULONG)(mask_max));
-      status=(u8)(status|!maskops_u32_list_base);
-      if(status){
+    pipe_filename_base=mask_list_filename_base;
+    batch_status=daemon_status;
+    if(daemon_status){
+      request_char_list_base=filesys_char_list_malloc(FILESYS_PATHNAME_CHAR_IDX_MAX);
+      if(!request_char_list_base){
         agnentrozorb_out_of_memory_print();
         break;
       }
-      status=1;
-    }
+      mask_list_filename_base=request_char_list_base;
+      pipe_status=filesys_pipe_status_get(pipe_filename_base);
+    }else{
 /*
-Set mask_idx_max_max to the largest value it could be without wrapping so that Agnentroprox will just continue to allow us to accumulate mask frequencies for a long time over multiple instances of this app.
+If (masklist) is a folder, then score all the files in it as a batch. Otherwise, let the usual checks below complain about it if need be.
 */
-    mask_idx_max_max=ULONG_MAX-1;
-    if(mask_max<mask_idx_max_max){
-      mask_idx_max_max-=mask_max;
-      mask_idx_max_max--;
-      agnentroprox_base=agnentroprox_init(AGNENTROPROX_BUILD_BREAK_COUNT_EXPECTED, 12, granularity, loggamma_base, mask_idx_max_max, mask_max, AGNENTROPROX_MODE_LDT, overlap_status, mask_idx_max);
-    }
-    if(!agnentroprox_base){
-      agnentrozorb_error_print("Agnentroprox init failed, probably due to huge (granularity)");
-      break;
-    }
-    score=0;
-    if(filesys_status|reset_status){
-      if(((absorb_status!=AGNENTROZORB_MODE_ABSORB_REPORT)&(filesys_status==FILESYS_STATUS_NOT_FOUND))|reset_status){
-        zorb_reset(agnentroprox_base, zorb_base);
-        absorb_status=AGNENTROZORB_MODE_ABSORB_ADD;
-        reset_status=1;
-        score=0;
-        score-=polarity_status;
-      }else if((absorb_status==AGNENTROZORB_MODE_ABSORB_REPORT)&(filesys_status==FILESYS_STATUS_NOT_FOUND)){
-        agnentrozorb_error_print("You set (absorb) to zero, but (zorbfile) doesn't yet exist. So you're trying\nto compare (masklist) to a distribution that doesn't exist yet. Either you\nmisspelled the (zorbfile) or you need to set (absorb) to one");
-        break;
-      }else{
-        agnentrozorb_error_print("Can't open (zorbfile). Check your spelling");
+      mask_list_filename_list_size=U16_MAX;
+      mask_list_filename_list_base=filesys_char_list_malloc(mask_list_filename_list_size);
+      if(!mask_list_filename_list_base){
+        agnentrozorb_out_of_memory_print();
         break;
       }
-    }else{
-      status=zorb_check(mask_max, zorb_base, zorb_file_size);
-      if(status){
-        agnentrozorb_error_print("(zorbfile) is corrupt or has wrong size");
-        break;
+      status=filesys_filename_list_get(&mask_list_file_size_max, &file_status, &mask_list_filename_count, &mask_list_filename_list_base, &mask_list_filename_list_size, mask_list_filename_base);
+      if(!(status|file_status)){
+        if(mask_list_filename_count){
+          status=filesys_filename_list_sort(mask_list_filename_count, mask_list_filename_list_base);
+          if(status){
+            agnentrozorb_out_of_memory_print();
+            break;
+          }
+        }
+        batch_status=1;
       }
     }
-    granularity_channelized=granularity;
-    mask_idx_max_parallel=0;
-    mask_size=(u8)(granularity+1);
-    if(channel_status){
-      granularity_channelized=U8_BYTE_MAX;
-    }
-    if(delta_count|densify_status|surroundify_status){
-      mask_idx_max_parallel=agnentroprox_mask_idx_max_get(granularity, &granularity_status, mask_list_file_size, 0);
-      if(granularity_status){
-        agnentrozorb_error_print("(masklist) size must be a multiply of (granularity+1) bytes when\n(densify), (surroundify), or (deltas) is nonzero, regardless of (overlap).");
-        break;
+    error_status=0;
+    mask_list_filename_idx=0;
+    mask_list_filename_list_char_idx=0;
+/*
+Handle one (masklist) per iteration. Unless in batch mode, there's only one. Otherwise, in daemon mode, read (masklist) filenames from the pipe given by (masklist), one per line; or else take them from the folder given by (masklist), in sorted order. Errors specific to one (masklist) merely break out of the inner loop, skipping to the next one, whereas others are fatal, so they set end_status first. Either way, masklist_error_status remains set, and error_status accumulates it, so that a failure anywhere in the batch is reported at exit. Likewise, batch_alert_status is set if any (masklist) raised an alert.
+*/
+    do{
+      alert_status=0;
+      end_status=0;
+      masklist_error_status=1;
+      filesys_status=0;
+      mask_max=mask_max_max;
+      if(agnentroprox_base){
+        agnentroprox_mask_max_reset(agnentroprox_base);
       }
-    }
-    mask_idx_max_parallel_channelized=mask_idx_max_parallel;
-    if(channel_status){
-      mask_idx_max_parallel_channelized=(mask_idx_max_parallel_channelized*mask_size)+granularity;
-    }
-    if(delta_count){
-      delta_idx=0;
       do{
-        maskops_deltafy(channel_status, 1, granularity, mask_idx_max_parallel, mask_list_base);
-      }while((delta_idx++)!=delta_count);
-    }
-    if(densify_status|surroundify_status){
-      maskops_unsign(granularity_channelized, mask_idx_max_parallel_channelized, mask_list_base, &mask_max, &mask_min);
-      mask_max_densify=mask_max;
-      mask_max_finalize=mask_max;
-      mask_max_surroundify=mask_max;
-      mask_min_densify=mask_min;
-      mask_min_surroundify=mask_min;
-      if(densify_status){
-        maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity_channelized, mask_idx_max_parallel_channelized, mask_list_base, mask_max_densify, mask_min_densify, 1);
-        mask_max_finalize=maskops_densify_remask_prepare(maskops_bitmap_base, 1, mask_max_densify, mask_min_densify, maskops_u32_list_base);
-        mask_max_surroundify=mask_max_finalize;
-        mask_min_surroundify=0;
-        maskops_densify(1, granularity_channelized, mask_idx_max_parallel_channelized, mask_list_base, mask_min_densify, maskops_u32_list_base);
-      }
-      if(surroundify_status){
-        mask_max_finalize=maskops_surroundify(channel_status, 1, granularity, mask_idx_max_parallel, mask_list_base, mask_max_surroundify, mask_min_surroundify);
-      }
-      if(channel_status){
-        mask_max_finalize=(mask_max_finalize+(mask_max_finalize<<U8_BITS)+(mask_max_finalize<<U16_BITS)+(mask_max_finalize<<U24_BITS))&mask_max;
-      }
-      agnentroprox_mask_max_set(agnentroprox_base, mask_max_finalize);
-    }
-    status=zorb_mask_list_load(agnentroprox_base, mask_list_base, mask_list_file_size);
-    if(status){
-      agnentrozorb_error_print("(masklist) is too big or has mistmatched granularity");
-      break;
-    }
-    if(!reset_status){
-      status=zorb_mask_idx_max_get(&zorb_mask_idx_max, zorb_base);
-      if(!status){
-        status=zorb_freq_list_export(agnentroprox_base, zorb_base);
-      }
-      if(status){
-        agnentrozorb_error_print("(zorbfile) frequencies are too big to handle");
-        break;
-      }
-      if(!nld_status){
-        agnentroprox_jsd_transform(agnentroprox_base, polarity_status, mask_idx_max, mask_list_base, &jsd, 0, &match_u8_idx, sweep_mask_idx_max);
-      }else{
-        agnentroprox_ld_transform(agnentroprox_base, polarity_status, mask_idx_max, mask_list_base, &jsd, 0, &match_u8_idx, sweep_mask_idx_max);
-      }
-      FRU128_MEAN_TO_FTD128(jsd_mean, jsd);
-      U128_TO_U64_HI(score, jsd_mean);
-    }
-    if(!(((absorb_status==AGNENTROZORB_MODE_ABSORB_ADD_MUNDANE)&alert_status)|(absorb_status==AGNENTROZORB_MODE_ABSORB_REPORT))){
-      if(absorb_status!=AGNENTROZORB_MODE_ABSORB_SUBTRACT){
-        status=zorb_freq_list_add(agnentroprox_base);
-        if(status){
-          agnentrozorb_error_print("(zorbfile) can't absorb any more data. Please report");
+        if(daemon_status){
+          filesys_status=filesys_line_read(FILESYS_PATHNAME_CHAR_IDX_MAX, request_char_list_base, pipe_filename_base, &pipe_handle_base);
+          if(filesys_status==FILESYS_STATUS_TOO_BIG){
+            agnentrozorb_error_print("(masklist) filename is too long");
+            break;
+          }else if(filesys_status==FILESYS_STATUS_READ_FAIL){
+            agnentrozorb_error_print("Can't read from (masklist) pipe");
+            end_status=1;
+            break;
+          }
+          end_status=(u8)(filesys_status|!*request_char_list_base);
+        }else if(batch_status){
+          end_status=(mask_list_filename_idx==mask_list_filename_count);
+          if(!end_status){
+            mask_list_filename_base=&mask_list_filename_list_base[mask_list_filename_list_char_idx];
+            mask_list_filename_list_char_idx+=(ULONG)(strlen(mask_list_filename_base))+1;
+            mask_list_filename_idx++;
+          }
+        }
+/*
+The folder is exhausted, all writers have closed the pipe, or an empty line requested termination. In any case, there's no telling when the next (masklist) will arrive, so write (zorbfile) if it has changed. Then, if the pipe was closed, wait for it to be reopened. Don't if (masklist) is a regular file, as its end is final, or on Windows, where there's no equivalent.
+*/
+        if(end_status){
+          if(absorb_count){
+            status=agnentrozorb_zorb_write(agnentroprox_base, journal_status, pack_base, pack_size_max, thread_idx_max, weight, zorb_base, zorb_file_size, zorb_filename_base, zorb_journal_filename_base);
+            if(status){
+              end_status=1;
+              break;
+            }
+            absorb_count=0;
+            journal_status=0;
+          }
+          masklist_error_status=0;
+          if(pipe_status&&filesys_status){
+            end_status=0;
+          }
+          break;
+        }
+        mask_list_base=agnentroprox_free(mask_list_base);
+        status=1;
+        filesys_status=filesys_file_size_ulong_get(&mask_list_file_size, mask_list_filename_base);
+        if(filesys_status){
+          agnentrozorb_error_print("(masklist) not found");
+          break;
+        }
+        mask_idx_max=agnentroprox_mask_idx_max_get(granularity, &granularity_status, mask_list_file_size, overlap_status);
+        if(granularity_status){
+          if(mask_idx_max!=ULONG_MAX){
+            warning_status=1;
+            agnentrozorb_warning_print("(masklist) size is not a multiple of (granularity+1). Remainder bytes\nwill be ignored");
+          }else{
+            agnentrozorb_error_print("(masklist) is too small to contain even one mask");
+            break;
+          }
+        }
+        sweep_mask_idx_max=mask_idx_max;
+        if(sweep_mask_count){
+          sweep_mask_idx_max=sweep_mask_count-1;
+          if(mask_idx_max<sweep_mask_idx_max){
+            agnentrozorb_error_print("(haystack) contains fewer than (sweep) masks");
+            break;
+          }
+        }
+        mask_list_base=agnentroprox_mask_list_malloc(granularity, mask_idx_max, overlap_status);
+        if(!mask_list_base){
+          agnentrozorb_out_of_memory_print();
           break;
         }
-      }else{
-        status=zorb_freq_list_subtract(agnentroprox_base);
+        filesys_status=filesys_file_read_exact(mask_list_file_size, mask_list_filename_base, mask_list_base);
+        if(filesys_status){
+          if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
+            agnentrozorb_error_print("(masklist) changed while being read");
+            break;
+          }else{
+            agnentrozorb_error_print("(masklist) read failed");
+            break;
+          }
+        }
+/*
+Load (zorbfile) and initialize Agnentroprox only once, so that in batch mode they remain resident from one (masklist) to the next.
+*/
+        if(!agnentroprox_base){
+          zorb_base=zorb_init(ZORB_BUILD_BREAK_COUNT_EXPECTED, 5, mask_max);
+          if(!zorb_base){
+            agnentrozorb_error_print("Zorb init failed, probably due to huge (granularity)");
+            end_status=1;
+            break;
+          }
+          pack_base=zorb_pack_malloc(mask_max, &pack_size_max);
+          zorb_journal_filename_base=filesys_char_list_malloc(zorb_filename_char_idx_max);
+          if(!(pack_base&&zorb_journal_filename_base)){
+            agnentrozorb_out_of_memory_print();
+            end_status=1;
+            break;
+          }
+          memcpy(zorb_journal_filename_base, zorb_filename_base, (size_t)(zorb_filename_char_idx_max+1));
+          zorb_journal_filename_base[zorb_filename_char_idx_max-1]='j';
+/*
+Try to read (zorbfile) as a sparse Zorb file first. If it's too big to be one, then it must be dense, in which case map it so that absorption only needs to touch the frequencies which change. Don't bother if it's about to be reset, and fall back to reading it if mapping fails.
+*/
+          pack_size=pack_size_max;
+          zorb_filename_idx=0;
+          filesys_status=filesys_file_read_next(&pack_size, &zorb_filename_idx, zorb_filename_base, pack_base);
+          if(filesys_status==FILESYS_STATUS_TOO_BIG){
+            filesys_status=FILESYS_STATUS_READ_FAIL;
+            if(!(batch_status|reset_status)){
+              filesys_status=filesys_file_map(zorb_file_size, zorb_filename_base, &zorb_map_base);
+            }
+            if(!filesys_status){
+              zorb_free(zorb_base);
+              zorb_base=(zorb_t *)(zorb_map_base);
+            }else{
+              filesys_status=filesys_file_read_exact(zorb_file_size, zorb_filename_base, zorb_base);
+            }
+/*
+Finish any in-place update which was interrupted after its journal reached storage. If the journal is corrupt, then the interruption occurred before that point, so (zorbfile) is intact and the journal just needs to be discarded. Only delete the journal once (zorbfile) is known to reflect it.
+*/
+            if(!filesys_status){
+              pack_size=pack_size_max;
+              zorb_filename_idx=0;
+              journal_status=filesys_file_read_next(&pack_size, &zorb_filename_idx, zorb_journal_filename_base, pack_base);
+              if(journal_status!=FILESYS_STATUS_NOT_FOUND){
+                if(!journal_status){
+                  journal_status=zorb_journal_replay(mask_max, pack_size, (zorb_journal_t *)(pack_base), zorb_base);
+                }
+                if(zorb_map_base){
+                  if(!journal_status){
+                    filesys_status=filesys_file_map_sync(zorb_file_size, zorb_map_base);
+                    if(filesys_status){
+                      agnentrozorb_error_print("Can't write to (zorbfile)");
+                      end_status=1;
+                      break;
+                    }
+                  }
+                  filesys_file_delete(zorb_journal_filename_base);
+                }
+                journal_status=1;
+              }else{
+                journal_status=0;
+              }
+            }
+          }else if(!filesys_status){
+            status=zorb_unpack(mask_max, pack_size, pack_base, zorb_base);
+            if(status){
+              agnentrozorb_error_print("(zorbfile) is corrupt or has wrong size");
+              end_status=1;
+              break;
+            }
+            status=1;
+          }
+          if(filesys_status==FILESYS_STATUS_SIZE_CHANGED){
+            agnentrozorb_error_print("(zorbfile) size is inconsistent with (granularity)");
+            end_status=1;
+            break;
+          }
+          if(densify_status){
+            maskops_bitmap_base=maskops_bitmap_malloc((u64)(mask_max));
+            status=!maskops_bitmap_base;
+            maskops_u32_list_base=maskops_u32_list_malloc((ULONG)(mask_max));
+            status=(u8)(status|!maskops_u32_list_base);
+            if(status){
+              agnentrozorb_out_of_memory_print();
+              end_status=1;
+              break;
+            }
+            status=1;
+          }
+/*
+Set mask_idx_max_max to the largest value it could be without wrapping so that Agnentroprox will just continue to allow us to accumulate mask frequencies for a long time over multiple instances of this app.
+*/
+          mask_idx_max_max=ULONG_MAX-1;
+          if(mask_max<mask_idx_max_max){
+            mask_idx_max_max-=mask_max;
+            mask_idx_max_max--;
+            agnentroprox_base=agnentroprox_init(AGNENTROPROX_BUILD_BREAK_COUNT_EXPECTED, 12, granularity, loggamma_base, mask_idx_max_max, mask_max, AGNENTROPROX_MODE_LDT, overlap_status, mask_idx_max);
+          }
+          if(!agnentroprox_base){
+            agnentrozorb_error_print("Agnentroprox init failed, probably due to huge (granularity)");
+            end_status=1;
+            break;
+          }
+          score=0;
+          if(filesys_status|reset_status){
+            if(((absorb_status!=AGNENTROZORB_MODE_ABSORB_REPORT)&(filesys_status==FILESYS_STATUS_NOT_FOUND))|reset_status){
+              zorb_reset(agnentroprox_base, zorb_base);
+              absorb_status=AGNENTROZORB_MODE_ABSORB_ADD;
+              reset_status=1;
+              score=0;
+              score-=polarity_status;
+            }else if((absorb_status==AGNENTROZORB_MODE_ABSORB_REPORT)&(filesys_status==FILESYS_STATUS_NOT_FOUND)){
+              agnentrozorb_error_print("You set (absorb) to zero, but (zorbfile) doesn't yet exist. So you're trying\nto compare (masklist) to a distribution that doesn't exist yet. Either you\nmisspelled the (zorbfile) or you need to set (absorb) to one");
+              end_status=1;
+              break;
+            }else{
+              agnentrozorb_error_print("Can't open (zorbfile). Check your spelling");
+              end_status=1;
+              break;
+            }
+          }else{
+            status=zorb_lmd2_accumulator_check_parallel(&lmd2_accumulator, mask_max, zorb_base, zorb_file_size, thread_idx_max);
+            if(status){
+              agnentrozorb_error_print("(zorbfile) is corrupt or has wrong size");
+              end_status=1;
+              break;
+            }
+          }
+          weight=zorb_base->weight;
+        }
+        granularity_channelized=granularity;
+        mask_idx_max_parallel=0;
+        mask_size=(u8)(granularity+1);
+        if(channel_status){
+          granularity_channelized=U8_BYTE_MAX;
+        }
+        if(delta_count|densify_status|surroundify_status){
+          mask_idx_max_parallel=agnentroprox_mask_idx_max_get(granularity, &granularity_status, mask_list_file_size, 0);
+          if(granularity_status){
+            agnentrozorb_error_print("(masklist) size must be a multiply of (granularity+1) bytes when\n(densify), (surroundify), or (deltas) is nonzero, regardless of (overlap).");
+            break;
+          }
+        }
+        mask_idx_max_parallel_channelized=mask_idx_max_parallel;
+        if(channel_status){
+          mask_idx_max_parallel_channelized=(mask_idx_max_parallel_channelized*mask_size)+granularity;
+        }
+        if(delta_count|densify_status|surroundify_status){
+/*
+Deltafy, unsign, and mark the densification footprint in at most 2 passes. Note that nonzero (deltas) has always resulted in one more delta than its face value, which must remain the case for consistency with preexisting zorbs. With multiple threads available, the footprint is marked in parallel afterwards instead.
+*/
+          bitmap_base=NULL;
+          sign_mode=MASKOPS_SIGN_MODE_KEEP;
+          if(densify_status|surroundify_status){
+            sign_mode=MASKOPS_SIGN_MODE_UNSIGN;
+            if(densify_status&&!thread_idx_max){
+              bitmap_base=maskops_bitmap_base;
+            }
+          }
+          mask_min=maskops_pipeline(bitmap_base, channel_status, (u8)(delta_count+(!!delta_count)), granularity, mask_idx_max_parallel, mask_list_base, &mask_max, sign_mode, &sign_status);
+          if(densify_status&&thread_idx_max){
+            maskops_densify_bitmap_prepare_parallel(maskops_bitmap_base, granularity_channelized, mask_idx_max_parallel_channelized, mask_list_base, mask_max, mask_min, 1, thread_idx_max);
+          }
+        }
+        if(densify_status|surroundify_status){
+          mask_max_densify=mask_max;
+          mask_max_finalize=mask_max;
+          mask_max_surroundify=mask_max;
+          mask_min_densify=mask_min;
+          mask_min_surroundify=mask_min;
+          if(densify_status){
+            mask_max_finalize=maskops_densify_remask_prepare_parallel(maskops_bitmap_base, 1, mask_max_densify, mask_min_densify, maskops_u32_list_base, thread_idx_max);
+            mask_max_surroundify=mask_max_finalize;
+            mask_min_surroundify=0;
+            maskops_densify_parallel(1, granularity_channelized, mask_idx_max_parallel_channelized, mask_list_base, mask_min_densify, maskops_u32_list_base, thread_idx_max);
+          }
+          if(surroundify_status){
+            mask_max_finalize=maskops_surroundify(channel_status, 1, granularity, mask_idx_max_parallel, mask_list_base, mask_max_surroundify, mask_min_surroundify);
+          }
+          if(channel_status){
+            mask_max_finalize=(mask_max_finalize+(mask_max_finalize<<U8_BITS)+(mask_max_finalize<<U16_BITS)+(mask_max_finalize<<U24_BITS))&mask_max;
+          }
+          agnentroprox_mask_max_set(agnentroprox_base, mask_max_finalize);
+        }
+        status=zorb_mask_list_load(agnentroprox_base, mask_list_base, mask_list_file_size);
         if(status){
-          agnentrozorb_error_print("(zorbfile) can't subtract (masklist), perhaps because you did duplicate\nsubtractions previously");
+          agnentrozorb_error_print("(masklist) is too big or has mistmatched granularity");
           break;
         }
-      }
-      status=zorb_freq_list_import(agnentroprox_base, zorb_base);
-      if(status){
-        agnentrozorb_error_print("Internal error. Please report");
-        break;
-      }
-      zorb_finalize(agnentroprox_base, zorb_base);
-      filesys_status=filesys_file_write_obnoxious(zorb_file_size, zorb_filename_base, zorb_base);
-      if(filesys_status){
-        agnentrozorb_error_print("Can't write to (zorbfile)");
-        break;
-      }
-    }
-    if(!polarity_status){
-      alert_status=(threshold<score);
-    }else{
-      alert_status=(score<threshold);
-    }
-    DEBUG_U64("", score);
-    if(alert_status){
-      DEBUG_PRINT("*");
-    }
-    if(sweep_mask_count){
-      DEBUG_PRINT(" ");
-      match_u8_idx_u64=match_u8_idx;
-      DEBUG_U64("", match_u8_idx_u64);
-    }
-    DEBUG_PRINT(" ");
-    DEBUG_WRITE(mask_list_filename_base);
-    error_status=0;
+        if(!reset_status){
+          if(!resident_status){
+            status=zorb_mask_idx_max_get(&zorb_mask_idx_max, zorb_base);
+            if(!status){
+              status=zorb_freq_list_export(agnentroprox_base, zorb_base);
+            }
+            if(status){
+              agnentrozorb_error_print("(zorbfile) frequencies are too big to handle");
+              end_status=1;
+              break;
+            }
+          }else if(agnentroprox_base->mask_max!=zorb_base->mask_max){
+/*
+(densify) or (surroundify) has shrunk the mask span of this (masklist), so it can't be compared with frequency list zero. zorb_freq_list_export() would have refused for the same reason, so fail the same way, but only for this (masklist).
+*/
+            agnentrozorb_error_print("(zorbfile) frequencies are too big to handle");
+            break;
+          }
+          if(!nld_status){
+            agnentroprox_jsd_transform(agnentroprox_base, polarity_status, mask_idx_max, mask_list_base, &jsd, 0, &match_u8_idx, sweep_mask_idx_max);
+          }else{
+            agnentroprox_ld_transform(agnentroprox_base, polarity_status, mask_idx_max, mask_list_base, &jsd, 0, &match_u8_idx, sweep_mask_idx_max);
+          }
+          FRU128_MEAN_TO_FTD128(jsd_mean, jsd);
+          U128_TO_U64_HI(score, jsd_mean);
+        }
+/*
+In batch mode, frequency list zero now reflects (zorbfile) and will be kept up to date as each (masklist) is absorbed, so it mustn't be exported again.
+*/
+        resident_status=batch_status;
+        if(!(((absorb_status==AGNENTROZORB_MODE_ABSORB_ADD_MUNDANE)&alert_status)|(absorb_status==AGNENTROZORB_MODE_ABSORB_REPORT))){
+          rescale_status=0;
+          if(absorb_status!=AGNENTROZORB_MODE_ABSORB_SUBTRACT){
+/*
+An aging (zorbfile) absorbs (masklist) at its current weight, even if (aging) is now zero. If (zorbfile) is only now starting to age, then its existing frequencies are scaled up to the initial weight first, which changes all of them.
+*/
+            if(aging_log2&&!weight){
+              status=zorb_freq_list_weight(agnentroprox_base, 0, 1U<<aging_log2);
+              if(status){
+                agnentrozorb_error_print("(zorbfile) frequencies are too big to start (aging)");
+                break;
+              }
+              rescale_status=1;
+              weight=1U<<aging_log2;
+            }
+            if(weight){
+              status=zorb_freq_list_weight(agnentroprox_base, 1, weight);
+              if(status){
+                agnentrozorb_error_print("(zorbfile) can't absorb any more data. Try a smaller (aging)");
+                break;
+              }
+            }
+            status=zorb_freq_list_add(agnentroprox_base);
+            if(status){
+              agnentrozorb_error_print("(zorbfile) can't absorb any more data. Please report");
+              break;
+            }
+            if(aging_log2){
+              rescale_status=(u8)(rescale_status|zorb_weight_advance(agnentroprox_base, aging_log2, &weight));
+            }
+          }else if(weight){
+            agnentrozorb_error_print("(zorbfile) is aging, so its frequencies can't be subtracted");
+            break;
+          }else{
+            status=zorb_freq_list_subtract(agnentroprox_base);
+            if(status){
+              agnentrozorb_error_print("(zorbfile) can't subtract (masklist), perhaps because you did duplicate\nsubtractions previously");
+              break;
+            }
+          }
+/*
+Update a mapped (zorbfile) in place by writing a journal of the changed frequencies to storage, applying it, waiting for (zorbfile) to reach storage, and then deleting the journal. If the journal would be too big to be worthwhile, then rewrite (zorbfile) in its entirety as usual. A dense (zorbfile) thus remains dense. Rescaling changes every frequency, so it always requires a rewrite.
+*/
+          journal_size=0;
+          if(zorb_map_base){
+            if(!rescale_status){
+              journal_size=zorb_journal_build(agnentroprox_base, lmd2_accumulator, pack_size_max, (zorb_journal_t *)(pack_base), weight, zorb_base);
+            }
+            if(journal_size){
+              filesys_status=filesys_file_write_durable(journal_size, zorb_journal_filename_base, pack_base);
+              if(filesys_status){
+                agnentrozorb_error_print("Can't write (zorbfile) journal");
+                end_status=1;
+                break;
+              }
+              status=zorb_journal_replay(mask_max, journal_size, (zorb_journal_t *)(pack_base), zorb_base);
+              if(status){
+                agnentrozorb_error_print("Internal error. Please report");
+                end_status=1;
+                break;
+              }
+              filesys_status=filesys_file_map_sync(zorb_file_size, zorb_map_base);
+              if(filesys_status){
+                agnentrozorb_error_print("Can't write to (zorbfile)");
+                end_status=1;
+                break;
+              }
+              filesys_file_delete(zorb_journal_filename_base);
+            }else{
+              filesys_file_unmap(zorb_file_size, zorb_map_base);
+              zorb_map_base=NULL;
+              zorb_base=zorb_init(ZORB_BUILD_BREAK_COUNT_EXPECTED, 5, mask_max);
+              if(!zorb_base){
+                agnentrozorb_out_of_memory_print();
+                end_status=1;
+                break;
+              }
+              zorb_reset(agnentroprox_base, zorb_base);
+            }
+          }
+/*
+In batch mode, rewrite (zorbfile) only after every AGNENTROZORB_BATCH_ABSORPTION_COUNT_MAX absorptions, or when the supply of (masklist)s pauses, instead of after every one.
+*/
+          write_status=!journal_size;
+          if(batch_status){
+            absorb_count++;
+            write_status=(absorb_count==AGNENTROZORB_BATCH_ABSORPTION_COUNT_MAX);
+          }
+          if(write_status){
+            status=agnentrozorb_zorb_write(agnentroprox_base, journal_status, pack_base, pack_size_max, thread_idx_max, weight, zorb_base, zorb_file_size, zorb_filename_base, zorb_journal_filename_base);
+            if(status){
+              end_status=1;
+              break;
+            }
+            absorb_count=0;
+            journal_status=0;
+          }
+        }
+        if(!polarity_status){
+          alert_status=(threshold<score);
+        }else{
+          alert_status=(score<threshold);
+        }
+        DEBUG_U64("", score);
+        if(alert_status){
+          DEBUG_PRINT("*");
+        }
+        if(sweep_mask_count){
+          DEBUG_PRINT(" ");
+          match_u8_idx_u64=match_u8_idx;
+          DEBUG_U64("", match_u8_idx_u64);
+        }
+        DEBUG_PRINT(" ");
+        DEBUG_WRITE(mask_list_filename_base);
+        masklist_error_status=0;
+        absorb_status=absorb_status_requested;
+        reset_status=0;
+      }while(0);
+      batch_alert_status=(u8)(batch_alert_status|alert_status);
+      error_status=(u8)(error_status|masklist_error_status);
+    }while(batch_status&&!end_status);
   }while(0);
   status=0;
-  if(alert_status){
+  if(batch_alert_status){
     status=(u8)(status|(1U<<AGNENTROZORB_STATUS_ALERT_BIT_IDX));
   }
   if(error_status){
@@ -529,7 +1130,16 @@ Set mask_idx_max_max to the largest value it could be without wrapping so that A
   agnentroprox_free_all(agnentroprox_base);
   maskops_free(maskops_u32_list_base);
   maskops_free(maskops_bitmap_base);
-  zorb_free(zorb_base);
+  if(zorb_map_base){
+    filesys_file_unmap(zorb_file_size, zorb_map_base);
+  }else{
+    zorb_free(zorb_base);
+  }
+  zorb_free(pack_base);
+  filesys_free(zorb_journal_filename_base);
+  filesys_line_close(pipe_handle_base);
+  filesys_free(request_char_list_base);
+  filesys_free(mask_list_filename_list_base);
   agnentroprox_free(mask_list_base);
   loggamma_free(loggamma_base);
   DEBUG_ALLOCATION_CHECK();
@@ -25,11 +25,19 @@ File IO Kernel
 #include "flag.h"
 #include "flag_filesys.h"
 #include <dirent.h>
+#include <errno.h>
+#include <fcntl.h>
 #include <stdint.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <sys/stat.h>
+#ifndef WINDOWS
+  #include <sys/mman.h>
+#else
+  #include <io.h>
+#endif
+#include <unistd.h>
 #include "constant.h"
 #include "debug.h"
 #include "debug_xtrn.h"
@@ -62,6 +70,169 @@ Out:
   return list_base;
 }
 
+char *
+filesys_char_list_realloc(ULONG char_idx_max, char *list_base){
+/*
+Change the size of a list of (char)s.
+
+To maximize portability and debuggability, this is the only function in which Filesys calls realloc().
+
+In:
+
+  char_idx_max is the number of (char)s to which to resize the list, less one.
+
+  *list_base is the return value of filesys_char_list_malloc() or this function.
+
+Out:
+
+  Returns NULL on failure, else the base of (char_idx_max+1) items, the first MIN(char_idx_max+1, (old size)) of which being copied from *list_base. The return value should eventually be freed via filesys_free(). On failure, as with realloc(), the existing allocation remains unchanged; on success, it has been freed.
+*/
+  char *list_base_new;
+  ULONG list_size;
+
+  list_base_new=NULL;
+  list_size=char_idx_max+1;
+  if(list_size){
+    list_base_new=DEBUG_REALLOC_PARANOID(list_base, list_size);
+  }
+  return list_base_new;
+}
+
+u8
+filesys_file_append(ULONG file_size, char *filename_base, void *void_list_base){
+/*
+Append a buffer to an existing file, so that a file too big to fit in memory can be written incrementally.
+
+In:
+
+  file_size is the size to write.
+
+  *filename_base is the null-terminated path and filename. The file should have been created by filesys_file_write() or filesys_file_write_obnoxious().
+
+  *void_list_base contains the file_size bytes to write.
+
+Out:
+
+  Returns zero on success else FILESYS_STATUS_WRITE_FAIL. In the latter case, the file has been closed but its contents beyond its preexisting size are undefined.
+*/
+  ULONG file_size_written;
+  FILE *handle;
+  u8 status;
+
+  handle=fopen(filename_base, "ab");
+  status=FILESYS_STATUS_WRITE_FAIL;
+  if(handle){
+    status=0;
+    if(file_size){
+      file_size_written=(ULONG)(fwrite(void_list_base, (size_t)(U8_SIZE), (size_t)(file_size), handle));
+      if(file_size!=file_size_written){
+        status=FILESYS_STATUS_WRITE_FAIL;
+      }
+    }
+    if(fclose(handle)){
+      status=FILESYS_STATUS_WRITE_FAIL;
+    }
+  }
+  return status;
+}
+
+u8
+filesys_file_delete(char *filename_base){
+/*
+Delete a file.
+
+In:
+
+  *filename_base is the null-terminated path and filename.
+
+Out:
+
+  Returns zero on success else FILESYS_STATUS_WRITE_FAIL.
+*/
+  u8 status;
+
+  status=0;
+  if(remove(filename_base)){
+    status=FILESYS_STATUS_WRITE_FAIL;
+  }
+  return status;
+}
+
+u8
+filesys_file_map(ULONG file_size, char *filename_base, void **map_base_base){
+/*
+Map a file into memory for reading and writing, so long as its size is exactly as expected. Changes made to the mapped memory will eventually reach the file, so the caller is responsible for writing them in a crash-safe order, and then calling filesys_file_map_sync() or filesys_file_unmap().
+
+In:
+
+  file_size is the expected size of the file, which must be nonzero.
+
+  *filename_base is the null-terminated path and filename.
+
+  *map_base_base is undefined.
+
+Out:
+
+  Returns zero on success, else: (1) FILESYS_STATUS_SIZE_CHANGED if the file size was not file_size, (2) FILESYS_STATUS_NOT_FOUND if the file could not be opened for reading and writing, or (3) FILESYS_STATUS_READ_FAIL if the file could not be mapped, which is always the case on Windows.
+
+  *map_base_base is the base of the mapped file on success, else NULL. It must eventually be passed to filesys_file_unmap().
+*/
+  #ifndef WINDOWS
+    struct stat file_stat;
+    int handle;
+    void *map_base;
+  #endif
+  u8 status;
+
+  *map_base_base=NULL;
+  status=FILESYS_STATUS_READ_FAIL;
+  #ifndef WINDOWS
+    handle=open(filename_base, O_RDWR);
+    status=FILESYS_STATUS_NOT_FOUND;
+    if(0<=handle){
+      status=FILESYS_STATUS_SIZE_CHANGED;
+      if((!fstat(handle, &file_stat))&&((u64)(file_stat.st_size)==file_size)){
+        status=FILESYS_STATUS_READ_FAIL;
+        if(file_size){
+          map_base=mmap(NULL, (size_t)(file_size), PROT_READ|PROT_WRITE, MAP_SHARED, handle, 0);
+          if(map_base!=MAP_FAILED){
+            status=0;
+            *map_base_base=map_base;
+          }
+        }
+      }
+      close(handle);
+    }
+  #endif
+  return status;
+}
+
+u8
+filesys_file_map_sync(ULONG file_size, void *map_base){
+/*
+Wait until all changes to a file mapped by filesys_file_map() have been written to storage.
+
+In:
+
+  file_size is as given to filesys_file_map().
+
+  *map_base is (Out:*map_base_base) from filesys_file_map().
+
+Out:
+
+  Returns zero on success else FILESYS_STATUS_WRITE_FAIL.
+*/
+  u8 status;
+
+  status=FILESYS_STATUS_WRITE_FAIL;
+  #ifndef WINDOWS
+    if(!msync(map_base, (size_t)(file_size), MS_SYNC)){
+      status=0;
+    }
+  #endif
+  return status;
+}
+
 u8
 filesys_file_read(ULONG *file_size_max_base, char *filename_base, void *void_list_base){
 /*
@@ -179,6 +350,30 @@ Out:
   return status;
 }
 
+void *
+filesys_file_read_next_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for filesys_file_read_next(), for use with thread_async_start(), so that the next file in a filename list can be read while the caller analyzes the current one.
+
+In:
+
+  *thread_base is a filesys_prefetch_t whose file_size_max, filename_idx, filename_list_base, and void_list_base are as (In:*file_size_max_base), (In:*filename_idx_base), filename_list_base, and void_list_base, respectively, for filesys_file_read_next(). No other thread may access *filename_list_base in write mode, nor *void_list_base at all, until this function has returned.
+
+Out:
+
+  Returns NULL.
+
+  *thread_base is as follows: status is the return value of filesys_file_read_next(); file_size_max and filename_idx are as (Out:*file_size_max_base) and (Out:*filename_idx_base), respectively, thereof; all other fields are unchanged.
+
+  *void_list_base is as (Out:*void_list_base) for filesys_file_read_next().
+*/
+  filesys_prefetch_t *thread_base_u;
+
+  thread_base_u=(filesys_prefetch_t *)(thread_base);
+  thread_base_u->status=filesys_file_read_next(&thread_base_u->file_size_max, &thread_base_u->filename_idx, thread_base_u->filename_list_base, thread_base_u->void_list_base);
+  return NULL;
+}
+
 u8
 filesys_file_size_get(u64 *file_size_base, char *filename_base){
 /*
@@ -263,6 +458,30 @@ Out:
   }
 #endif
 
+u8
+filesys_file_unmap(ULONG file_size, void *map_base){
+/*
+Write all changes to a file mapped by filesys_file_map() to storage, then unmap it.
+
+In:
+
+  file_size is as given to filesys_file_map().
+
+  *map_base is (Out:*map_base_base) from filesys_file_map().
+
+Out:
+
+  Returns zero on success else FILESYS_STATUS_WRITE_FAIL. In either case, *map_base is no longer accessible.
+*/
+  u8 status;
+
+  status=filesys_file_map_sync(file_size, map_base);
+  #ifndef WINDOWS
+    munmap(map_base, (size_t)(file_size));
+  #endif
+  return status;
+}
+
 u8
 filesys_file_write(ULONG file_size, char *filename_base, void *void_list_base){
 /*
@@ -301,6 +520,90 @@ Out:
   return status;
 }
 
+u8
+filesys_file_write_durable(ULONG file_size, char *filename_base, void *void_list_base){
+/*
+Write a buffer to a file, overwriting any existing file of the same name, and don't return until the file has reached storage. On POSIX systems, also sync its parent folder, so that the file can't disappear on power loss after having just been created. This is slower than filesys_file_write(), so it should be reserved for small files such as journals.
+
+In:
+
+  file_size is the size to write.
+
+  *filename_base is the writable null-terminated path and filename. It will be unchanged upon return.
+
+  *void_list_base contains the file_size bytes to write.
+
+Out:
+
+  Returns zero on success else FILESYS_STATUS_WRITE_FAIL. In the latter case, the file has been closed but its contents are undefined.
+*/
+  ULONG file_size_written;
+  FILE *handle;
+  u8 status;
+  #ifndef WINDOWS
+    ULONG filename_idx;
+    int folder_handle;
+    char separator;
+  #endif
+
+  handle=fopen(filename_base, "wb");
+  status=FILESYS_STATUS_WRITE_FAIL;
+  if(handle){
+    status=0;
+    if(file_size){
+      file_size_written=(ULONG)(fwrite(void_list_base, (size_t)(U8_SIZE), (size_t)(file_size), handle));
+      if(file_size!=file_size_written){
+        status=FILESYS_STATUS_WRITE_FAIL;
+      }
+    }
+    if(fflush(handle)){
+      status=FILESYS_STATUS_WRITE_FAIL;
+    }
+    #ifndef WINDOWS
+      if(fsync(fileno(handle))){
+        status=FILESYS_STATUS_WRITE_FAIL;
+      }
+    #else
+      if(_commit(_fileno(handle))){
+        status=FILESYS_STATUS_WRITE_FAIL;
+      }
+    #endif
+    if(fclose(handle)){
+      status=FILESYS_STATUS_WRITE_FAIL;
+    }
+    #ifndef WINDOWS
+/*
+Temporarily truncate *filename_base to its parent folder, or use the current folder if it has none. Keep the separator if the parent is the root. Some filesystems can't sync folders, which they indicate with EINVAL, so ignore that.
+*/
+      if(!status){
+        filename_idx=(ULONG)(strlen(filename_base));
+        do{
+          filename_idx--;
+        }while(filename_idx&&(filename_base[filename_idx]!=FILESYS_PATH_SEPARATOR));
+        separator=filename_base[filename_idx];
+        if(separator==FILESYS_PATH_SEPARATOR){
+          filename_idx+=!filename_idx;
+          separator=filename_base[filename_idx];
+          filename_base[filename_idx]=0;
+          folder_handle=open(filename_base, O_RDONLY);
+          filename_base[filename_idx]=separator;
+        }else{
+          folder_handle=open(".", O_RDONLY);
+        }
+        status=FILESYS_STATUS_WRITE_FAIL;
+        if(0<=folder_handle){
+          status=0;
+          if(fsync(folder_handle)&&(errno!=EINVAL)){
+            status=FILESYS_STATUS_WRITE_FAIL;
+          }
+          close(folder_handle);
+        }
+      }
+    #endif
+  }
+  return status;
+}
+
 u8
 filesys_file_write_next_obnoxious(ULONG file_size, ULONG *filename_idx_base, char *filename_list_base, void *void_list_base){
 /*
@@ -387,6 +690,12 @@ Out:
         #else
           status=!!mkdir(filename_base);
         #endif
+/*
+Another thread or process may have created the folder since fopen() failed, in which case it's there now, so proceed as though this call had created it.
+*/
+        if(status&&(errno==EEXIST)){
+          status=0;
+        }
       }while(status);
       if(!status){
 /*
@@ -474,58 +783,62 @@ Out:
 }
 
 u8
-filesys_filename_list_get(u8 *fatal_status_base, ULONG *file_size_max_base, u8 *file_status_base, ULONG *filename_count_base, char *filename_list_base, ULONG *filename_list_size_max_base, char *target_base){
+filesys_filename_list_get(ULONG *file_size_max_base, u8 *file_status_base, ULONG *filename_count_base, char **filename_list_base_base, ULONG *filename_list_size_max_base, char *target_base){
 /*
-Given a file, return the name of that file if it exists. Given a folder, return the relative path and name of every file which it contains, ignoring links, block devices, character devices, and sockets.
+Given a file, return the name of that file if it exists. Given a folder, return the relative path and name of every file which it contains, ignoring links, block devices, character devices, and sockets. The list grows as needed, so the folder tree is traversed only once.
 
 In:
 
-  *fatal_status_base is undefined.
-
   *file_size_max_base is undefined.
 
   *file_status_base is undefined.
 
   *filename_count_base is undefined.
 
-  *filename_list_base is undefined and writable for (*filename_list_size_max_base+1) bytes.
+  *filename_list_base_base is the return value of filesys_char_list_malloc(*filename_list_size_max_base), which is the initial filename list.
 
-  *filename_list_size_max_base is the maximum size which may be written to *filename_list_base.
+  *filename_list_size_max_base is the maximum size which may be written to *filename_list_base_base without growing it, which must not be ULONG_MAX.
 
   *target_base is the file or folder to find, and in the latter case, spider. Both local and global paths are allowed.
 
 Out:
 
-  Returns zero on success, else one. Zero merely means that the process completed without encountering an error return from memory allocation or OS function calls; *filename_count_list_base may still be zero. This value shall be one if  *fatal_status_base is one.
-
-  *fatal_status_base is zero if the return value is zero, or if retrying this function with a larger *filename_list_size_max_base might result in a return value of zero. Otherwise a fatal error occurred, which includes the following cases without limitation: (1) In:*filename_list_size_max_base was ULONG_MAX but was nevertheless found to be insufficient; (2) the deepest nested folder exceeds lexical level FILESYS_DIRECTORY_DEPTH_IDX_MAX; and (3) if any discovered full pathname, including *target_base itself, exceeds size (FILESYS_PATHNAME_CHAR_IDX_MAX+1).
+  Returns zero on success, else one. Zero merely means that the process completed without encountering an error return from memory allocation or OS function calls; *filename_count_list_base may still be zero. Otherwise an error occurred, which includes the following cases without limitation: (1) the filename list could not be grown; (2) the deepest nested folder exceeds lexical level FILESYS_DIRECTORY_DEPTH_IDX_MAX; and (3) if any discovered full pathname, including *target_base itself, exceeds size (FILESYS_PATHNAME_CHAR_IDX_MAX+1).
 
   *file_size_max_base is the maximum file size encountered, which is zero if the return value is zero.
 
   *file_status_base is one if *target_base is a file or the return value is zero, else zero if it's a folder; and likewise for equivalent links.
 
-  *filename_count_base is the number of items at *filename_list_base, all of which being null-terminated. This value may be may be zero even if the return value is zero, indicating that *target_base was not found; or nonzero even if the return value is one, indicating partial but valid results at *filename_list_base.
+  *filename_count_base is the number of items at *filename_list_base_base, all of which being null-terminated. This value may be may be zero even if the return value is zero, indicating that *target_base was not found; or nonzero even if the return value is one, indicating partial but valid results at *filename_list_base_base.
 
-  *filename_list_base is just a copy of *target_base if it's a file that exists, else a concatenation of (return value) null-terminated relative paths and filenames subordinate to *target_base. Points to a null character if the return value is zero.
+  *filename_list_base_base has been reallocated if it needed to grow, and should eventually be freed via filesys_free(). It's just a copy of *target_base if it's a file that exists, else a concatenation of (*filename_count_base) null-terminated relative paths and filenames subordinate to *target_base. Points to a null character if *filename_count_base is zero.
 
-  *filename_list_size_max_base is at least the defined size at filename_list_base. It has been inflated by filesys_hull_size_get() in order to prevent trivial changes to the folder tree from indefinitely delaying the successful completion of this process; it should complete successfully within O(log(N)) attempts -- and usually just one -- given N files. This value will be nonzero even if the return value is zero.
+  *filename_list_size_max_base is as on input, but pertaining to Out:*filename_list_base_base.
 */
   u8 continue_status;
+  #ifndef WINDOWS
+    int dir_fd;
+  #endif
   DIR *dir_handle;
   DIR *dir_handle_new;
   DIR **dir_handle_list_base;
   struct dirent *dirent_base;
   ULONG dirent_idx;
+  #if (!defined(WINDOWS))&&defined(DT_UNKNOWN)
+    u8 dirent_type;
+  #endif
   char *dirname_base;
   ULONG dirname_size;
-  u8 fatal_status;
   ULONG file_size;
   ULONG file_size_max;
   u64 file_size_u64;
   char *filename_base;
   ULONG filename_count;
+  char *filename_list_base;
+  char *filename_list_base_new;
   ULONG filename_list_size;
   ULONG filename_list_size_max;
+  ULONG filename_list_size_max_new;
   ULONG filename_list_size_new;
   #ifndef WINDOWS
     mode_t filename_mode;
@@ -539,18 +852,21 @@ Out:
   u8 rollback_status;
   u8 status;
 
+  filename_list_base=*filename_list_base_base;
   filename_list_size_max=*filename_list_size_max_base;
   file_size=0;
   file_size_max=0;
   file_size_u64=0;
   filename_count=0;
   filename_list_size=0;
+  #ifndef WINDOWS
+    filename_mode=0;
+  #endif
   *file_status_base=1;
   filename_size=(ULONG)(strlen(target_base));
   while((1<filename_size)&&(target_base[filename_size-1]==FILESYS_PATH_SEPARATOR)){
     filename_size--;
   }
-  fatal_status=0;
   status=0;
   filename_list_base[0]=0;
   target_base[filename_size]=0;
@@ -563,66 +879,111 @@ Out:
       strcpy(filename_base, target_base);
       continue_status=1;
       dir_handle=NULL;
+      dirent_base=NULL;
       dirent_idx=0;
+      dirname_base=NULL;
       dirname_size=0;
       filename_size_old=filename_size;
       rollback_status=0;
       do{
         if(!rollback_status){
 /*
-Ignore everything but files and folders -- even links to them -- because we don't want duplicate analysis and definitely don't want infinite recursion. We have to use lstat() instead of just inspecting dirent_base->d_type because DT_LNK is not consistently reported by Ubuntu. But lstat() doesn't work in Windows under MinGW; fortunately, in that case, links (shortcuts) appear to operate like files rather than folders, and therefore carry no risk of self-referential loops, even though they could result in unavoidable duplicate analysis.
+Ignore everything but files and folders -- even links to them -- because we don't want duplicate analysis and definitely don't want infinite recursion. Inside a folder, dirent_base->d_type allows us to skip anything which is definitely not a file or folder without a system call. But we still have to use lstat() semantics for everything else because DT_LNK is not consistently reported by Ubuntu, and in any case we need the file size. We use fstatat() relative to the parent folder so that the kernel doesn't have to resolve the entire path again. But none of this works in Windows under MinGW; fortunately, in that case, links (shortcuts) appear to operate like files rather than folders, and therefore carry no risk of self-referential loops, even though they could result in unavoidable duplicate analysis.
 */
           #ifndef WINDOWS
-            if(!lstat(filename_base, &filename_stat)){
-              filename_mode=filename_stat.st_mode;
-              if(!(S_ISDIR(filename_mode)||S_ISREG(filename_mode))){
-                rollback_status=1;
+            #ifdef DT_UNKNOWN
+              if(dirent_idx){
+                dirent_type=(u8)(dirent_base->d_type);
+                if((dirent_type!=DT_DIR)&&(dirent_type!=DT_REG)&&(dirent_type!=DT_UNKNOWN)){
+                  rollback_status=1;
+                }
               }
-              if(S_ISBLK(filename_mode)||S_ISCHR(filename_mode)||S_ISFIFO(filename_mode)||S_ISLNK(filename_mode)||S_ISSOCK(filename_mode)){
-                rollback_status=1;
+            #endif
+            if(!rollback_status){
+              if(dirent_idx){
+                rollback_status=!!fstatat(dirfd(dir_handle), dirname_base, &filename_stat, AT_SYMLINK_NOFOLLOW);
+              }else{
+                rollback_status=!!lstat(filename_base, &filename_stat);
+              }
+              if(!rollback_status){
+                filename_mode=filename_stat.st_mode;
+                if(!(S_ISDIR(filename_mode)||S_ISREG(filename_mode))){
+                  rollback_status=1;
+                }
+                if(S_ISBLK(filename_mode)||S_ISCHR(filename_mode)||S_ISFIFO(filename_mode)||S_ISLNK(filename_mode)||S_ISSOCK(filename_mode)){
+                  rollback_status=1;
+                }
+              }else{
+                status=rollback_status;
               }
-            }else{
-              fatal_status=1;
-              rollback_status=fatal_status;
-              status=fatal_status;
             }
           #endif
         }
         if(!rollback_status){
-          dir_handle_new=opendir(filename_base);
+/*
+Only try to open folders, as opposed to files, because a failed open is a wasted system call. A folder which can't be opened is treated as a file, which will fail to be read.
+*/
+          #ifndef WINDOWS
+            dir_handle_new=NULL;
+            if(S_ISDIR(filename_mode)){
+              if(dirent_idx){
+                dir_fd=openat(dirfd(dir_handle), dirname_base, O_RDONLY|O_DIRECTORY|O_NOFOLLOW);
+                if(0<=dir_fd){
+                  dir_handle_new=fdopendir(dir_fd);
+                  if(!dir_handle_new){
+                    close(dir_fd);
+                  }
+                }
+              }else{
+                dir_handle_new=opendir(filename_base);
+              }
+            }
+          #else
+            dir_handle_new=opendir(filename_base);
+          #endif
           if(!dir_handle_new){
             #ifndef WINDOWS
               file_size_u64=(u64)(filename_stat.st_size);
             #else
               rollback_status=!!filesys_file_size_get(&file_size_u64, filename_base);
               if(rollback_status){
-                fatal_status=rollback_status;
                 status=rollback_status;
               }
             #endif
             file_size=(ULONG)(file_size_u64);
             #ifdef _32_
               if(file_size!=file_size_u64){
-                fatal_status=1;
-                rollback_status=fatal_status;
-                status=fatal_status;
+                rollback_status=1;
+                status=rollback_status;
               }
             #endif
             if(!rollback_status){
               file_size_max=MAX(file_size, file_size_max);
               filename_list_size_new=filename_list_size+filename_size;
               if(filename_list_size<filename_list_size_new){
+                if(filename_list_size_max<filename_list_size_new){
+/*
+Grow the list exponentially, so that the total cost of copying it is linear in its final size.
+*/
+                  filename_list_size_max_new=filesys_hull_size_get(filename_list_size_new)-1;
+                  filename_list_base_new=NULL;
+                  if(filename_list_size_new<=filename_list_size_max_new){
+                    filename_list_base_new=filesys_char_list_realloc(filename_list_size_max_new, filename_list_base);
+                  }
+                  if(filename_list_base_new){
+                    filename_list_base=filename_list_base_new;
+                    filename_list_size_max=filename_list_size_max_new;
+                  }else{
+                    status=1;
+                  }
+                }
                 if(filename_list_size_new<=filename_list_size_max){
                   filename_count++;
                   memcpy(&filename_list_base[filename_list_size], filename_base, (size_t)(filename_size));
                   filename_list_size=filename_list_size_new;
-                }else{
-                  fatal_status=!(~filename_list_size_max);
-                  status=1;
                 }
               }else{
-                fatal_status=1;
-                status=fatal_status;
+                status=1;
               }
               rollback_status=1;
             }
@@ -636,9 +997,8 @@ Ignore everything but files and folders -- even links to them -- because we don'
               rollback_status=0;
             }else{
               closedir(dir_handle_new);
-              fatal_status=1;
-              rollback_status=fatal_status;
-              status=fatal_status;
+              rollback_status=1;
+              status=rollback_status;
             }
           }
         }
@@ -660,9 +1020,8 @@ Ignore everything but files and folders -- even links to them -- because we don'
             rollback_status=0;
             filename_size=filename_size_old+dirname_size;
             if((FILESYS_PATHNAME_CHAR_IDX_MAX+1)<filename_size){
-              fatal_status=1;
-              rollback_status=fatal_status;
-              status=fatal_status;
+              rollback_status=1;
+              status=rollback_status;
             }else if(dirname_size<=3){
               if(1<dirname_size){
                 if(dirname_base[0]=='.'){
@@ -701,15 +1060,17 @@ Ignore everything but files and folders -- even links to them -- because we don'
           }
         }
       }while(continue_status);
+    }else{
+      status=1;
     }
     DEBUG_FREE_PARANOID(filename_size_list_base);
     filesys_free(filename_base);
     DEBUG_FREE_PARANOID(dir_handle_list_base);
   }
-  *fatal_status_base=fatal_status;
   *file_size_max_base=file_size_max;
   *filename_count_base=filename_count;
-  *filename_list_size_max_base=filesys_hull_size_get(filename_list_size_max);
+  *filename_list_base_base=filename_list_base;
+  *filename_list_size_max_base=filename_list_size_max;
   return status;
 }
 
@@ -720,11 +1081,11 @@ Morph all the paths in filename list, but keep the isolated filenames identical.
 
 In:
 
-  filename_count is the return value of filesys_filename_list_get().
+  filename_count is filesys_filename_list_get():Out:*filename_count_base.
 
   *source_base is filesys_filename_list_get():In:*target_base.
 
-  *source_filename_list_base is filesys_filename_list_get():Out:*filename_list_base.
+  *source_filename_list_base is filesys_filename_list_get():Out:*filename_list_base_base.
 
   *target_base is analogous to *source_base, and is also null-terminated. It indicates the target folder which is to replace the source folder in all pathnames within *source_filename_list_base.
 
@@ -777,11 +1138,11 @@ Get the size required by *target_filename_list_base in filesys_filename_list_mor
 
 In:
 
-  filename_count is the return value of filesys_filename_list_get().
+  filename_count is filesys_filename_list_get():Out:*filename_count_base.
 
   *source_base is filesys_filename_list_get():In:*target_base.
 
-  *source_filename_list_base is filesys_filename_list_get():Out:*filename_list_base.
+  *source_filename_list_base is filesys_filename_list_get():Out:*filename_list_base_base.
 
   *target_base is analogous to *source_base, and is also null-terminated. It indicates the target folder which is to replace the source folder in all pathnames within *source_filename_list_base.
 
@@ -844,25 +1205,54 @@ Account for the case in which we need an extra FILESYS_PATH_SEPARATOR for each t
 
 u8
 filesys_filename_list_sort(ULONG filename_count, char *filename_list_base){
-  ULONG byte_idx;
-  ULONG file_idx_idx_idx;
-  ULONG file_idx_idx_list_base[U8_SPAN+1U];
-  ULONG file_idx_idx0;
-  ULONG file_idx_idx1;
+/*
+Sort a filename list in ascending order of unsigned byte values, such that a filename precedes any other of which it is a prefix, and identical filenames retain their relative order.
+
+The filenames themselves are only moved once, at the end. Until then, the sort operates on a list of indexes, each with a cached 8-byte key from its filename. Each group of filenames is radix sorted by key, after which only those subgroups whose keys are equal and don't contain a terminating null need to be sorted again, using the next 8 bytes. This is much faster than sorting on every byte of every filename, because most filenames differ within a few keys of the end of their common folder path. Small groups are just insertion sorted.
+
+In:
+
+  filename_count is the number of filenames at filename_list_base.
+
+  *filename_list_base is a concatenation of filename_count null-terminated filenames.
+
+Out:
+
+  Returns zero on success, else one if filename_count is zero, any filename is empty, or memory allocation failed.
+
+  *filename_list_base is sorted as described in the summary if the return value is zero, else unchanged.
+*/
+  ULONG bucket_count;
+  ULONG bucket_count_list_base[U8_SPAN];
+  ULONG bucket_idx;
+  u8 byte_count;
+  u8 byte_shift;
+  ULONG char_idx;
+  ULONG depth;
+  ULONG file_count;
+  ULONG file_idx;
+  ULONG file_idx_idx;
+  ULONG file_idx_idx_max;
+  ULONG file_idx_idx_min;
+  ULONG file_idx_idx_new;
   ULONG *file_idx_list_base0;
   ULONG *file_idx_list_base1;
   ULONG *file_idx_list_base2;
-  ULONG file_idx;
   ULONG *filename_char_idx_list_base;
-  char *filename_list_base0;
   char *filename_list_base1;
   ULONG filename_list_char_idx0;
   ULONG filename_list_char_idx1;
   ULONG filename_size;
   ULONG *filename_size_list_base;
-  ULONG filename_size_max;
   ULONG filename_size_min;
+  ULONG group_idx;
+  ULONG *group_list_base;
+  u64 key;
+  u64 *key_list_base0;
+  u64 *key_list_base1;
+  u64 *key_list_base2;
   ULONG list_size;
+  u8 pass_status;
   u8 status;
 
   status=!filename_count;
@@ -876,88 +1266,170 @@ filesys_filename_list_sort(ULONG filename_count, char *filename_list_base){
     status=(u8)(status|!filename_char_idx_list_base);
     filename_size_list_base=DEBUG_MALLOC_PARANOID(list_size);
     status=(u8)(status|!filename_size_list_base);
+/*
+Groups are disjoint and contain at least 2 filenames each, so at most (filename_count>>1) of them can be pending at once. Each requires a base index, a count, and a depth.
+*/
+    group_list_base=DEBUG_MALLOC_PARANOID((((filename_count>>1)+1)*3)<<ULONG_SIZE_LOG2);
+    status=(u8)(status|!group_list_base);
+    list_size=filename_count<<U64_SIZE_LOG2;
+    key_list_base0=DEBUG_MALLOC_PARANOID(list_size);
+    status=(u8)(status|!key_list_base0);
+    key_list_base1=DEBUG_MALLOC_PARANOID(list_size);
+    status=(u8)(status|!key_list_base1);
     if(!status){
       file_idx=0;
-      filename_list_base0=filename_list_base;
       filename_list_char_idx0=0;
-      filename_size_max=0;
       filename_size_min=ULONG_MAX;
-      status=1;
       do{
         filename_char_idx_list_base[file_idx]=filename_list_char_idx0;
-        filename_size=strlen(&filename_list_base0[filename_list_char_idx0]);
+        filename_size=strlen(&filename_list_base[filename_list_char_idx0]);
         filename_list_char_idx0+=filename_size+1U;
-        filename_size_max=MAX(filename_size, filename_size_max);
         filename_size_min=MIN(filename_size, filename_size_min);
         filename_size_list_base[file_idx]=filename_size;
+        file_idx_list_base0[file_idx]=file_idx;
         file_idx++;
       }while(file_idx!=filename_count);
       filename_list_base1=DEBUG_MALLOC_PARANOID(filename_list_char_idx0);
       status=(!filename_list_base1)|!filename_size_min;
       if(!status){
-        file_idx_idx0=0;
-        list_size=(U8_SPAN+1U)<<ULONG_SIZE_LOG2;
+        group_list_base[0]=0;
+        group_list_base[1]=filename_count;
+        group_list_base[2]=0;
+        group_idx=3;
         do{
-          file_idx_list_base0[file_idx_idx0]=file_idx_idx0;
-          file_idx_idx0++;
-        }while(file_idx_idx0!=filename_count);
-        byte_idx=filename_size_max-1U;
-        do{
-          memset(file_idx_idx_list_base, 0, (size_t)(list_size));
-          file_idx=0;
-          do{
-            filename_size=filename_size_list_base[file_idx];
-            file_idx_idx_idx=0;
-            if(byte_idx<filename_size){
-              filename_list_char_idx0=filename_char_idx_list_base[file_idx];
-              file_idx_idx_idx=(u8)(filename_list_base0[filename_list_char_idx0+byte_idx]);
-              file_idx_idx_idx++;
+          group_idx-=3;
+          file_idx_idx_min=group_list_base[group_idx];
+          file_count=group_list_base[group_idx+1];
+          depth=group_list_base[group_idx+2];
+          file_idx_idx_max=file_idx_idx_min+file_count-1;
+          if(file_count<=FILESYS_FILENAME_LIST_SORT_INSERTION_COUNT_MAX){
+/*
+All filenames in the group are identical before depth, so strcmp() need only consider the rest. Like the radix sort below, this is stable.
+*/
+            file_idx_idx=file_idx_idx_min;
+            while(file_idx_idx!=file_idx_idx_max){
+              file_idx_idx++;
+              file_idx=file_idx_list_base0[file_idx_idx];
+              filename_list_char_idx0=filename_char_idx_list_base[file_idx]+depth;
+              file_idx_idx_new=file_idx_idx;
+              do{
+                filename_list_char_idx1=filename_char_idx_list_base[file_idx_list_base0[file_idx_idx_new-1]]+depth;
+                if(strcmp(&filename_list_base[filename_list_char_idx1], &filename_list_base[filename_list_char_idx0])<=0){
+                  break;
+                }
+                file_idx_list_base0[file_idx_idx_new]=file_idx_list_base0[file_idx_idx_new-1];
+                file_idx_idx_new--;
+              }while(file_idx_idx_new!=file_idx_idx_min);
+              file_idx_list_base0[file_idx_idx_new]=file_idx;
             }
-            file_idx_idx_list_base[file_idx_idx_idx]++;
-            file_idx++;
-          }while(file_idx!=filename_count);
-          file_idx_idx_idx=0;
-          file_idx_idx0=0;
-          do{
-            file_idx_idx1=file_idx_idx_list_base[file_idx_idx_idx];
-            file_idx_idx_list_base[file_idx_idx_idx]=file_idx_idx0;
-            file_idx_idx0+=file_idx_idx1;
-          }while((file_idx_idx_idx++)<=U8_MAX);
-          file_idx_idx0=0;
-          do{
-            file_idx=file_idx_list_base0[file_idx_idx0];
-            filename_size=filename_size_list_base[file_idx];
-            file_idx_idx_idx=0;
-            if(byte_idx<filename_size){
-              filename_list_char_idx0=filename_char_idx_list_base[file_idx];
-              file_idx_idx_idx=(u8)(filename_list_base0[filename_list_char_idx0+byte_idx]);
-              file_idx_idx_idx++;
+          }else{
+/*
+Load the big endian key at depth for each filename, padding with nulls beyond its end.
+*/
+            file_idx_idx=file_idx_idx_min;
+            do{
+              file_idx=file_idx_list_base0[file_idx_idx];
+              filename_size=filename_size_list_base[file_idx];
+              byte_count=0;
+              if(depth<filename_size){
+                byte_count=U64_SIZE;
+                if((filename_size-depth)<U64_SIZE){
+                  byte_count=(u8)(filename_size-depth);
+                }
+              }
+              char_idx=filename_char_idx_list_base[file_idx]+depth;
+              byte_shift=U64_BITS-U8_BITS;
+              key=0;
+              while(byte_count--){
+                key|=(u64)((u8)(filename_list_base[char_idx]))<<byte_shift;
+                byte_shift=(u8)(byte_shift-U8_BITS);
+                char_idx++;
+              }
+              key_list_base0[file_idx_idx]=key;
+            }while((file_idx_idx++)!=file_idx_idx_max);
+/*
+LSD radix sort the group by key, skipping any byte which is the same throughout, which is common because filenames in the same folder share most of their path. Keys outside the group are irrelevant, but if an odd number of passes are done, then the sorted indexes must be copied back to the list containing the indexes for all other groups.
+*/
+            byte_shift=0;
+            pass_status=0;
+            do{
+              memset(bucket_count_list_base, 0, (size_t)(U8_SPAN<<ULONG_SIZE_LOG2));
+              file_idx_idx=file_idx_idx_min;
+              do{
+                bucket_count_list_base[(u8)(key_list_base0[file_idx_idx]>>byte_shift)]++;
+              }while((file_idx_idx++)!=file_idx_idx_max);
+              if(bucket_count_list_base[(u8)(key_list_base0[file_idx_idx_min]>>byte_shift)]!=file_count){
+                bucket_idx=0;
+                file_idx_idx_new=file_idx_idx_min;
+                do{
+                  bucket_count=bucket_count_list_base[bucket_idx];
+                  bucket_count_list_base[bucket_idx]=file_idx_idx_new;
+                  file_idx_idx_new+=bucket_count;
+                }while((++bucket_idx)!=U8_SPAN);
+                file_idx_idx=file_idx_idx_min;
+                do{
+                  key=key_list_base0[file_idx_idx];
+                  bucket_idx=(u8)(key>>byte_shift);
+                  file_idx_idx_new=bucket_count_list_base[bucket_idx];
+                  bucket_count_list_base[bucket_idx]=file_idx_idx_new+1;
+                  file_idx_list_base1[file_idx_idx_new]=file_idx_list_base0[file_idx_idx];
+                  key_list_base1[file_idx_idx_new]=key;
+                }while((file_idx_idx++)!=file_idx_idx_max);
+                file_idx_list_base2=file_idx_list_base0;
+                file_idx_list_base0=file_idx_list_base1;
+                file_idx_list_base1=file_idx_list_base2;
+                key_list_base2=key_list_base0;
+                key_list_base0=key_list_base1;
+                key_list_base1=key_list_base2;
+                pass_status=!pass_status;
+              }
+              byte_shift=(u8)(byte_shift+U8_BITS);
+            }while(byte_shift!=U64_BITS);
+            if(pass_status){
+              memcpy(&file_idx_list_base1[file_idx_idx_min], &file_idx_list_base0[file_idx_idx_min], (size_t)(file_count<<ULONG_SIZE_LOG2));
+              file_idx_list_base2=file_idx_list_base0;
+              file_idx_list_base0=file_idx_list_base1;
+              file_idx_list_base1=file_idx_list_base2;
             }
-            file_idx_idx1=file_idx_idx_list_base[file_idx_idx_idx];
-            file_idx_list_base1[file_idx_idx1]=file_idx;
-            file_idx_idx1++;
-            file_idx_idx_list_base[file_idx_idx_idx]=file_idx_idx1;
-            file_idx_idx0++;
-          }while(file_idx_idx0!=filename_count);
-          file_idx_list_base2=file_idx_list_base0;
-          file_idx_list_base0=file_idx_list_base1;
-          file_idx_list_base1=file_idx_list_base2;
-        }while(byte_idx--);
-        file_idx_idx0=0;
+/*
+Queue each run of equal keys for sorting on the next key, unless the key contains a null, in which case the filenames in the run are identical.
+*/
+            depth+=U64_SIZE;
+            file_idx_idx=file_idx_idx_min;
+            do{
+              key=key_list_base0[file_idx_idx];
+              file_idx_idx_new=file_idx_idx;
+              while((file_idx_idx_new!=file_idx_idx_max)&&(key_list_base0[file_idx_idx_new+1]==key)){
+                file_idx_idx_new++;
+              }
+              if((file_idx_idx_new!=file_idx_idx)&&((u8)(key))){
+                group_list_base[group_idx]=file_idx_idx;
+                group_list_base[group_idx+1]=file_idx_idx_new-file_idx_idx+1;
+                group_list_base[group_idx+2]=depth;
+                group_idx+=3;
+              }
+              file_idx_idx=file_idx_idx_new;
+            }while((file_idx_idx++)!=file_idx_idx_max);
+          }
+        }while(group_idx);
+        file_idx_idx=0;
         filename_list_char_idx1=0;
         do{
-          file_idx=file_idx_list_base0[file_idx_idx0];
+          file_idx=file_idx_list_base0[file_idx_idx];
           filename_list_char_idx0=filename_char_idx_list_base[file_idx];
           filename_size=filename_size_list_base[file_idx];
           filename_size++;
-          memcpy(&filename_list_base1[filename_list_char_idx1], &filename_list_base0[filename_list_char_idx0], (size_t)(filename_size));
+          memcpy(&filename_list_base1[filename_list_char_idx1], &filename_list_base[filename_list_char_idx0], (size_t)(filename_size));
           filename_list_char_idx1+=filename_size;
-          file_idx_idx0++;
-        }while(file_idx_idx0!=filename_count);
-        memcpy(filename_list_base0, filename_list_base1, (size_t)(filename_list_char_idx1));
+          file_idx_idx++;
+        }while(file_idx_idx!=filename_count);
+        memcpy(filename_list_base, filename_list_base1, (size_t)(filename_list_char_idx1));
       }
       DEBUG_FREE_PARANOID(filename_list_base1);
     }
+    DEBUG_FREE_PARANOID(key_list_base1);
+    DEBUG_FREE_PARANOID(key_list_base0);
+    DEBUG_FREE_PARANOID(group_list_base);
     DEBUG_FREE_PARANOID(filename_size_list_base);
     DEBUG_FREE_PARANOID(filename_char_idx_list_base);
     DEBUG_FREE_PARANOID(file_idx_list_base1);
@@ -1037,6 +1509,123 @@ Out:
   return status;
 }
 
+void *
+filesys_line_close(void *handle_base){
+/*
+Close a file or pipe opened by filesys_line_read().
+
+In:
+
+  handle_base is (Out:*handle_base_base) from filesys_line_read(), which may be NULL.
+
+Out:
+
+  Returns NULL so that the caller can easily update its handle.
+*/
+  if(handle_base){
+    fclose((FILE *)(handle_base));
+  }
+  return NULL;
+}
+
+u8
+filesys_line_read(ULONG char_idx_max, char *char_list_base, char *filename_base, void **handle_base_base){
+/*
+Read the next line of text from a file or named pipe, opening it first if need be. This allows a long-running process to accept requests from other processes via a pipe, from which it can read until all writers have closed it.
+
+In:
+
+  char_idx_max is one less than the maximum number of chars, including the terminating null, to write to *char_list_base.
+
+  *char_list_base is undefined.
+
+  *filename_base is the null-terminated path and filename.
+
+  *handle_base_base is NULL if the file isn't open, else (Out:*handle_base_base) from the previous call.
+
+Out:
+
+  Returns zero on success; FILESYS_STATUS_NOT_FOUND if the end of the file was reached before any chars were read; FILESYS_STATUS_TOO_BIG if the line didn't fit, in which case the rest of it has been discarded; or FILESYS_STATUS_READ_FAIL if the file couldn't be opened or read.
+
+  *char_list_base contains the line, without its terminating newline or carriage return, and followed by a null, if the return value was zero.
+
+  *handle_base_base is NULL if the file was closed, which occurs on any return value other than zero and FILESYS_STATUS_TOO_BIG. Otherwise it must eventually be passed to filesys_line_close() unless this function closes it first.
+*/
+  ULONG char_idx;
+  int char_int;
+  FILE *handle;
+  u8 status;
+
+  handle=(FILE *)(*handle_base_base);
+  status=FILESYS_STATUS_READ_FAIL;
+  if(!handle){
+    handle=fopen(filename_base, "rb");
+  }
+  if(handle){
+    char_idx=0;
+    char_int=fgetc(handle);
+    status=FILESYS_STATUS_NOT_FOUND;
+/*
+fgetc() returns EOF, which is negative, at the end of the file or on error, else an unsigned char.
+*/
+    if(0<=char_int){
+      status=0;
+      do{
+        if(char_int=='\n'){
+          break;
+        }
+        if(char_idx<char_idx_max){
+          char_list_base[char_idx]=(char)(char_int);
+          char_idx++;
+        }else{
+          status=FILESYS_STATUS_TOO_BIG;
+        }
+        char_int=fgetc(handle);
+      }while(0<=char_int);
+      if(char_idx&&(char_list_base[char_idx-1]=='\r')){
+        char_idx--;
+      }
+      char_list_base[char_idx]=0;
+    }
+    if(ferror(handle)){
+      status=FILESYS_STATUS_READ_FAIL;
+    }
+    if((status==FILESYS_STATUS_NOT_FOUND)||(status==FILESYS_STATUS_READ_FAIL)){
+      fclose(handle);
+      handle=NULL;
+    }
+  }
+  *handle_base_base=(void *)(handle);
+  return status;
+}
+
+u8
+filesys_pipe_status_get(char *filename_base){
+/*
+Determine whether or not a file is a named pipe, as opposed to a regular file, so that the caller can decide whether to wait for more data once all writers have closed it.
+
+In:
+
+  *filename_base is the null-terminated path and filename.
+
+Out:
+
+  Returns one if *filename_base is a named pipe, else zero, including if it doesn't exist. Always returns zero on Windows.
+*/
+  u8 status;
+  #ifndef WINDOWS
+    struct stat file_stat;
+  #endif
+
+  status=0;
+  #ifndef WINDOWS
+    if(!stat(filename_base, &file_stat)){
+      status=!!S_ISFIFO(file_stat.st_mode);
+    }
+  #endif
+  return status;
+}
+
 u8
 filesys_subfile_read_next(u8 direction_status, ULONG *filename_idx_base, char *filename_list_base, ULONG read_size, u64 read_u8_idx_min, void *void_list_base){
 /*
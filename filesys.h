@@ -19,7 +19,16 @@ You should have received a copy of the GNU Limited General Public
 License version 3 along with the Filesys Library (filename
 "COPYING"). If not, see http://www.gnu.org/licenses/ .
 */
+TYPEDEF_START
+  char *filename_list_base;
+  void *void_list_base;
+  ULONG file_size_max;
+  ULONG filename_idx;
+  u8 status;
+TYPEDEF_END(filesys_prefetch_t)
+
 #define FILESYS_DIRECTORY_DEPTH_IDX_MAX 0xFEU
+#define FILESYS_FILENAME_LIST_SORT_INSERTION_COUNT_MAX 0x10U
 #define FILESYS_PATHNAME_CHAR_IDX_MAX 0xFFFFU
 #define FILESYS_STATUS_OK 0U
 #define FILESYS_STATUS_NOT_FOUND 1U
@@ -20,20 +20,28 @@ License version 3 along with the Filesys Library (filename
 "COPYING"). If not, see http://www.gnu.org/licenses/ .
 */
 extern char *filesys_char_list_malloc(ULONG char_idx_max);
+extern char *filesys_char_list_realloc(ULONG char_idx_max, char *list_base);
+extern u8 filesys_file_append(ULONG file_size, char *filename_base, void *void_list_base);
+extern u8 filesys_file_delete(char *filename_base);
+extern u8 filesys_file_map(ULONG file_size, char *filename_base, void **map_base_base);
+extern u8 filesys_file_map_sync(ULONG file_size, void *map_base);
 extern u8 filesys_file_read(ULONG *file_size_max_base, char *filename_base, void *void_list_base);
 extern u8 filesys_file_read_exact(ULONG file_size, char *filename_base, void *void_list_base);
 extern u8 filesys_file_read_next(ULONG *file_size_max_base, ULONG *filename_idx_base, char *filename_list_base, void *void_list_base);
+extern void *filesys_file_read_next_thread(void *thread_base);
 extern u8 filesys_file_size_get(u64 *file_size_base, char *filename_base);
 #ifdef _64_
   #define filesys_file_size_ulong_get filesys_file_size_get
 #else
   extern u8 filesys_file_size_ulong_get(ULONG *file_size_base, char *filename_base);
 #endif
+extern u8 filesys_file_unmap(ULONG file_size, void *map_base);
 extern u8 filesys_file_write(ULONG file_size, char *filename_base, void *void_list_base);
+extern u8 filesys_file_write_durable(ULONG file_size, char *filename_base, void *void_list_base);
 extern u8 filesys_file_write_next_obnoxious(ULONG file_size, ULONG *filename_idx_base, char *filename_list_base, void *void_list_base);
 extern u8 filesys_file_write_obnoxious(ULONG file_size, char *filename_base, void *void_list_base);
 extern ULONG filesys_filename_isolate(ULONG *filename_idx_min_base, char *filename_list_base);
-extern u8 filesys_filename_list_get(u8 *fatal_status_base, ULONG *file_size_max_base, u8 *file_status_base, ULONG *filename_count_base, char *filename_list_base, ULONG *filename_list_size_max_base, char *target_base);
+extern u8 filesys_filename_list_get(ULONG *file_size_max_base, u8 *file_status_base, ULONG *filename_count_base, char **filename_list_base_base, ULONG *filename_list_size_max_base, char *target_base);
 extern void filesys_filename_list_morph(ULONG filename_count, char *source_base, char *source_filename_list_base, char *target_base, char *target_filename_list_base);
 extern ULONG filesys_filename_list_morph_size_get(ULONG filename_count, char *filename_list_base, char *source_base, char *target_base);
 extern u8 filesys_filename_list_sort(ULONG filename_count, char *filename_list_base);
@@ -41,4 +49,7 @@ extern void *filesys_free(void *base);
 extern ULONG filesys_hull_size_get(ULONG size_projected);
 extern ULONG filesys_hull_size_get(ULONG size_projected);
 extern u8 filesys_init(u32 build_break_count, u32 build_feature_count);
+extern void *filesys_line_close(void *handle_base);
+extern u8 filesys_line_read(ULONG char_idx_max, char *char_list_base, char *filename_base, void **handle_base_base);
+extern u8 filesys_pipe_status_get(char *filename_base);
 extern u8 filesys_subfile_read_next(u8 direction_status, ULONG *filename_idx_base, char *filename_list_base, ULONG read_size, u64 read_u8_idx_min, void *void_list_base);
@@ -26,4 +26,4 @@ Agnentro Find Version Info
 /*
 BUILD_ID must increase with every code release, even if only a comment changes. It allows the user to discern one build from another, but is invisible to other libraries. If this library depends on other libraries, then it should be expressed as the sum of the local build ID plus the build IDs of those libraries, and in any event must increase monotonically even if some of the latter are removed.
 */
-#define AGNENTROFIND_BUILD_ID (13+AGNENTROPROX_BUILD_ID+ASCII_BUILD_ID+FILESYS_BUILD_ID+FRU128_BUILD_ID+FRU64_BUILD_ID+LOGGAMMA_BUILD_ID+MASKOPS_BUILD_ID)
+#define AGNENTROFIND_BUILD_ID (24+AGNENTROPROX_BUILD_ID+ASCII_BUILD_ID+FILESYS_BUILD_ID+FRU128_BUILD_ID+FRU64_BUILD_ID+LOGGAMMA_BUILD_ID+MASKOPS_BUILD_ID+THREAD_BUILD_ID)
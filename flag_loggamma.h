@@ -41,8 +41,8 @@ This value is set to the number of features added to the source code of this lib
 
 This value should NOT be used by any library other than this one; doing so could require this library to support more features than the caller actually needs. Instead, source code should hardcode a constant parameter to the call to the initialization code (for this library) which conveys the minimum required value of this count.
 */
-#define LOGGAMMA_BUILD_FEATURE_COUNT (0+BIGUINT_BUILD_FEATURE_COUNT+FRU128_BUILD_FEATURE_COUNT)
+#define LOGGAMMA_BUILD_FEATURE_COUNT (1+BIGUINT_BUILD_FEATURE_COUNT+FRU128_BUILD_FEATURE_COUNT)
 /*
 BUILD_ID must increase with every code release, even if only a comment changes. It allows the user to discern one build from another, but is invisible to other libraries. If this library depends on other libraries, then it should be expressed as the sum of the local build ID plus the build IDs of those libraries, and in any event must increase monotonically even if some of the latter are removed.
 */
-#define LOGGAMMA_BUILD_ID (5+BIGUINT_BUILD_ID+FRU128_BUILD_ID)
+#define LOGGAMMA_BUILD_ID (8+BIGUINT_BUILD_ID+FRU128_BUILD_ID)
@@ -29,8 +29,8 @@ This value is set to the sum of breakage events in the source code of this libra
 
 When calling the initialization code for this library, always use the corresponding constant ending in "_EXPECTED". This will force a runtime error, in addition to a build error below, if the programmer fails to notice subordinate build breakages which may affect the correctness of transactions with this library.
 */
-#define MASKOPS_BUILD_BREAK_COUNT 0
-#define MASKOPS_BUILD_BREAK_COUNT_EXPECTED 0
+#define MASKOPS_BUILD_BREAK_COUNT (0+THREAD_BUILD_BREAK_COUNT)
+#define MASKOPS_BUILD_BREAK_COUNT_EXPECTED 1
 #if MASKOPS_BUILD_BREAK_COUNT!=MASKOPS_BUILD_BREAK_COUNT_EXPECTED
   #error MaskOps is unaware of the latest non-backward-compatible changes to the libraries that it uses.
 #endif
@@ -41,8 +41,8 @@ This value is set to the number of features added to the source code of this lib
 
 This value should NOT be used by any library other than this one; doing so could require this library to support more features than the caller actually needs. Instead, source code should hardcode a constant parameter to the call to the initialization code (for this library) which conveys the minimum required value of this count.
 */
-#define MASKOPS_BUILD_FEATURE_COUNT 0
+#define MASKOPS_BUILD_FEATURE_COUNT (3+THREAD_BUILD_FEATURE_COUNT)
 /*
 BUILD_ID must increase with every code release, even if only a comment changes. It allows the user to discern one build from another, but is invisible to other libraries. If this library depends on other libraries, then it should be expressed as the sum of the local build ID plus the build IDs of those libraries, and in any event must increase monotonically even if some of the latter are removed.
 */
-#define MASKOPS_BUILD_ID 2
+#define MASKOPS_BUILD_ID (7+THREAD_BUILD_ID)
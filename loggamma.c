@@ -494,3 +494,90 @@ Out:
   *a_base=a;
   return status;
 }
+
+u8
+loggamma_u64_list(fru128 *a_list_base, loggamma_t *loggamma_base, ULONG loggamma_idx_max, fru128 *loggamma_list_base, u64 *loggamma_parameter_list_base, ULONG v_idx_max, u64 *v_list_base){
+/*
+Compute the loggammas of a list of (u64)s. This is much faster than calling loggamma_u64() for each of them if the list contains runs of consecutive values, such as the frequencies of nonzero population in a histogram, sorted ascending. Each such run is seeded by a cached result or a single evaluation of Stirling's series, then continued via the recurrence (loggamma(v+1)=loggamma(v)+log(v)), with a fresh seed every LOGGAMMA_LIST_RUN_MAX values so that error accumulation remains trivial. Repeated values are evaluated only once.
+
+In:
+
+  *a_list_base is undefined and writable for (v_idx_max+1) items.
+
+  loggamma_base is the return value of loggamma_init().
+
+  loggamma_idx_max is loggamma_u64_cache_init():In:loggamma_idx_max. Ignored if loggamma_parameter_list_base is NULL.
+
+  loggamma_list_base is loggamma_u64_cache_init():Out:*loggamma_list_base_base. Ignored if loggamma_parameter_list_base is NULL.
+
+  loggamma_parameter_list_base is NULL to bypass the cache, else the return value of loggamma_u64_cache_init().
+
+  v_idx_max is the number of items at v_list_base, less one.
+
+  v_list_base is the base of (v_idx_max+1) values, each of which is as defined in loggamma_u64():In:v.
+
+Out:
+
+  Returns zero if all values at v_list_base were in the required domain, else one.
+
+  *a_list_base is the list of fractervals corresponding to v_list_base, each as defined in loggamma_u64():Out:*a_base, except that those obtained via the recurrence may be slightly wider.
+
+  The cache, if any, has been updated with the seeds, but not with the results of the recurrence, so that it only ever contains the results of loggamma_u64().
+*/
+  fru128 a;
+  u8 cache_status;
+  ULONG idx;
+  fru128 log;
+  ULONG run_count;
+  u8 status;
+  u8 status_old;
+  u64 v;
+  ULONG v_idx;
+  u64 v_old;
+
+  idx=0;
+  run_count=0;
+  status=0;
+  status_old=1;
+  v_idx=0;
+  v_old=0;
+  do{
+    v=v_list_base[v_idx];
+    cache_status=0;
+    if(loggamma_parameter_list_base){
+      idx=loggamma_idx_max&(ULONG)(v);
+      cache_status=(loggamma_parameter_list_base[idx]==v);
+    }
+    if(cache_status){
+      a=loggamma_list_base[idx];
+      status_old=(LOGGAMMA_PARAMETER_MAX<=(v-1U));
+      run_count=0;
+    }else if((v==v_old)&&!status_old){
+      a=a_list_base[v_idx-1];
+    }else if((0x1F<v_old)&&(v==(v_old+1))&&(run_count<LOGGAMMA_LIST_RUN_MAX)&&!status_old){
+/*
+v_old is on [0x20, LOGGAMMA_PARAMETER_MAX], so its log is nonzero and its 64.64 fixed-point version can't overflow the sum. v itself might exceed LOGGAMMA_PARAMETER_MAX, however, which we check for in order to be consistent with loggamma_u64().
+*/
+      a=a_list_base[v_idx-1];
+      FRU128_LOG_U64(log, v_old, status_old);
+      FRU128_SHIFT_RIGHT_SELF(log, U128_BITS-U64_BITS_LOG2-U64_BITS);
+      FRU128_ADD_FRU128_SELF(a, log, status_old);
+      status_old=(u8)(status_old|(LOGGAMMA_PARAMETER_MAX<v));
+      if(status_old){
+        FRU128_SET_AMBIGUOUS(a);
+      }
+      run_count++;
+    }else{
+      status_old=loggamma_u64(&a, loggamma_base, v);
+      run_count=0;
+      if(loggamma_parameter_list_base){
+        loggamma_list_base[idx]=a;
+        loggamma_parameter_list_base[idx]=v;
+      }
+    }
+    a_list_base[v_idx]=a;
+    status=(u8)(status|status_old);
+    v_old=v;
+  }while((v_idx++)!=v_idx_max);
+  return status;
+}
@@ -91,6 +91,7 @@ TYPEDEF_END(loggamma_t)
 #define LOGGAMMA_1F_HI 0x4AU
 #define LOGGAMMA_1F_LO 0xA8822D674395C25AULL
 #define LOGGAMMA_COEFF_IDX_MAX 26
+#define LOGGAMMA_LIST_RUN_MAX 0x3FU
 #define LOGGAMMA_LOG_2PI_HALF 0xEB3F8E4325F5A534ULL
 #define LOGGAMMA_PARAMETER_MAX 0x64BF406864B4305ULL
 
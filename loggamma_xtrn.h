@@ -26,3 +26,4 @@ extern loggamma_t *loggamma_init(u32 build_break_count, u32 build_feature_count)
 extern u8 loggamma_u64(fru128 *a_base, loggamma_t *loggamma_base, u64 v);
 extern u64 *loggamma_u64_cache_init(ULONG loggamma_idx_max, fru128 **loggamma_list_base_base);
 extern u8 loggamma_u64_cached(fru128 *a_base, loggamma_t *loggamma_base, ULONG loggamma_idx_max, fru128 *loggamma_list_base, u64 *loggamma_parameter_list_base, u64 v);
+extern u8 loggamma_u64_list(fru128 *a_list_base, loggamma_t *loggamma_base, ULONG loggamma_idx_max, fru128 *loggamma_list_base, u64 *loggamma_parameter_list_base, ULONG v_idx_max, u64 *v_list_base);
@@ -23,6 +23,7 @@ License version 3 along with the MaskOps Library (filename
 Mask List Functions
 */
 #include "flag.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include <stdint.h>
 #include <stdlib.h>
@@ -32,6 +33,8 @@ Mask List Functions
 #include "debug_xtrn.h"
 #include "maskops.h"
 #include "maskops_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 
 ULONG *
 maskops_bitmap_malloc(u64 msb){
@@ -88,6 +91,7 @@ Out:
 
   *mask_list_base is as described in In:direction_status.
 */
+  u64 lane_msb_mask;
   u32 mask;
   u32 mask_max;
   u32 mask_old;
@@ -96,11 +100,16 @@ Out:
   u32 u8_idx_delta;
   ULONG u8_idx_max;
 
+  u8_idx_delta=(u8)(granularity+1);
+  u8_idx_max=mask_idx_max*u8_idx_delta;
+  lane_msb_mask=maskops_lane_msb_mask_get(channel_status, direction_status, granularity);
+  if(lane_msb_mask){
+    maskops_deltafy_u64(direction_status, lane_msb_mask, mask_list_base, (u8)(u8_idx_delta), u8_idx_max+u8_idx_delta-1);
+    return;
+  }
   mask_max=(1U<<(granularity<<U8_BITS_LOG2)<<U8_BITS)-1;
   mask_old=0;
   u8_idx=0;
-  u8_idx_delta=(u8)(granularity+1);
-  u8_idx_max=mask_idx_max*u8_idx_delta;
   do{
     mask=mask_list_base[u8_idx];
     if(granularity){
@@ -153,6 +162,95 @@ Out:
   return;
 }
 
+void
+maskops_deltafy_u64(u8 direction_status, u64 lane_msb_mask, u8 *mask_list_base, u8 u8_idx_delta, ULONG u8_idx_max){
+/*
+Don't call here directly. This is a helper for maskops_deltafy().
+
+Perform the equivalent of maskops_deltafy() 8 bytes at a time, treating a u64 as parallel lanes which are either individual channels or entire masks. Differences are computed lanewise without carries crossing between lanes. Undeltafication is a prefix sum, so each u64 is summed in log2 steps in register, then the final masks of the previous u64 are added to all of its lanes.
+
+In:
+
+  direction_status is as defined in maskops_deltafy().
+
+  lane_msb_mask has only the high bit of each lane set, where lanes are bytes (0x8080808080808080ULL), (u16)s, or (u32)s. Unless the lanes are bytes and direction_status is one, the machine must be little endian.
+
+  *mask_list_base is as defined in maskops_deltafy().
+
+  u8_idx_delta is the mask size in bytes, on [1, U32_SIZE], which is also the distance between corresponding lanes of successive masks.
+
+  u8_idx_max is the index of the last byte of the last whole mask.
+
+Out:
+
+  *mask_list_base is as defined in maskops_deltafy().
+*/
+  u64 carry;
+  u8 carry_shift;
+  u64 lane_rest_mask;
+  u64 mask_u64;
+  u64 mask_u64_old;
+  u8 shift;
+  ULONG u8_count;
+  ULONG u8_idx;
+
+  lane_rest_mask=~lane_msb_mask;
+  u8_count=u8_idx_max+1;
+  if(direction_status){
+/*
+Go backwards so that the subtrahend of each difference remains intact until we're done with it. The first mask has an implied zero predecessor, so it doesn't change.
+*/
+    u8_idx=u8_count;
+    while((u8_idx_delta+U64_SIZE)<=u8_idx){
+      u8_idx-=U64_SIZE;
+      memcpy(&mask_u64, &mask_list_base[u8_idx], (size_t)(U64_SIZE));
+      memcpy(&mask_u64_old, &mask_list_base[u8_idx-u8_idx_delta], (size_t)(U64_SIZE));
+      mask_u64=((mask_u64|lane_msb_mask)-(mask_u64_old&lane_rest_mask))^((mask_u64^~mask_u64_old)&lane_msb_mask);
+      memcpy(&mask_list_base[u8_idx], &mask_u64, (size_t)(U64_SIZE));
+    }
+    u8_count=u8_idx-u8_idx_delta;
+    if(u8_count){
+      mask_u64=0;
+      mask_u64_old=0;
+      memcpy(&mask_u64, &mask_list_base[u8_idx_delta], (size_t)(u8_count));
+      memcpy(&mask_u64_old, mask_list_base, (size_t)(u8_count));
+      mask_u64=((mask_u64|lane_msb_mask)-(mask_u64_old&lane_rest_mask))^((mask_u64^~mask_u64_old)&lane_msb_mask);
+      memcpy(&mask_list_base[u8_idx_delta], &mask_u64, (size_t)(u8_count));
+    }
+  }else{
+/*
+Keep the final masks of each u64 in carry for the next one, as opposed to reloading them, which would stall on the previous store.
+*/
+    carry=0;
+    memcpy(&carry, mask_list_base, (size_t)(u8_idx_delta));
+    carry_shift=(u8)(U64_BITS-(u8_idx_delta<<U8_BITS_LOG2));
+    u8_idx=u8_idx_delta;
+    while(u8_idx<u8_count){
+      mask_u64=0;
+      if((u8_idx+U64_SIZE)<=u8_count){
+        memcpy(&mask_u64, &mask_list_base[u8_idx], (size_t)(U64_SIZE));
+      }else{
+        memcpy(&mask_u64, &mask_list_base[u8_idx], (size_t)(u8_count-u8_idx));
+      }
+      shift=(u8)(u8_idx_delta<<U8_BITS_LOG2);
+      do{
+        mask_u64=((mask_u64&lane_rest_mask)+((mask_u64<<shift)&lane_rest_mask))^((mask_u64^(mask_u64<<shift))&lane_msb_mask);
+        carry|=carry<<shift;
+        shift=(u8)(shift<<1);
+      }while(shift<U64_BITS);
+      mask_u64=((mask_u64&lane_rest_mask)+(carry&lane_rest_mask))^((mask_u64^carry)&lane_msb_mask);
+      if((u8_idx+U64_SIZE)<=u8_count){
+        memcpy(&mask_list_base[u8_idx], &mask_u64, (size_t)(U64_SIZE));
+      }else{
+        memcpy(&mask_list_base[u8_idx], &mask_u64, (size_t)(u8_count-u8_idx));
+      }
+      carry=mask_u64>>carry_shift;
+      u8_idx+=U64_SIZE;
+    }
+  }
+  return;
+}
+
 void
 maskops_densify(u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_min, u32 *remask_list_base){
 /*
@@ -303,6 +401,234 @@ Most of the time we can improve performance by not writing back unnecessarily.
   return;
 }
 
+void
+maskops_densify_bitmap_prepare_parallel(ULONG *bitmap_base, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_max, u32 mask_min, u8 reset_status, u32 thread_idx_max){
+/*
+Do the same thing as maskops_densify_bitmap_prepare(), but using multiple threads. Each thread marks a slice of the mask list into its own bitmap, then the bitmaps are ORed together in parallel slices. Private bitmaps are only allocated to the extent that they fit within MASKOPS_THREAD_BITMAP_SIZE_MAX bytes in total, so this may end up running on fewer threads, or just one, for large mask spans.
+
+In:
+
+  All inputs are as defined in maskops_densify_bitmap_prepare(), except:
+
+  thread_idx_max is one less than the maximum number of threads to use, on [0, THREAD_COUNT_MAX-1], usually (thread_count_get()-1).
+
+Out:
+
+  *bitmap_base is as defined in maskops_densify_bitmap_prepare():Out:*bitmap_base.
+*/
+  ULONG *bitmap_base_list_base[THREAD_COUNT_MAX];
+  ULONG bitmap_size;
+  ULONG chunk_count;
+  ULONG chunk_idx_max;
+  ULONG mask_count;
+  ULONG slice_size;
+  u32 thread_idx;
+  u32 thread_idx_max_max;
+  maskops_thread_t thread_list_base[THREAD_COUNT_MAX];
+
+  chunk_idx_max=(mask_max-mask_min)>>ULONG_BITS_LOG2;
+  bitmap_size=(chunk_idx_max+1)<<ULONG_SIZE_LOG2;
+  mask_count=mask_idx_max+1;
+  thread_idx_max_max=(u32)(MIN(mask_count/MASKOPS_THREAD_ITEM_COUNT_MIN, (ULONG)(MASKOPS_THREAD_BITMAP_SIZE_MAX/bitmap_size)+1));
+  thread_idx_max=MIN(thread_idx_max, thread_idx_max_max ? thread_idx_max_max-1 : 0);
+/*
+Allocate the private bitmaps. Each thread will zero its own, which is faster than doing so here.
+*/
+  thread_idx=1;
+  while(thread_idx<=thread_idx_max){
+    bitmap_base_list_base[thread_idx]=maskops_bitmap_malloc((u64)(mask_max-mask_min));
+    if(!bitmap_base_list_base[thread_idx]){
+      thread_idx_max=thread_idx-1;
+    }
+    thread_idx++;
+  }
+  if(!thread_idx_max){
+    maskops_densify_bitmap_prepare(bitmap_base, granularity, mask_idx_max, mask_list_base, mask_max, mask_min, reset_status);
+  }else{
+    bitmap_base_list_base[0]=bitmap_base;
+    slice_size=mask_count/(thread_idx_max+1);
+    thread_idx=0;
+    do{
+      thread_list_base[thread_idx].bitmap_base=bitmap_base_list_base[thread_idx];
+      thread_list_base[thread_idx].mask_idx_max=slice_size-1;
+      thread_list_base[thread_idx].mask_list_base=&mask_list_base[thread_idx*slice_size*(granularity+1U)];
+      thread_list_base[thread_idx].mask_max=mask_max;
+      thread_list_base[thread_idx].mask_min=mask_min;
+      thread_list_base[thread_idx].granularity=granularity;
+      thread_list_base[thread_idx].reset_status=(u8)(reset_status|(!!thread_idx));
+    }while((thread_idx++)!=thread_idx_max);
+    thread_list_base[thread_idx_max].mask_idx_max=mask_idx_max-(thread_idx_max*slice_size);
+    thread_list_run(&maskops_densify_bitmap_prepare_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(maskops_thread_t)), thread_idx_max);
+/*
+OR the private bitmaps into *bitmap_base, with each thread responsible for a slice of chunks.
+*/
+    chunk_count=chunk_idx_max+1;
+    thread_idx_max_max=(u32)(MIN((ULONG)(thread_idx_max), chunk_count-1));
+    slice_size=chunk_count/(thread_idx_max_max+1);
+    thread_idx=0;
+    do{
+      thread_list_base[thread_idx].bitmap_base=bitmap_base;
+      thread_list_base[thread_idx].bitmap_base_list_base=bitmap_base_list_base;
+      thread_list_base[thread_idx].bitmap_idx_max=thread_idx_max;
+      thread_list_base[thread_idx].chunk_idx_min=thread_idx*slice_size;
+      thread_list_base[thread_idx].chunk_idx_max=((thread_idx+1)*slice_size)-1;
+    }while((thread_idx++)!=thread_idx_max_max);
+    thread_list_base[thread_idx_max_max].chunk_idx_max=chunk_idx_max;
+    thread_list_run(&maskops_densify_bitmap_reduce_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(maskops_thread_t)), thread_idx_max_max);
+    thread_idx=thread_idx_max;
+    do{
+      maskops_free(bitmap_base_list_base[thread_idx]);
+    }while((--thread_idx)!=0);
+  }
+  return;
+}
+
+void *
+maskops_densify_bitmap_prepare_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for maskops_densify_bitmap_prepare_parallel().
+
+In:
+
+  *thread_base is a maskops_thread_t containing the inputs to maskops_densify_bitmap_prepare().
+
+Out:
+
+  Returns NULL.
+*/
+  maskops_thread_t *thread_base_u;
+
+  thread_base_u=(maskops_thread_t *)(thread_base);
+  maskops_densify_bitmap_prepare(thread_base_u->bitmap_base, thread_base_u->granularity, thread_base_u->mask_idx_max, thread_base_u->mask_list_base, thread_base_u->mask_max, thread_base_u->mask_min, thread_base_u->reset_status);
+  return NULL;
+}
+
+void *
+maskops_densify_bitmap_reduce_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for maskops_densify_bitmap_prepare_parallel().
+
+OR a slice of each private bitmap into the primary one.
+
+In:
+
+  *thread_base is a maskops_thread_t in which bitmap_base is the primary bitmap, (*bitmap_base_list_base)[1] through (*bitmap_base_list_base)[bitmap_idx_max] are the private bitmaps, and [chunk_idx_min, chunk_idx_max] is the slice of (ULONG)s to process.
+
+Out:
+
+  Returns NULL.
+
+  The slice of *bitmap_base has been ORed with the same slice of all private bitmaps.
+*/
+  ULONG *bitmap_base;
+  ULONG *bitmap_base1;
+  u32 bitmap_idx;
+  u32 bitmap_idx_max;
+  ULONG chunk;
+  ULONG chunk_idx;
+  ULONG chunk_idx_max;
+  ULONG chunk_idx_min;
+  maskops_thread_t *thread_base_u;
+
+  thread_base_u=(maskops_thread_t *)(thread_base);
+  bitmap_base=thread_base_u->bitmap_base;
+  bitmap_idx_max=thread_base_u->bitmap_idx_max;
+  chunk_idx_max=thread_base_u->chunk_idx_max;
+  chunk_idx_min=thread_base_u->chunk_idx_min;
+  bitmap_idx=1;
+  do{
+    bitmap_base1=thread_base_u->bitmap_base_list_base[bitmap_idx];
+    chunk_idx=chunk_idx_min;
+    do{
+      chunk=bitmap_base[chunk_idx]|bitmap_base1[chunk_idx];
+      bitmap_base[chunk_idx]=chunk;
+    }while((chunk_idx++)!=chunk_idx_max);
+  }while((bitmap_idx++)!=bitmap_idx_max);
+  return NULL;
+}
+
+void
+maskops_densify_parallel(u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_min, u32 *remask_list_base, u32 thread_idx_max){
+/*
+Do the same thing as maskops_densify(), but using multiple threads, each of which remaps a slice of the mask list.
+
+In:
+
+  All inputs are as defined in maskops_densify(), except:
+
+  thread_idx_max is as defined in maskops_densify_bitmap_prepare_parallel().
+
+Out:
+
+  *mask_list_base is as defined in maskops_densify():Out:*mask_list_base.
+*/
+  ULONG mask_count;
+  ULONG slice_size;
+  u32 thread_idx;
+  u32 thread_idx_max_max;
+  maskops_thread_t thread_list_base[THREAD_COUNT_MAX];
+
+  mask_count=mask_idx_max+1;
+  thread_idx_max_max=(u32)(MIN(mask_count/MASKOPS_THREAD_ITEM_COUNT_MIN, (ULONG)(THREAD_COUNT_MAX)));
+  thread_idx_max=MIN(thread_idx_max, thread_idx_max_max ? thread_idx_max_max-1 : 0);
+  slice_size=mask_count/(thread_idx_max+1);
+  thread_idx=0;
+  do{
+    thread_list_base[thread_idx].mask_idx_max=slice_size-1;
+    thread_list_base[thread_idx].mask_list_base=&mask_list_base[thread_idx*slice_size*(granularity+1U)];
+    thread_list_base[thread_idx].remask_list_base=remask_list_base;
+    thread_list_base[thread_idx].mask_min=mask_min;
+    thread_list_base[thread_idx].direction_status=direction_status;
+    thread_list_base[thread_idx].granularity=granularity;
+  }while((thread_idx++)!=thread_idx_max);
+  thread_list_base[thread_idx_max].mask_idx_max=mask_idx_max-(thread_idx_max*slice_size);
+  thread_list_run(&maskops_densify_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(maskops_thread_t)), thread_idx_max);
+  return;
+}
+
+void *
+maskops_densify_remask_count_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for maskops_densify_remask_prepare_parallel().
+
+Count the masks in use in a slice of a mask utilization footprint.
+
+In:
+
+  *thread_base is a maskops_thread_t in which bitmap_base is the mask utilization footprint and [chunk_idx_min, chunk_idx_max] is the slice of (ULONG)s to process.
+
+Out:
+
+  Returns NULL.
+
+  *thread_base has pop set to the number of ones in the slice.
+*/
+  ULONG *bitmap_base;
+  u64 chunk;
+  ULONG chunk_idx;
+  ULONG chunk_idx_max;
+  ULONG pop;
+  maskops_thread_t *thread_base_u;
+
+  thread_base_u=(maskops_thread_t *)(thread_base);
+  bitmap_base=thread_base_u->bitmap_base;
+  chunk_idx=thread_base_u->chunk_idx_min;
+  chunk_idx_max=thread_base_u->chunk_idx_max;
+  pop=0;
+  do{
+/*
+Count the ones in parallel within each chunk.
+*/
+    chunk=bitmap_base[chunk_idx];
+    chunk-=(chunk>>1)&0x5555555555555555ULL;
+    chunk=(chunk&0x3333333333333333ULL)+((chunk>>2)&0x3333333333333333ULL);
+    chunk=(chunk+(chunk>>4))&0x0F0F0F0F0F0F0F0FULL;
+    pop+=(ULONG)((chunk*0x0101010101010101ULL)>>(U64_BITS-U8_BITS));
+  }while((chunk_idx++)!=chunk_idx_max);
+  thread_base_u->pop=pop;
+  return NULL;
+}
+
 u32
 maskops_densify_remask_prepare(ULONG *bitmap_base, u8 direction_status, u32 mask_max, u32 mask_min, u32 *remask_list_base){
 /*
@@ -359,6 +685,138 @@ Convert the mask utilization footprint into a mask translation list.
   return mask_max;
 }
 
+u32
+maskops_densify_remask_prepare_parallel(ULONG *bitmap_base, u8 direction_status, u32 mask_max, u32 mask_min, u32 *remask_list_base, u32 thread_idx_max){
+/*
+Do the same thing as maskops_densify_remask_prepare(), but using multiple threads. Each thread first counts the ones in its slice of the mask utilization footprint. The prefix sums of those counts then tell each thread where to start numbering the densified masks in its slice.
+
+In:
+
+  All inputs are as defined in maskops_densify_remask_prepare(), except:
+
+  thread_idx_max is as defined in maskops_densify_bitmap_prepare_parallel().
+
+Out:
+
+  Returns as defined for maskops_densify_remask_prepare().
+
+  *remask_list_base is as defined in maskops_densify_remask_prepare():Out:*remask_list_base.
+*/
+  ULONG chunk_count;
+  ULONG chunk_idx_max;
+  ULONG pop;
+  ULONG pop_sum;
+  ULONG slice_size;
+  u32 thread_idx;
+  u32 thread_idx_max_max;
+  maskops_thread_t thread_list_base[THREAD_COUNT_MAX];
+
+  chunk_idx_max=(mask_max-mask_min)>>ULONG_BITS_LOG2;
+  chunk_count=chunk_idx_max+1;
+  thread_idx_max_max=(u32)(MIN(chunk_count/MASKOPS_THREAD_ITEM_COUNT_MIN, (ULONG)(THREAD_COUNT_MAX)));
+  thread_idx_max=MIN(thread_idx_max, thread_idx_max_max ? thread_idx_max_max-1 : 0);
+  if(!thread_idx_max){
+    mask_max=maskops_densify_remask_prepare(bitmap_base, direction_status, mask_max, mask_min, remask_list_base);
+  }else{
+    slice_size=chunk_count/(thread_idx_max+1);
+    thread_idx=0;
+    do{
+      thread_list_base[thread_idx].bitmap_base=bitmap_base;
+      thread_list_base[thread_idx].chunk_idx_min=thread_idx*slice_size;
+      thread_list_base[thread_idx].chunk_idx_max=((thread_idx+1)*slice_size)-1;
+      thread_list_base[thread_idx].remask_list_base=remask_list_base;
+      thread_list_base[thread_idx].direction_status=direction_status;
+    }while((thread_idx++)!=thread_idx_max);
+    thread_list_base[thread_idx_max].chunk_idx_max=chunk_idx_max;
+    thread_list_run(&maskops_densify_remask_count_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(maskops_thread_t)), thread_idx_max);
+    pop_sum=0;
+    thread_idx=0;
+    do{
+      pop=thread_list_base[thread_idx].pop;
+      thread_list_base[thread_idx].pop=pop_sum;
+      pop_sum+=pop;
+    }while((thread_idx++)!=thread_idx_max);
+    thread_list_run(&maskops_densify_remask_prepare_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(maskops_thread_t)), thread_idx_max);
+    mask_max=(u32)(pop_sum-1);
+  }
+  return mask_max;
+}
+
+void *
+maskops_densify_remask_prepare_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for maskops_densify_remask_prepare_parallel().
+
+Fill the part of a mask translation list corresponding to a slice of a mask utilization footprint.
+
+In:
+
+  *thread_base is a maskops_thread_t in which bitmap_base is the mask utilization footprint, [chunk_idx_min, chunk_idx_max] is the slice of (ULONG)s to process, direction_status and remask_list_base are as defined in maskops_densify_remask_prepare(), and pop is the number of ones in all previous slices.
+
+Out:
+
+  Returns NULL.
+
+  *remask_list_base is updated in a manner consistent with maskops_densify_remask_prepare().
+*/
+  ULONG *bitmap_base;
+  ULONG chunk;
+  ULONG chunk_idx;
+  ULONG chunk_idx_max;
+  u8 direction_status;
+  u32 mask;
+  u32 mask_new;
+  u32 *remask_list_base;
+  maskops_thread_t *thread_base_u;
+
+  thread_base_u=(maskops_thread_t *)(thread_base);
+  bitmap_base=thread_base_u->bitmap_base;
+  chunk_idx=thread_base_u->chunk_idx_min;
+  chunk_idx_max=thread_base_u->chunk_idx_max;
+  direction_status=thread_base_u->direction_status;
+  remask_list_base=thread_base_u->remask_list_base;
+  mask=(u32)(chunk_idx<<ULONG_BITS_LOG2);
+  mask_new=(u32)(thread_base_u->pop);
+  do{
+    chunk=bitmap_base[chunk_idx];
+    do{
+      if(chunk&1){
+        if(direction_status){
+          remask_list_base[mask]=mask_new;
+        }else{
+          remask_list_base[mask_new]=mask;
+        }
+        mask_new++;
+      }
+      chunk>>=1;
+      mask++;
+    }while(chunk);
+    mask+=ULONG_BIT_MAX;
+    mask&=~ULONG_BIT_MAX;
+  }while((chunk_idx++)!=chunk_idx_max);
+  return NULL;
+}
+
+void *
+maskops_densify_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for maskops_densify_parallel().
+
+In:
+
+  *thread_base is a maskops_thread_t containing the inputs to maskops_densify().
+
+Out:
+
+  Returns NULL.
+*/
+  maskops_thread_t *thread_base_u;
+
+  thread_base_u=(maskops_thread_t *)(thread_base);
+  maskops_densify(thread_base_u->direction_status, thread_base_u->granularity, thread_base_u->mask_idx_max, thread_base_u->mask_list_base, thread_base_u->mask_min, thread_base_u->remask_list_base);
+  return NULL;
+}
+
 void *
 maskops_free(void *base){
 /*
@@ -400,6 +858,44 @@ Out:
   return status;
 }
 
+u64
+maskops_lane_msb_mask_get(u8 channel_status, u8 direction_status, u8 granularity){
+/*
+Determine whether maskops_deltafy() can process a mask list 8 bytes at a time, and if so, how to divide a u64 into lanes. This is possible when the lanes line up with either channels or entire masks. Byte lanes work regardless of endianness when taking deltas, but wider lanes, as well as the shifts required for undeltafication, require a little endian machine, which we can only discover at runtime without platform-specific headers.
+
+In:
+
+  channel_status is as defined in maskops_deltafy().
+
+  direction_status is as defined in maskops_deltafy().
+
+  granularity is as defined in maskops_deltafy().
+
+Out:
+
+  Returns zero if maskops_deltafy() must process one mask at a time, else maskops_deltafy_u64():In:lane_msb_mask.
+*/
+  u64 lane_msb_mask;
+  u8 little_endian_status;
+  u32 one;
+
+  one=1;
+  memcpy(&little_endian_status, &one, (size_t)(U8_SIZE));
+  lane_msb_mask=0;
+  if(direction_status||little_endian_status){
+    if(channel_status||!granularity){
+      lane_msb_mask=0x8080808080808080ULL;
+    }else if(little_endian_status){
+      if(granularity==U16_BYTE_MAX){
+        lane_msb_mask=0x8000800080008000ULL;
+      }else if(granularity==U32_BYTE_MAX){
+        lane_msb_mask=0x8000000080000000ULL;
+      }
+    }
+  }
+  return lane_msb_mask;
+}
+
 u8 *
 maskops_mask_list_malloc(u8 granularity, ULONG mask_idx_max){
 /*
@@ -578,6 +1074,300 @@ Out:
   return mask_min;
 }
 
+u32
+maskops_pipeline(ULONG *bitmap_base, u8 channel_status, u8 delta_count, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 *mask_max_base, u8 sign_mode, u8 *sign_status_base){
+/*
+Perform the forward preprocessing steps which precede densification and surroundification, in at most 2 passes over a mask list: (1) any number of deltas, as with maskops_deltafy(), while tracking the maximum and minimum masks both with and without negation; then (2) negation, as with maskops_negate(), along with marking the mask utilization footprint, as with maskops_densify_bitmap_prepare(). The second pass is skipped if neither step is required. If maskops_lane_msb_mask_get() indicates that deltas can be taken 8 bytes at a time, then they're all done that way beforehand via maskops_pipeline_deltafy_u64(), in a single cache-blocked pass of their own, which is still faster. This is equivalent to calling those functions in sequence, each of which would otherwise make its own pass.
+
+In:
+
+  *bitmap_base is NULL if no mask utilization footprint is required. Otherwise it's as defined for maskops_densify_bitmap_prepare() with (reset_status==1), with respect to the maximum possible mask given granularity (or U8_MAX if channel_status is one).
+
+  channel_status is as defined in maskops_deltafy().
+
+  delta_count is the number of times to apply maskops_deltafy() with (direction_status==1), on [0, MASKOPS_DELTA_COUNT_MAX].
+
+  granularity is one less than the number of bytes per mask, on [0, U32_BYTE_MAX].
+
+  mask_idx_max is one less than the number of masks of size (granularity+1) at *mask_list_base. If channel_status is one, then the masks are treated as (granularity+1) times as many single byte channels after deltafication.
+
+  *mask_list_base is the mask list.
+
+  *mask_max_base is undefined.
+
+  sign_mode is MASKOPS_SIGN_MODE_KEEP to leave the masks unsigned, as with maskops_max_min_get() with (sign_status==0); MASKOPS_SIGN_MODE_NEGATE to negate them, as with maskops_negate(); or MASKOPS_SIGN_MODE_UNSIGN to negate them if and only if doing so would reduce the mask span, as with maskops_unsign().
+
+  *sign_status_base is undefined.
+
+Out:
+
+  Returns the minimum (unsigned) mask at mask_list_base after all the steps above.
+
+  *bitmap_base is as defined in maskops_densify_bitmap_prepare():Out:*bitmap_base, if it was nonNULL on input.
+
+  *mask_list_base is modified in a manner consistent with the summary above.
+
+  *mask_max_base is the maximum (unsigned) mask at mask_list_base after all the steps above.
+
+  *sign_status_base is one if the masks were negated, else zero.
+*/
+  ULONG chunk;
+  ULONG chunk_idx;
+  ULONG chunk_idx_max;
+  ULONG chunk_mask;
+  u8 delta_idx;
+  u64 lane_msb_mask;
+  u32 mask;
+  u32 mask_channel;
+  u8 mask_channel_idx;
+  u32 mask_max;
+  u32 mask_max_signed;
+  u32 mask_min;
+  u32 mask_min_signed;
+  u32 mask_old;
+  u32 mask_old_list_base[MASKOPS_DELTA_COUNT_MAX];
+  u32 mask_sign_mask;
+  u32 mask_signed;
+  u8 mask_u8;
+  u8 sign_status;
+  ULONG u8_idx;
+  u32 u8_idx_delta;
+  ULONG u8_idx_max;
+
+/*
+Deltas are so much faster 8 bytes at a time that it's worth a pass of their own, which takes all of them at once, block by block.
+*/
+  if(delta_count){
+    lane_msb_mask=maskops_lane_msb_mask_get(channel_status, 1, granularity);
+    if(lane_msb_mask){
+      u8_idx_delta=(u8)(granularity+1);
+      maskops_pipeline_deltafy_u64(delta_count, lane_msb_mask, mask_list_base, (u8)(u8_idx_delta), (mask_idx_max*u8_idx_delta)+u8_idx_delta-1);
+      delta_count=0;
+    }
+  }
+  delta_idx=0;
+  while(delta_idx<delta_count){
+    mask_old_list_base[delta_idx]=0;
+    delta_idx++;
+  }
+  mask_max=0;
+  mask_max_signed=0;
+  mask_min=~mask_max;
+  mask_min_signed=mask_min;
+  mask_sign_mask=1U<<(granularity<<U8_BITS_LOG2)<<U8_BIT_MAX;
+  if(channel_status){
+    mask_sign_mask=1U<<U8_BIT_MAX;
+  }
+  u8_idx=0;
+  u8_idx_delta=(u8)(granularity+1);
+  u8_idx_max=mask_idx_max*u8_idx_delta;
+  do{
+    mask=mask_list_base[u8_idx];
+    if(granularity){
+      mask_u8=mask_list_base[u8_idx+U16_BYTE_MAX];
+      mask|=(u32)(mask_u8)<<U8_BITS;
+      if(U16_BYTE_MAX<granularity){
+        mask_u8=mask_list_base[u8_idx+U24_BYTE_MAX];
+        mask|=(u32)(mask_u8)<<U16_BITS;
+        if(U24_BYTE_MAX<granularity){
+          mask_u8=mask_list_base[u8_idx+U32_BYTE_MAX];
+          mask|=(u32)(mask_u8)<<U24_BITS;
+        }
+      }
+    }
+    if(delta_count){
+/*
+Each delta stage remembers its own previous input. Channelized deltas are computed in parallel across all bytes by masking out the high bit of each one, so that borrows can't propagate into the next.
+*/
+      delta_idx=0;
+      do{
+        mask_old=mask_old_list_base[delta_idx];
+        mask_old_list_base[delta_idx]=mask;
+        if(!channel_status){
+          mask-=mask_old;
+          mask&=(1U<<(granularity<<U8_BITS_LOG2)<<U8_BITS)-1;
+        }else{
+          mask=((mask|0x80808080U)-(mask_old&0x7F7F7F7FU))^((mask^~mask_old)&0x80808080U);
+        }
+      }while((++delta_idx)!=delta_count);
+      mask_u8=(u8)(mask);
+      mask_list_base[u8_idx]=mask_u8;
+      if(granularity){
+        mask_u8=(u8)(mask>>U8_BITS);
+        mask_list_base[u8_idx+U16_BYTE_MAX]=mask_u8;
+        if(U16_BYTE_MAX<granularity){
+          mask_u8=(u8)(mask>>U16_BITS);
+          mask_list_base[u8_idx+U24_BYTE_MAX]=mask_u8;
+          if(U24_BYTE_MAX<granularity){
+            mask_u8=(u8)(mask>>U24_BITS);
+            mask_list_base[u8_idx+U32_BYTE_MAX]=mask_u8;
+          }
+        }
+      }
+    }
+    if(!channel_status){
+      mask_max=MAX(mask, mask_max);
+      mask_min=MIN(mask, mask_min);
+      mask_signed=mask^mask_sign_mask;
+      mask_max_signed=MAX(mask_signed, mask_max_signed);
+      mask_min_signed=MIN(mask_signed, mask_min_signed);
+    }else{
+      mask_channel_idx=granularity;
+      do{
+        mask_channel=(u8)(mask);
+        mask_max=MAX(mask_channel, mask_max);
+        mask_min=MIN(mask_channel, mask_min);
+        mask_signed=mask_channel^mask_sign_mask;
+        mask_max_signed=MAX(mask_signed, mask_max_signed);
+        mask_min_signed=MIN(mask_signed, mask_min_signed);
+        mask>>=U8_BITS;
+      }while(mask_channel_idx--);
+    }
+    u8_idx+=u8_idx_delta;
+  }while(u8_idx<=u8_idx_max);
+  sign_status=(sign_mode==MASKOPS_SIGN_MODE_NEGATE);
+  if(sign_mode==MASKOPS_SIGN_MODE_UNSIGN){
+    sign_status=((mask_max_signed-mask_min_signed)<(mask_max-mask_min));
+  }
+  if(sign_status){
+    mask_max=mask_max_signed;
+    mask_min=mask_min_signed;
+  }else{
+    mask_sign_mask=0;
+  }
+  if(sign_status||bitmap_base){
+    if(bitmap_base){
+      chunk_idx_max=(mask_max-mask_min)>>ULONG_BITS_LOG2;
+      memset(bitmap_base, 0, (size_t)((chunk_idx_max+1)<<ULONG_SIZE_LOG2));
+    }
+    if(channel_status){
+      granularity=0;
+      mask_idx_max=(mask_idx_max*u8_idx_delta)+u8_idx_delta-1;
+    }
+    u8_idx=0;
+    u8_idx_delta=(u8)(granularity+1);
+    u8_idx_max=mask_idx_max*u8_idx_delta;
+    do{
+      mask=mask_list_base[u8_idx];
+      if(granularity){
+        mask_u8=mask_list_base[u8_idx+U16_BYTE_MAX];
+        mask|=(u32)(mask_u8)<<U8_BITS;
+        if(U16_BYTE_MAX<granularity){
+          mask_u8=mask_list_base[u8_idx+U24_BYTE_MAX];
+          mask|=(u32)(mask_u8)<<U16_BITS;
+          if(U24_BYTE_MAX<granularity){
+            mask_u8=mask_list_base[u8_idx+U32_BYTE_MAX];
+            mask|=(u32)(mask_u8)<<U24_BITS;
+          }
+        }
+      }
+      if(sign_status){
+        mask^=mask_sign_mask;
+        mask_u8=(u8)(mask);
+        mask_list_base[u8_idx]=mask_u8;
+        if(granularity){
+          mask_u8=(u8)(mask>>U8_BITS);
+          mask_list_base[u8_idx+U16_BYTE_MAX]=mask_u8;
+          if(U16_BYTE_MAX<granularity){
+            mask_u8=(u8)(mask>>U16_BITS);
+            mask_list_base[u8_idx+U24_BYTE_MAX]=mask_u8;
+            if(U24_BYTE_MAX<granularity){
+              mask_u8=(u8)(mask>>U24_BITS);
+              mask_list_base[u8_idx+U32_BYTE_MAX]=mask_u8;
+            }
+          }
+        }
+      }
+      if(bitmap_base){
+        mask-=mask_min;
+        chunk_idx=mask>>ULONG_BITS_LOG2;
+        chunk=bitmap_base[chunk_idx];
+        chunk_mask=(ULONG)(1)<<(mask&ULONG_BIT_MAX);
+        if(!(chunk&chunk_mask)){
+          chunk|=chunk_mask;
+          bitmap_base[chunk_idx]=chunk;
+        }
+      }
+      u8_idx+=u8_idx_delta;
+    }while(u8_idx<=u8_idx_max);
+  }
+  *mask_max_base=mask_max;
+  *sign_status_base=sign_status;
+  return mask_min;
+}
+
+void
+maskops_pipeline_deltafy_u64(u8 delta_count, u64 lane_msb_mask, u8 *mask_list_base, u8 u8_idx_delta, ULONG u8_idx_max){
+/*
+Don't call here directly. This is a helper for maskops_pipeline().
+
+Perform the equivalent of delta_count successive calls to maskops_deltafy_u64() with (direction_status==1), but in a single pass over memory. The mask list is processed in blocks of MASKOPS_PIPELINE_BLOCK_MASK_COUNT masks, small enough to remain in L1 while all the deltas are taken. Each delta of a block needs the last mask of the previous block as it was before that same delta, so those are saved for each delta and temporarily swapped in ahead of the block.
+
+In:
+
+  delta_count is the number of deltas to take, on [1, MASKOPS_DELTA_COUNT_MAX].
+
+  lane_msb_mask is as defined in maskops_deltafy_u64().
+
+  *mask_list_base is as defined in maskops_deltafy().
+
+  u8_idx_delta is as defined in maskops_deltafy_u64().
+
+  u8_idx_max is as defined in maskops_deltafy_u64().
+
+Out:
+
+  *mask_list_base has been deltafied delta_count times.
+*/
+  ULONG block_u8_count;
+  ULONG block_u8_idx_max;
+  ULONG block_u8_idx_min;
+  u8 delta_idx;
+  u8 mask_u8_list_base[U32_SIZE];
+  u8 mask_u8_list_base_old[MASKOPS_DELTA_COUNT_MAX*U32_SIZE];
+  u8 mask_u8_list_base_prev[U32_SIZE];
+  ULONG u8_count;
+  ULONG u8_idx;
+
+  u8_count=u8_idx_max+1;
+/*
+A single delta gains nothing from blocking, so do it in one block.
+*/
+  block_u8_count=u8_count;
+  if(delta_count!=1){
+    block_u8_count=MASKOPS_PIPELINE_BLOCK_MASK_COUNT*u8_idx_delta;
+  }
+  u8_idx=0;
+  do{
+    block_u8_idx_max=u8_count-1;
+    if(block_u8_count<(u8_count-u8_idx)){
+      block_u8_idx_max=u8_idx+block_u8_count-1;
+    }
+/*
+The first block starts with a mask having an implied zero predecessor, which maskops_deltafy_u64() leaves unchanged. Every other block starts one mask earlier, where the previous block's last mask, as it was before the current delta, stands in as the predecessor and is likewise left unchanged.
+*/
+    block_u8_idx_min=0;
+    if(u8_idx){
+      block_u8_idx_min=u8_idx-u8_idx_delta;
+      memcpy(mask_u8_list_base_prev, &mask_list_base[block_u8_idx_min], (size_t)(u8_idx_delta));
+    }
+    delta_idx=0;
+    do{
+      memcpy(mask_u8_list_base, &mask_list_base[block_u8_idx_max+1-u8_idx_delta], (size_t)(u8_idx_delta));
+      if(u8_idx){
+        memcpy(&mask_list_base[block_u8_idx_min], &mask_u8_list_base_old[delta_idx*U32_SIZE], (size_t)(u8_idx_delta));
+      }
+      maskops_deltafy_u64(1, lane_msb_mask, &mask_list_base[block_u8_idx_min], u8_idx_delta, block_u8_idx_max-block_u8_idx_min);
+      memcpy(&mask_u8_list_base_old[delta_idx*U32_SIZE], mask_u8_list_base, (size_t)(u8_idx_delta));
+    }while((++delta_idx)!=delta_count);
+    if(u8_idx){
+      memcpy(&mask_list_base[block_u8_idx_min], mask_u8_list_base_prev, (size_t)(u8_idx_delta));
+    }
+    u8_idx=block_u8_idx_max+1;
+  }while(u8_idx!=u8_count);
+  return;
+}
+
 u32
 maskops_surroundify(u8 channel_status, u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_max, u32 mask_min){
 /*
@@ -19,6 +19,30 @@ You should have received a copy of the GNU Limited General Public
 License version 3 along with the MaskOps Library (filename
 "COPYING"). If not, see http://www.gnu.org/licenses/ .
 */
+TYPEDEF_START
+  ULONG *bitmap_base;
+  ULONG **bitmap_base_list_base;
+  u32 *remask_list_base;
+  u8 *mask_list_base;
+  ULONG chunk_idx_max;
+  ULONG chunk_idx_min;
+  ULONG mask_idx_max;
+  ULONG pop;
+  u32 bitmap_idx_max;
+  u32 mask_max;
+  u32 mask_min;
+  u8 direction_status;
+  u8 granularity;
+  u8 reset_status;
+TYPEDEF_END(maskops_thread_t)
+
+#define MASKOPS_DELTA_COUNT_MAX 8U
+#define MASKOPS_PIPELINE_BLOCK_MASK_COUNT 0x1000U
+#define MASKOPS_SIGN_MODE_KEEP 0U
+#define MASKOPS_SIGN_MODE_NEGATE 1U
+#define MASKOPS_SIGN_MODE_UNSIGN 2U
+#define MASKOPS_THREAD_BITMAP_SIZE_MAX 0x10000000U
+#define MASKOPS_THREAD_ITEM_COUNT_MIN 0x10000U
 #define SURROUND_U16(_dest, _max, _source, _surround) \
   if((_source)<=(_dest)){ \
     _surround=(_dest); \
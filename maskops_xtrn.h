@@ -21,14 +21,26 @@ License version 3 along with the MaskOps Library (filename
 */
 extern ULONG *maskops_bitmap_malloc(u64 msb);
 extern void maskops_deltafy(u8 channel_status, u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base);
+extern void maskops_deltafy_u64(u8 direction_status, u64 lane_msb_mask, u8 *mask_list_base, u8 u8_idx_delta, ULONG u8_idx_max);
 extern void maskops_densify(u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_min, u32 *remask_list_base);
 extern void maskops_densify_bitmap_prepare(ULONG *bitmap_base, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_max, u32 mask_min, u8 reset_status);
+extern void maskops_densify_bitmap_prepare_parallel(ULONG *bitmap_base, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_max, u32 mask_min, u8 reset_status, u32 thread_idx_max);
+extern void *maskops_densify_bitmap_prepare_thread(void *thread_base);
+extern void *maskops_densify_bitmap_reduce_thread(void *thread_base);
+extern void maskops_densify_parallel(u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_min, u32 *remask_list_base, u32 thread_idx_max);
+extern void *maskops_densify_remask_count_thread(void *thread_base);
 extern u32 maskops_densify_remask_prepare(ULONG *bitmap_base, u8 direction_status, u32 mask_max, u32 mask_min, u32 *remask_list_base);
+extern u32 maskops_densify_remask_prepare_parallel(ULONG *bitmap_base, u8 direction_status, u32 mask_max, u32 mask_min, u32 *remask_list_base, u32 thread_idx_max);
+extern void *maskops_densify_remask_prepare_thread(void *thread_base);
+extern void *maskops_densify_thread(void *thread_base);
 extern void *maskops_free(void *base);
 extern u8 maskops_init(u32 build_break_count, u32 build_feature_count);
+extern u64 maskops_lane_msb_mask_get(u8 channel_status, u8 direction_status, u8 granularity);
 extern u8 *maskops_mask_list_malloc(u8 granularity, ULONG mask_idx_max);
 extern u32 maskops_max_min_get(u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 *mask_max_base, u8 sign_status);
 extern u32 maskops_negate(u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 *mask_max_base);
+extern u32 maskops_pipeline(ULONG *bitmap_base, u8 channel_status, u8 delta_count, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 *mask_max_base, u8 sign_mode, u8 *sign_status_base);
+extern void maskops_pipeline_deltafy_u64(u8 delta_count, u64 lane_msb_mask, u8 *mask_list_base, u8 u8_idx_delta, ULONG u8_idx_max);
 extern u32 maskops_surroundify(u8 channel_status, u8 direction_status, u8 granularity, ULONG mask_idx_max, u8 *mask_list_base, u32 mask_max, u32 mask_min);
 extern u32 *maskops_u32_list_malloc(ULONG u32_idx_max);
 extern void maskops_u32_list_zero(ULONG u32_idx_max, u32 *u32_list_base);
@@ -32,6 +32,12 @@ Poisson Cache Hierarchy Kernel
 #include "debug_xtrn.h"
 #include "poissocache.h"
 #include "poissocache_xtrn.h"
+/*
+Helpers which aren't exported in poissocache_xtrn.h, but are called before their definitions below.
+*/
+u8 poissocache_level_add(poissocache_t *poissocache_base);
+u8 poissocache_migrate(poissocache_t *poissocache_base);
+u8 poissocache_refactor(poissocache_t *poissocache_base);
 
 void *
 poissocache_free(void *base){
@@ -72,6 +78,7 @@ Out:
   ULONG *cache_item_list_base;
 
   if(poissocache_base){
+    poissocache_free(poissocache_base->spill_list_base);
     cache_idx_max=poissocache_base->cache_idx_max;
     cache_idx=cache_idx_max;
     do{
@@ -86,6 +93,29 @@ Out:
   return poissocache_base;
 }
 
+void
+poissocache_growth_set(u8 level_count_extra, poissocache_t *poissocache_base){
+/*
+Set the policy for dealing with excessive collision, which is the failure to find a free item for a given key in any level of a Poisson cache. By default, the response is to begin migrating all items to a new hash seed. This function allows a limited number of new levels to be added instead, each of which reduces the odds of subsequent excessive collision by a factor of roughly the new level count.
+
+In:
+
+  level_count_extra is the maximum number of levels which may be added to the Poisson cache, beyond those which it already contains, before resorting to migration. Zero means to always migrate. The total level count will be capped at POISSOCACHE_CACHE_LEVEL_COUNT_MAX. Each level will be allocated only when needed, and will remain until poissocache_free_all(). If allocation fails, then migration will occur instead.
+
+  *poissocache_base is the return value of poissocache_init().
+
+Out:
+
+  The growth policy of *poissocache_base has been updated.
+*/
+  u32 cache_idx_max_max;
+
+  cache_idx_max_max=(u32)(poissocache_base->cache_idx_max)+level_count_extra;
+  cache_idx_max_max=MIN(cache_idx_max_max, POISSOCACHE_CACHE_LEVEL_COUNT_MAX-1);
+  poissocache_base->cache_idx_max_max=(u8)(cache_idx_max_max);
+  return;
+}
+
 poissocache_t *
 poissocache_init(u32 build_break_count, u32 build_feature_count, ULONG cache_item_idx_max){
 /*
@@ -97,7 +127,7 @@ In:
 
   build_feature_count is the caller's most recent knowledge of POISSOCACHE_BUILD_FEATURE_COUNT, which will fail if this library is not up to date with the caller's expectations.
 
-  cache_item_idx_max is one less than the maximum number of (key, value) pairs which would need to be stored in the entire Poisson cache at any given time. It must be one less than a power of 2. The entire Poisson cache will consist of POISSOCACHE_CACHE_LEVEL_COUNT_MAX caches, each containing (cache_item_idx_max+1) such pairs. Furthermore there will be 2 such Poisson caches allocated, in order to facilitate double-buffered refactoring in the event of excessive collisions.
+  cache_item_idx_max is one less than the maximum number of (key, value) pairs which would need to be stored in the entire Poisson cache at any given time. It must be one less than a power of 2. The entire Poisson cache will consist of POISSOCACHE_CACHE_LEVEL_COUNT_MAX caches, each containing (cache_item_idx_max+1) such pairs. Furthermore there will be 2 such Poisson caches allocated, in order to facilitate incremental migration to a new hash seed in the event of excessive collisions, plus a spill area the size of one level for use in the rare event that migration itself suffers excessive collision. See poissocache_item_ulong_idx_get().
 
 Out:
 
@@ -166,7 +196,20 @@ The secondary Poisson cache cache lacks level zero because its content is unaffe
         }
         cache_idx++;
       }while(cache_idx<=cache_idx_max);
+      cache_item_list_base=DEBUG_MALLOC_PARANOID(cache_size);
+      poissocache_base->spill_list_base=cache_item_list_base;
+      status=(u8)(status|!cache_item_list_base);
       if(!status){
+        poissocache_base->cache_idx_max_max=cache_idx_max;
+/*
+The secondary Poisson cache must be empty whenever migration is not in progress, so initialize it here once and for all.
+*/
+        cache_idx=1;
+        do{
+          cache_item_list_base=poissocache_base->cache_item_list_base_list_base1[cache_idx];
+          memset(cache_item_list_base, U8_MAX, (size_t)(cache_size));
+          cache_idx++;
+        }while(cache_idx<=cache_idx_max);
         poissocache_reset(poissocache_base);
       }else{
         poissocache_base=poissocache_free_all(poissocache_base);
@@ -179,7 +222,7 @@ The secondary Poisson cache cache lacks level zero because its content is unaffe
 u8
 poissocache_item_get_serialized(u8 *cache_idx_base, ULONG *cache_item_ulong_idx_base, ULONG *key_base, poissocache_t *poissocache_base, ULONG *value_base){
 /*
-Dump the entire contents of each cache in a Poisson cache one item at a time, cycling through items before cycling through caches.
+Dump the entire contents of each cache in a Poisson cache one item at a time, cycling through items before cycling through caches. If a migration is in progress, then the levels of the old generation will be dumped after those of the new one. The Poisson cache must not be modified, other than by changing values, until this function has returned nonzero.
 
 In:
 
@@ -207,6 +250,7 @@ Out:
 */
   u8 cache_idx;
   u8 cache_idx_max;
+  u8 cache_idx_max_serialized;
   ULONG *cache_item_list_base;
   ULONG cache_item_ulong_idx;
   ULONG cache_item_ulong_idx_max;
@@ -216,11 +260,18 @@ Out:
 
   cache_idx=*cache_idx_base;
   cache_idx_max=poissocache_base->cache_idx_max;
+  cache_idx_max_serialized=cache_idx_max;
+  if(poissocache_base->migrate_cache_idx){
+    cache_idx_max_serialized=(u8)(cache_idx_max<<1);
+  }
   cache_item_ulong_idx=*cache_item_ulong_idx_base;
   cache_item_ulong_idx_max=poissocache_base->cache_item_ulong_idx_max;
   status=1;
-  while(cache_idx<=cache_idx_max){
+  while(cache_idx<=cache_idx_max_serialized){
     cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+    if(cache_idx_max<cache_idx){
+      cache_item_list_base=poissocache_base->cache_item_list_base_list_base1[cache_idx-cache_idx_max];
+    }
     while(cache_item_ulong_idx<=cache_item_ulong_idx_max){
       key=cache_item_list_base[cache_item_ulong_idx];
       if(key!=ULONG_MAX){
@@ -243,11 +294,11 @@ Out:
     cache_item_ulong_idx=0;
     cache_idx++;
   }
-  if(status|(cache_idx_max<cache_idx)){
+  if(status|(cache_idx_max_serialized<cache_idx)){
 /*
 Return cache_idx and cache_item_ulong_idx as their respective postterminal values in order to force failure on any subsequent calls.
 */
-    cache_idx=(u8)(cache_idx_max+1);
+    cache_idx=(u8)(cache_idx_max_serialized+1);
     cache_item_ulong_idx=cache_item_ulong_idx_max+2;
   }
   *cache_idx_base=cache_idx;
@@ -255,17 +306,95 @@ Return cache_idx and cache_item_ulong_idx as their respective postterminal value
   return status;
 }
 
+u8
+poissocache_item_place(ULONG **cache_item_list_base_base, ULONG *cache_item_ulong_idx_base, ULONG key, poissocache_t *poissocache_base, ULONG value){
+/*
+Don't call here directly. This is a helper for poissocache_item_ulong_idx_get(), poissocache_migrate(), and poissocache_refactor().
+
+Store a (key, value) pair in the new generation of a Poisson cache, in the first free item in the hash chain of the key under the current seed. Failing that, overwrite a pair having zero value, starting at level zero.
+
+In:
+
+  **cache_item_list_base_base is undefined.
+
+  *cache_item_ulong_idx_base is undefined.
+
+  key is the key to store, which must not exist anywhere in the new generation (although it may exist in the old one), nor be ULONG_MAX.
+
+  *poissocache_base is the return value of poissocache_init().
+
+  value is the value to associate with key.
+
+Out:
+
+  Returns zero on success, else one if every candidate item was occupied by a pair having nonzero value, in which case the Poisson cache is unchanged.
+
+  **cache_item_list_base_base is the base of the level containing the new pair. Undefined on failure.
+
+  *cache_item_ulong_idx_base is the ULONG index of the new pair within said level. Undefined on failure.
+*/
+  u8 cache_idx;
+  u8 cache_idx_max;
+  ULONG cache_item_idx_max;
+  ULONG *cache_item_list_base;
+  ULONG cache_item_ulong_idx;
+  u32 marsaglia_c;
+  u32 marsaglia_x;
+  u64 random;
+  u64 seed;
+  u8 status;
+
+  cache_idx_max=poissocache_base->cache_idx_max;
+  cache_item_idx_max=poissocache_base->cache_item_idx_max;
+  seed=poissocache_base->seed;
+  cache_idx=1;
+  random=key+seed;
+  do{
+    MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
+    cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+    cache_item_ulong_idx=(ULONG)((random&cache_item_idx_max)<<1);
+    if(cache_item_list_base[cache_item_ulong_idx]==ULONG_MAX){
+      break;
+    }
+    cache_idx++;
+  }while(cache_idx<=cache_idx_max);
+  if(cache_idx_max<cache_idx){
+    cache_idx=0;
+    cache_item_ulong_idx=(key&cache_item_idx_max)<<1;
+    random=key+seed;
+    do{
+      cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+      if(!cache_item_list_base[cache_item_ulong_idx+1]){
+        break;
+      }
+      MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
+      cache_idx++;
+      cache_item_ulong_idx=(ULONG)((random&cache_item_idx_max)<<1);
+    }while(cache_idx<=cache_idx_max);
+  }
+  status=(cache_idx_max<cache_idx);
+  if(!status){
+    cache_item_list_base[cache_item_ulong_idx]=key;
+    cache_item_list_base[cache_item_ulong_idx+1]=value;
+    *cache_item_list_base_base=cache_item_list_base;
+    *cache_item_ulong_idx_base=cache_item_ulong_idx;
+  }
+  return status;
+}
+
 ULONG
-poissocache_item_ulong_idx_get(ULONG cache_item_idx_max, ULONG **cache_item_list_base_base, ULONG key, poissocache_t *poissocache_base){
+poissocache_item_ulong_idx_get(ULONG cache_item_idx_max, ULONG **cache_item_list_base_base, ULONG key, u8 *overflow_status_base, poissocache_t *poissocache_base){
 /*
-Find a (key, value) pair in a Poisson cache whose key matches the specified value. If it doesn't exist, try to create it. If the the hash tags in every cache level collide with one another, refactor the cache pseudorandomly until no such excessive collisions occur.
+Find a (key, value) pair in a Poisson cache whose key matches the specified value. If it doesn't exist, try to create it.
+
+If the the hash tags in every cache level collide with one another, then either add a level, subject to poissocache_growth_set(), or else begin migrating to a new hash seed. Migration swaps the primary (new generation) and secondary (old generation) caches, then moves a bounded number of items from the old generation to the new one on each subsequent call, so that no single call has to refactor the entire Poisson cache. Until it completes, keys are sought in both generations. Only if excessive collision occurs again during migration do we fall back to refactoring everything at once via poissocache_refactor(), the odds of which are roughly one in ((N!)e) per insertion, where N is the number of levels.
 
 Don't call here directly. Instead, use  POISSOCACHE_ITEM_ULONG_IDX_GET() as follows:
 
   key_value_idx_max=poissocache_parameters_get(&key_value_list_base0, poissocache_base);
-  POISSOCACHE_ITEM_ULONG_IDX_GET(key_value_ulong_idx, key_value_idx_max, key, key_value_list_base0, key_value_list_base1, poissocache_base);
+  POISSOCACHE_ITEM_ULONG_IDX_GET(key_value_ulong_idx, key_value_idx_max, key, key_value_list_base0, key_value_list_base1, overflow_status, poissocache_base);
 
-where key_value_list_base1[key_value_ulong_idx] will then point to the key (a ULONG), and key_value_list_base[key_value_ulong_idx+1] will then point to the value (a ULONG). key_value_idx_max and key_value_list_base0 can then be reused for many calls to POISSOCACHE_ITEM_ULONG_IDX_GET(), even across poissocache_reset(). Note that the granularity of key_value_idx_max is 2 (ULONG)s, whereas that of key_value_ulong_idx is just one ULONG.
+where key_value_list_base1[key_value_ulong_idx] will then point to the key (a ULONG), and key_value_list_base[key_value_ulong_idx+1] will then point to the value (a ULONG). key_value_idx_max and key_value_list_base0 can then be reused for many calls to POISSOCACHE_ITEM_ULONG_IDX_GET(), even across poissocache_reset(). Note that the granularity of key_value_idx_max is 2 (ULONG)s, whereas that of key_value_ulong_idx is just one ULONG. The pair may move on any subsequent call, so don't retain (key_value_list_base1, key_value_ulong_idx) across calls.
 
 In:
 
@@ -275,6 +404,8 @@ In:
 
   key is the key to find, which may or may not be present in the entire Poisson cache. Must not be ULONG_MAX.
 
+  *overflow_status_base is the OR-cummulative overflow status.
+
   *poissocache_base is the return value of poissocache_init().
 
 Out:
@@ -282,119 +413,234 @@ Out:
   Returns the ULONG index of the (key, value) pair where the key matches (In:key). If no such pair existed, then it will have been initialized to (key, 0). The caller may then modify the value, but not the key.
 
   **cache_item_list_base_base is the base of the particular cache within the Poisson cache which contains (key, value) (at the ULONG index given by (return value)).
+
+  *overflow_status_base is one if more items having nonzero value were stored than (poissocache_init():In:cache_item_idx_max) allows, such that a refactor couldn't hold them all, else unchanged. In the former case, the returned pair is merely scratch space which isn't part of the Poisson cache, so the values of some keys are no longer reliable.
 */
-  u8 cache_idx_max;
+  ULONG cache_idx_max;
+  ULONG cache_idx_max_max;
   ULONG cache_idx0;
   ULONG cache_idx1;
-  ULONG cache_item_ulong_idx_max;
-  ULONG cache_item_ulong_idx1;
-  ULONG cache_item_ulong_idx0;
   ULONG *cache_item_list_base0;
   ULONG *cache_item_list_base1;
-  ULONG cache_size;
+  ULONG cache_item_ulong_idx0;
+  ULONG cache_item_ulong_idx1;
   ULONG key0;
-  ULONG key1;
   u32 marsaglia_c;
   u32 marsaglia_x;
-  u8 max_collision_status;
+  u8 migrate_cache_idx;
   u64 random;
   u64 seed;
+  u64 seed_old;
+  u8 status;
   ULONG value0;
 
-  cache_idx_max=poissocache_base->cache_idx_max;
-  seed=poissocache_base->seed;
+  if(poissocache_base->migrate_cache_idx){
+    status=poissocache_migrate(poissocache_base);
+    if(status){
+      status=poissocache_refactor(poissocache_base);
+      *overflow_status_base=(u8)(*overflow_status_base|status);
+    }
+  }
   do{
+    cache_idx_max=poissocache_base->cache_idx_max;
+    seed=poissocache_base->seed;
     cache_idx0=1;
     random=key+seed;
+/*
+Items in the new generation are never freed, so the key can't exist beyond the first free item in its hash chain.
+*/
     do{
       MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
       cache_item_list_base0=poissocache_base->cache_item_list_base_list_base0[cache_idx0];
       cache_item_ulong_idx0=(ULONG)((random&cache_item_idx_max)<<1);
       key0=cache_item_list_base0[cache_item_ulong_idx0];
-      if(key==key0){
-        break;
-      }else if(key0==ULONG_MAX){
-        cache_item_list_base0[cache_item_ulong_idx0]=key;
-        cache_item_list_base0[cache_item_ulong_idx0+1]=0;
+      if((key==key0)||(key0==ULONG_MAX)){
         break;
       }
       cache_idx0++;
     }while(cache_idx0<=cache_idx_max);
-    if(cache_idx_max<cache_idx0){
-      cache_idx0=0;
-      cache_item_ulong_idx0=(key&cache_item_idx_max)<<1;
-      random=key+seed;
-      do{
-        cache_item_list_base0=poissocache_base->cache_item_list_base_list_base0[cache_idx0];
-        value0=cache_item_list_base0[cache_item_ulong_idx0+1];
-        if(!value0){
-          cache_item_list_base0[cache_item_ulong_idx0]=key;
-          break;
-        }
-        MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
-        cache_idx0++;
-        cache_item_ulong_idx0=(ULONG)((random&cache_item_idx_max)<<1);
-      }while(cache_idx0<=cache_idx_max);
-    }
-    max_collision_status=0;
-    if(cache_idx_max<cache_idx0){
-      cache_size=poissocache_base->cache_size;
-      cache_item_ulong_idx_max=poissocache_base->cache_item_ulong_idx_max;
-      do{
-        MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, seed);
+    status=0;
+    if(key!=key0){
+      cache_idx1=cache_idx_max+1;
+      cache_item_list_base1=NULL;
+      cache_item_ulong_idx1=0;
+      migrate_cache_idx=poissocache_base->migrate_cache_idx;
+      value0=0;
+      if(migrate_cache_idx){
+/*
+Items in the old generation are freed as they migrate, so search its entire hash chain.
+*/
+        seed_old=poissocache_base->seed_old;
         cache_idx1=1;
+        random=key+seed_old;
         do{
+          MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
           cache_item_list_base1=poissocache_base->cache_item_list_base_list_base1[cache_idx1];
-          memset(cache_item_list_base1, U8_MAX, (size_t)(cache_size));
+          cache_item_ulong_idx1=(ULONG)((random&cache_item_idx_max)<<1);
+          if(key==cache_item_list_base1[cache_item_ulong_idx1]){
+            value0=cache_item_list_base1[cache_item_ulong_idx1+1];
+            break;
+          }
           cache_idx1++;
         }while(cache_idx1<=cache_idx_max);
-        cache_idx0=1;
-        max_collision_status=0;
-        do{
-          cache_item_list_base0=poissocache_base->cache_item_list_base_list_base0[cache_idx0];
-          cache_item_ulong_idx0=0;
-          do{
-            key0=cache_item_list_base0[cache_item_ulong_idx0];
-            if(key0!=ULONG_MAX){
-              value0=cache_item_list_base0[cache_item_ulong_idx0+1];
-              if(value0){
-                cache_idx1=1;
-                random=key0+seed;
-                do{
-                  MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, random);
-                  cache_item_list_base1=poissocache_base->cache_item_list_base_list_base1[cache_idx1];
-                  cache_item_ulong_idx1=(ULONG)((random&cache_item_idx_max)<<1);
-                  key1=cache_item_list_base1[cache_item_ulong_idx1];
-                  if(key1==ULONG_MAX){
-                    cache_item_list_base1[cache_item_ulong_idx1]=key0;
-                    cache_item_list_base1[cache_item_ulong_idx1+1]=value0;
-                    break;
-                  }
-                  cache_idx1++;
-                }while(cache_idx1<=cache_idx_max);
-                max_collision_status=(cache_idx_max<cache_idx1);
-              }
+      }
+      status=poissocache_item_place(&cache_item_list_base0, &cache_item_ulong_idx0, key, poissocache_base, value0);
+      if(!status){
+        if(cache_idx1<=cache_idx_max){
+          cache_item_list_base1[cache_item_ulong_idx1]=ULONG_MAX;
+          cache_item_list_base1[cache_item_ulong_idx1+1]=ULONG_MAX;
+        }
+      }else{
+        cache_idx_max_max=poissocache_base->cache_idx_max_max;
+        if(cache_idx_max<cache_idx_max_max){
+          status=poissocache_level_add(poissocache_base);
+        }
+        if(status){
+          if(!migrate_cache_idx){
+/*
+Begin migrating to a new seed. The secondary cache is empty, so just swap it with the primary one and start draining the latter.
+*/
+            poissocache_base->seed_old=seed;
+            MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, seed);
+            poissocache_base->seed=seed;
+            cache_idx0=1;
+            do{
+              cache_item_list_base0=poissocache_base->cache_item_list_base_list_base0[cache_idx0];
+              cache_item_list_base1=poissocache_base->cache_item_list_base_list_base1[cache_idx0];
+              poissocache_base->cache_item_list_base_list_base0[cache_idx0]=cache_item_list_base1;
+              poissocache_base->cache_item_list_base_list_base1[cache_idx0]=cache_item_list_base0;
+              cache_idx0++;
+            }while(cache_idx0<=cache_idx_max);
+            poissocache_base->migrate_cache_idx=1;
+            poissocache_base->migrate_ulong_idx=0;
+          }else{
+            status=poissocache_refactor(poissocache_base);
+            if(status){
+/*
+The Poisson cache is overfull, so there's no place for the key. Give the caller a scratch pair so that it can proceed, and tell it that the result is unreliable.
+*/
+              *overflow_status_base=1;
+              cache_item_list_base0=poissocache_base->spill_list_base;
+              cache_item_ulong_idx0=0;
+              cache_item_list_base0[0]=key;
+              cache_item_list_base0[1]=0;
+              break;
             }
-            cache_item_ulong_idx0+=2;
-          }while((cache_item_ulong_idx0<=cache_item_ulong_idx_max)&&!max_collision_status);
-          cache_idx0++;
-        }while((cache_idx0<=cache_idx_max)&&!max_collision_status);
-      }while(max_collision_status);
-      cache_idx0=1;
-      do{
-        cache_item_list_base0=poissocache_base->cache_item_list_base_list_base0[cache_idx0];
-        cache_item_list_base1=poissocache_base->cache_item_list_base_list_base1[cache_idx0];
-        memcpy(cache_item_list_base0, cache_item_list_base1, (size_t)(cache_size));
-        cache_idx0++;
-      }while(cache_idx0<=cache_idx_max);
-      poissocache_base->seed=seed;
-      max_collision_status=1;
+          }
+        }
+        status=1;
+      }
     }
-  }while(max_collision_status);
+  }while(status);
   *cache_item_list_base_base=cache_item_list_base0;
   return cache_item_ulong_idx0;
 }
 
+u8
+poissocache_level_add(poissocache_t *poissocache_base){
+/*
+Don't call here directly. This is a helper for poissocache_item_ulong_idx_get().
+
+Add an empty level to both the primary and secondary Poisson caches. Hash chains grow by one item, but existing items need not move.
+
+In:
+
+  *poissocache_base is the return value of poissocache_init().
+
+Out:
+
+  Returns zero on success, else one if memory could not be allocated, in which case the Poisson cache is unchanged.
+*/
+  u8 cache_idx;
+  ULONG *cache_item_list_base0;
+  ULONG *cache_item_list_base1;
+  ULONG cache_size;
+  u8 status;
+
+  cache_idx=(u8)(poissocache_base->cache_idx_max+1);
+  cache_size=poissocache_base->cache_size;
+  cache_item_list_base0=DEBUG_MALLOC_PARANOID(cache_size);
+  cache_item_list_base1=DEBUG_MALLOC_PARANOID(cache_size);
+  status=!cache_item_list_base0;
+  status=(u8)(status|!cache_item_list_base1);
+  if(!status){
+    memset(cache_item_list_base0, U8_MAX, (size_t)(cache_size));
+    memset(cache_item_list_base1, U8_MAX, (size_t)(cache_size));
+    poissocache_base->cache_item_list_base_list_base0[cache_idx]=cache_item_list_base0;
+    poissocache_base->cache_item_list_base_list_base1[cache_idx]=cache_item_list_base1;
+    poissocache_base->cache_idx_max=cache_idx;
+  }else{
+    poissocache_free(cache_item_list_base1);
+    poissocache_free(cache_item_list_base0);
+  }
+  return status;
+}
+
+u8
+poissocache_migrate(poissocache_t *poissocache_base){
+/*
+Don't call here directly. This is a helper for poissocache_item_ulong_idx_get().
+
+Move up to POISSOCACHE_MIGRATE_ITEM_COUNT items from the old generation of a Poisson cache to the new one, dropping those having zero value. When the old generation has been entirely drained, end the migration.
+
+In:
+
+  *poissocache_base is the return value of poissocache_init(), and is in the midst of migration.
+
+Out:
+
+  Returns zero on success, else one if an item could not be stored in the new generation, in which case the caller must call poissocache_refactor().
+
+  *poissocache_base has been updated. (poissocache_base->migrate_cache_idx) is zero if the migration has completed.
+*/
+  u8 cache_idx_max;
+  ULONG *cache_item_list_base0;
+  ULONG *cache_item_list_base1;
+  ULONG cache_item_ulong_idx_max;
+  ULONG cache_item_ulong_idx0;
+  ULONG item_count;
+  ULONG key1;
+  u8 migrate_cache_idx;
+  ULONG migrate_ulong_idx;
+  u8 status;
+  ULONG value1;
+
+  cache_idx_max=poissocache_base->cache_idx_max;
+  cache_item_ulong_idx_max=poissocache_base->cache_item_ulong_idx_max;
+  item_count=POISSOCACHE_MIGRATE_ITEM_COUNT;
+  migrate_cache_idx=poissocache_base->migrate_cache_idx;
+  migrate_ulong_idx=poissocache_base->migrate_ulong_idx;
+  status=0;
+  do{
+    cache_item_list_base1=poissocache_base->cache_item_list_base_list_base1[migrate_cache_idx];
+    key1=cache_item_list_base1[migrate_ulong_idx];
+    if(key1!=ULONG_MAX){
+      value1=cache_item_list_base1[migrate_ulong_idx+1];
+      if(value1){
+        status=poissocache_item_place(&cache_item_list_base0, &cache_item_ulong_idx0, key1, poissocache_base, value1);
+        if(status){
+          break;
+        }
+      }
+      cache_item_list_base1[migrate_ulong_idx]=ULONG_MAX;
+      cache_item_list_base1[migrate_ulong_idx+1]=ULONG_MAX;
+    }
+    migrate_ulong_idx+=2;
+    if(cache_item_ulong_idx_max<migrate_ulong_idx){
+      migrate_ulong_idx=0;
+      migrate_cache_idx++;
+      if(cache_idx_max<migrate_cache_idx){
+        migrate_cache_idx=0;
+        break;
+      }
+    }
+    item_count--;
+  }while(item_count);
+  poissocache_base->migrate_cache_idx=migrate_cache_idx;
+  poissocache_base->migrate_ulong_idx=migrate_ulong_idx;
+  return status;
+}
+
 ULONG
 poissocache_parameters_get(ULONG **cache_item_list_base_base, poissocache_t *poissocache_base){
 /*
@@ -419,6 +665,127 @@ Out:
   return cache_item_idx_max;
 }
 
+u8
+poissocache_refactor(poissocache_t *poissocache_base){
+/*
+Don't call here directly. This is a helper for poissocache_item_ulong_idx_get().
+
+Refactor the entire Poisson cache at once, abandoning any migration in progress. Copy all items having nonzero value, other than those in level zero, to the spill area. Then empty both generations and store the items in the new one under successive new seeds until no excessive collision occurs.
+
+In:
+
+  *poissocache_base is the return value of poissocache_init().
+
+Out:
+
+  Returns zero on success, else one if the items having nonzero value didn't fit in the spill area, in which case the Poisson cache is unchanged.
+
+  *poissocache_base has been refactored and is not migrating, unless the return value is one.
+*/
+  u8 cache_idx;
+  u8 cache_idx_max;
+  u8 cache_idx_max_spill;
+  ULONG *cache_item_list_base;
+  ULONG *cache_item_list_base0;
+  ULONG cache_item_ulong_idx;
+  ULONG cache_item_ulong_idx_max;
+  ULONG cache_item_ulong_idx0;
+  ULONG cache_size;
+  ULONG key;
+  u32 marsaglia_c;
+  u32 marsaglia_x;
+  u64 seed;
+  ULONG *spill_list_base;
+  ULONG spill_ulong_idx;
+  ULONG spill_ulong_idx_max;
+  u8 status;
+  ULONG value;
+
+  cache_idx_max=poissocache_base->cache_idx_max;
+  cache_item_ulong_idx_max=poissocache_base->cache_item_ulong_idx_max;
+  cache_size=poissocache_base->cache_size;
+  spill_list_base=poissocache_base->spill_list_base;
+  cache_idx_max_spill=cache_idx_max;
+  if(poissocache_base->migrate_cache_idx){
+    cache_idx_max_spill=(u8)(cache_idx_max<<1);
+  }
+/*
+The number of items having nonzero value can't exceed (poissocache_init():In:cache_item_idx_max+1), so they all fit in the spill area, which is the size of one level. If the caller has exceeded that limit, then fail before anything has been emptied, rather than silently dropping the excess.
+*/
+  spill_ulong_idx_max=0;
+  status=0;
+  cache_idx=1;
+  do{
+    cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+    if(cache_idx_max<cache_idx){
+      cache_item_list_base=poissocache_base->cache_item_list_base_list_base1[cache_idx-cache_idx_max];
+    }
+    cache_item_ulong_idx=0;
+    do{
+      key=cache_item_list_base[cache_item_ulong_idx];
+      if(key!=ULONG_MAX){
+        value=cache_item_list_base[cache_item_ulong_idx+1];
+        if(value){
+          status=(cache_item_ulong_idx_max<spill_ulong_idx_max);
+          if(status){
+            break;
+          }
+          spill_list_base[spill_ulong_idx_max]=key;
+          spill_list_base[spill_ulong_idx_max+1]=value;
+          spill_ulong_idx_max+=2;
+        }
+      }
+      cache_item_ulong_idx+=2;
+    }while(cache_item_ulong_idx<=cache_item_ulong_idx_max);
+    cache_idx++;
+  }while((cache_idx<=cache_idx_max_spill)&&!status);
+  if(!status){
+    cache_idx=1;
+    do{
+      cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+      if(cache_idx_max<cache_idx){
+        cache_item_list_base=poissocache_base->cache_item_list_base_list_base1[cache_idx-cache_idx_max];
+      }
+      memset(cache_item_list_base, U8_MAX, (size_t)(cache_size));
+      cache_idx++;
+    }while(cache_idx<=cache_idx_max_spill);
+    poissocache_base->migrate_cache_idx=0;
+    seed=poissocache_base->seed;
+    do{
+      MARSAGLIA_ITERATE(marsaglia_c, marsaglia_x, seed);
+      poissocache_base->seed=seed;
+      spill_ulong_idx=0;
+      status=0;
+      while(spill_ulong_idx<spill_ulong_idx_max){
+        value=spill_list_base[spill_ulong_idx+1];
+        if(value){
+          key=spill_list_base[spill_ulong_idx];
+          status=poissocache_item_place(&cache_item_list_base0, &cache_item_ulong_idx0, key, poissocache_base, value);
+          if(status){
+            break;
+          }
+/*
+Level zero won't be emptied on retry, so don't store the same item there twice.
+*/
+          if(cache_item_list_base0==poissocache_base->cache_item_list_base_list_base0[0]){
+            spill_list_base[spill_ulong_idx+1]=0;
+          }
+        }
+        spill_ulong_idx+=2;
+      }
+      if(status){
+        cache_idx=1;
+        do{
+          cache_item_list_base=poissocache_base->cache_item_list_base_list_base0[cache_idx];
+          memset(cache_item_list_base, U8_MAX, (size_t)(cache_size));
+          cache_idx++;
+        }while(cache_idx<=cache_idx_max);
+      }
+    }while(status);
+  }
+  return status;
+}
+
 void
 poissocache_reset(poissocache_t *poissocache_base){
 /*
@@ -448,7 +815,16 @@ Initialize all cache entries in the Poisson cache zero to invalid (free) values.
     cache_idx--;
   }while(cache_idx<cache_idx_max);
 /*
-There's no need to reset the caches pointed to by cache_item_list_base_list_base1 because that gets done automatically upon refactoring. 
+The caches pointed to by cache_item_list_base_list_base1 are already empty unless a migration is in progress, in which case abandon it.
 */
+  if(poissocache_base->migrate_cache_idx){
+    cache_idx=1;
+    do{
+      cache_item_list_base=poissocache_base->cache_item_list_base_list_base1[cache_idx];
+      memset(cache_item_list_base, U8_MAX, (size_t)(cache_size));
+      cache_idx++;
+    }while(cache_idx<=cache_idx_max);
+    poissocache_base->migrate_cache_idx=0;
+  }
   return;
 }
@@ -20,20 +20,26 @@ License version 3 along with the Poissocache Library (filename
 "COPYING"). If not, see http://www.gnu.org/licenses/ .
 */
 #define POISSOCACHE_CACHE_LEVEL_COUNT_MAX 20
+#define POISSOCACHE_MIGRATE_ITEM_COUNT 64U
 
-#define POISSOCACHE_ITEM_ULONG_IDX_GET(cache_item_ulong_idx, cache_item_idx_max, key, cache_item_list_base0, cache_item_list_base1, poissocache_base) \
+#define POISSOCACHE_ITEM_ULONG_IDX_GET(cache_item_ulong_idx, cache_item_idx_max, key, cache_item_list_base0, cache_item_list_base1, overflow_status, poissocache_base) \
   cache_item_ulong_idx=(ULONG)((key&cache_item_idx_max)<<1); \
   cache_item_list_base1=cache_item_list_base0; \
   if(key!=cache_item_list_base0[cache_item_ulong_idx]){ \
-    cache_item_ulong_idx=poissocache_item_ulong_idx_get(cache_item_idx_max, &cache_item_list_base1, key, poissocache_base); \
+    cache_item_ulong_idx=poissocache_item_ulong_idx_get(cache_item_idx_max, &cache_item_list_base1, key, &overflow_status, poissocache_base); \
   }
 
 TYPEDEF_START
   u64 seed;
+  u64 seed_old;
   ULONG *cache_item_list_base_list_base0[POISSOCACHE_CACHE_LEVEL_COUNT_MAX];
   ULONG *cache_item_list_base_list_base1[POISSOCACHE_CACHE_LEVEL_COUNT_MAX];
+  ULONG *spill_list_base;
   ULONG cache_item_idx_max;
   ULONG cache_item_ulong_idx_max;
   ULONG cache_size;
+  ULONG migrate_ulong_idx;
   u8 cache_idx_max;
+  u8 cache_idx_max_max;
+  u8 migrate_cache_idx;
 TYPEDEF_END(poissocache_t)
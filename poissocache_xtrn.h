@@ -21,8 +21,9 @@ License version 3 along with the Poissocache Library (filename
 */
 extern void *poissocache_free(void *base);
 extern poissocache_t *poissocache_free_all(poissocache_t *poissocache_base);
+extern void poissocache_growth_set(u8 level_count_extra, poissocache_t *poissocache_base);
 extern poissocache_t *poissocache_init(u32 build_break_count, u32 build_feature_count, ULONG cache_item_idx_max);
 extern u8 poissocache_item_get_serialized(u8 *cache_idx_base, ULONG *cache_item_ulong_idx_base, ULONG *key_base, poissocache_t *poissocache_base, ULONG *value_base);
-extern ULONG poissocache_item_ulong_idx_get(ULONG cache_item_idx_max, ULONG **cache_item_list_base_base, ULONG key, poissocache_t *poissocache_base);
+extern ULONG poissocache_item_ulong_idx_get(ULONG cache_item_idx_max, ULONG **cache_item_list_base_base, ULONG key, u8 *overflow_status_base, poissocache_t *poissocache_base);
 extern ULONG poissocache_parameters_get(ULONG **cache_item_list_base_base, poissocache_t *poissocache_base);
 extern void poissocache_reset(poissocache_t *poissocache_base);
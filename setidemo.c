@@ -30,6 +30,7 @@ SETI Signal Detection Demo
 #include "flag_fracterval_u64.h"
 #include "flag_fracterval_u128.h"
 #include "flag_loggamma.h"
+#include "flag_thread.h"
 #include "flag_maskops.h"
 #include "flag_poissocache.h"
 #include "flag_agnentroprox.h"
@@ -449,9 +450,8 @@ Injecting a signal of amplitude one means that the first deltas will alternately
         }while((mask_idx++)!=mask_idx_max);
       }
       if(densify_status|surroundify_status){
-        mask_min=maskops_negate(granularity, mask_idx_max, mask_list_base, &mask_max_finalized);
+        mask_min=maskops_pipeline(maskops_bitmap_base, 0, 0, granularity, mask_idx_max, mask_list_base, &mask_max_finalized, MASKOPS_SIGN_MODE_NEGATE, &ignored_status);
         if(densify_status){
-          maskops_densify_bitmap_prepare(maskops_bitmap_base, granularity, mask_idx_max, mask_list_base, mask_max_finalized, mask_min, 1);
           mask_max_finalized=maskops_densify_remask_prepare(maskops_bitmap_base, 1, mask_max_finalized, mask_min, maskops_u32_list_base);
           maskops_densify(1, granularity, mask_idx_max, mask_list_base, mask_min, maskops_u32_list_base);
           mask_min=0;
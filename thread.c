@@ -0,0 +1,172 @@
+/*
+Thread
+Copyright 2017 Russell Leidich
+
+This collection of files constitutes the Thread Library. (This is a
+library in the abstact sense; it's not intended to compile to a ".lib"
+file.)
+
+The Thread Library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Limited General Public License as
+published by the Free Software Foundation, version 3.
+
+The Thread Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Limited General Public License version 3 for more details.
+
+You should have received a copy of the GNU Limited General Public
+License version 3 along with the Thread Library (filename
+"COPYING"). If not, see http://www.gnu.org/licenses/ .
+*/
+/*
+Fork and Join Threading
+*/
+#include "flag.h"
+#include "flag_thread.h"
+#include <pthread.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <unistd.h>
+#include "constant.h"
+#include "debug.h"
+#include "debug_xtrn.h"
+#include "thread.h"
+#include "thread_xtrn.h"
+
+void
+thread_async_finish(void *handle_base){
+/*
+Wait for a thread started by thread_async_start() to finish, and free its handle.
+
+In:
+
+  handle_base is the return value of thread_async_start(), which may be NULL.
+
+Out:
+
+  The function passed to thread_async_start() has returned, and handle_base has been freed.
+*/
+  if(handle_base){
+    pthread_join(*(pthread_t *)(handle_base), NULL);
+    DEBUG_FREE_PARANOID(handle_base);
+  }
+  return;
+}
+
+void *
+thread_async_start(void *(*function_base)(void *), void *parameter_base){
+/*
+Run a function on a new thread without waiting for it to finish, so that the caller can overlap other work with it. If the thread can't be created, then the function isn't called at all, so that the caller can do the same work itself when it needs the result, without doing it twice.
+
+In:
+
+  function_base is the function to run. Its return value is ignored.
+
+  *parameter_base is the parameter block to pass to function_base, which must not be accessed by the caller until thread_async_finish() has returned.
+
+Out:
+
+  Returns a handle to pass to thread_async_finish(), or NULL if the thread couldn't be created, in which case function_base wasn't called and the caller may access *parameter_base immediately.
+*/
+  pthread_t *handle_base;
+
+  handle_base=DEBUG_MALLOC_PARANOID((ULONG)(sizeof(pthread_t)));
+  if(handle_base){
+    if(pthread_create(handle_base, NULL, function_base, parameter_base)){
+      DEBUG_FREE_PARANOID(handle_base);
+      handle_base=NULL;
+    }
+  }
+  return handle_base;
+}
+
+u32
+thread_count_get(void){
+/*
+Get the number of threads which can usefully run in parallel.
+
+Out:
+
+  Returns the number of online CPUs, on [1, THREAD_COUNT_MAX]. If this can't be determined, then the return value is one.
+*/
+  u32 thread_count;
+  #if defined(_SC_NPROCESSORS_ONLN)
+    long cpu_count;
+  #endif
+
+  thread_count=1;
+  #if defined(_SC_NPROCESSORS_ONLN)
+    cpu_count=sysconf(_SC_NPROCESSORS_ONLN);
+    if(1<cpu_count){
+      thread_count=THREAD_COUNT_MAX;
+      if(cpu_count<THREAD_COUNT_MAX){
+        thread_count=(u32)(cpu_count);
+      }
+    }
+  #endif
+  return thread_count;
+}
+
+u8
+thread_init(u32 build_break_count, u32 build_feature_count){
+/*
+Verify that the source code is sufficiently updated.
+
+In:
+
+  build_break_count is the caller's most recent knowledge of THREAD_BUILD_BREAK_COUNT, which will fail if the caller is unaware of all critical updates.
+
+  build_feature_count is the caller's most recent knowledge of THREAD_BUILD_FEATURE_COUNT, which will fail if this library is not up to date with the caller's expectations.
+
+Out:
+
+  Returns one if (build_break_count!=THREAD_BUILD_BREAK_COUNT) or (build_feature_count>THREAD_BUILD_FEATURE_COUNT). Otherwise, returns zero.
+*/
+  u8 status;
+
+  status=(u8)(build_break_count!=THREAD_BUILD_BREAK_COUNT);
+  status=(u8)(status|(THREAD_BUILD_FEATURE_COUNT<build_feature_count));
+  return status;
+}
+
+void
+thread_list_run(void *(*function_base)(void *), u8 *parameter_list_base, ULONG parameter_size, u32 thread_idx_max){
+/*
+Run the same function in parallel on a list of parameter blocks, and wait for all of them to finish. The calling thread does the work for the first parameter block. Any thread which can't be created has its work done on the calling thread instead, so the only consequence of failure is slower execution.
+
+In:
+
+  function_base is the function to run. It must not return until its work is complete. Its return value is ignored.
+
+  *parameter_list_base is a list of (thread_idx_max+1) parameter blocks, each of which is passed to one invocation of function_base.
+
+  parameter_size is the size of each parameter block.
+
+  thread_idx_max is one less than the number of parameter blocks, on [0, THREAD_COUNT_MAX-1].
+
+Out:
+
+  function_base has returned once for each parameter block.
+*/
+  u8 create_status_list_base[THREAD_COUNT_MAX];
+  pthread_t thread_list_base[THREAD_COUNT_MAX];
+  u32 thread_idx;
+
+  thread_idx=1;
+  while(thread_idx<=thread_idx_max){
+    create_status_list_base[thread_idx]=!pthread_create(&thread_list_base[thread_idx], NULL, function_base, &parameter_list_base[thread_idx*parameter_size]);
+    thread_idx++;
+  }
+  function_base(parameter_list_base);
+  thread_idx=1;
+  while(thread_idx<=thread_idx_max){
+    if(create_status_list_base[thread_idx]){
+      pthread_join(thread_list_base[thread_idx], NULL);
+    }else{
+      function_base(&parameter_list_base[thread_idx*parameter_size]);
+    }
+    thread_idx++;
+  }
+  return;
+}
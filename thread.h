@@ -0,0 +1,22 @@
+/*
+Thread
+Copyright 2017 Russell Leidich
+
+This collection of files constitutes the Thread Library. (This is a
+library in the abstact sense; it's not intended to compile to a ".lib"
+file.)
+
+The Thread Library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Limited General Public License as
+published by the Free Software Foundation, version 3.
+
+The Thread Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Limited General Public License version 3 for more details.
+
+You should have received a copy of the GNU Limited General Public
+License version 3 along with the Thread Library (filename
+"COPYING"). If not, see http://www.gnu.org/licenses/ .
+*/
+#define THREAD_COUNT_MAX 64U
@@ -0,0 +1,26 @@
+/*
+Thread
+Copyright 2017 Russell Leidich
+
+This collection of files constitutes the Thread Library. (This is a
+library in the abstact sense; it's not intended to compile to a ".lib"
+file.)
+
+The Thread Library is free software: you can redistribute it and/or
+modify it under the terms of the GNU Limited General Public License as
+published by the Free Software Foundation, version 3.
+
+The Thread Library is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the GNU
+Limited General Public License version 3 for more details.
+
+You should have received a copy of the GNU Limited General Public
+License version 3 along with the Thread Library (filename
+"COPYING"). If not, see http://www.gnu.org/licenses/ .
+*/
+extern void thread_async_finish(void *handle_base);
+extern void *thread_async_start(void *(*function_base)(void *), void *parameter_base);
+extern u32 thread_count_get(void);
+extern u8 thread_init(u32 build_break_count, u32 build_feature_count);
+extern void thread_list_run(void *(*function_base)(void *), u8 *parameter_list_base, ULONG parameter_size, u32 thread_idx_max);
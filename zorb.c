@@ -29,6 +29,7 @@ Frequency List Absorption Functions
 #include "flag_loggamma.h"
 #include "flag_poissocache.h"
 #include "flag_agnentroprox.h"
+#include "flag_thread.h"
 #include "flag_zorb.h"
 #include <stdint.h>
 #include <stdlib.h>
@@ -37,12 +38,15 @@ Frequency List Absorption Functions
 #include "debug.h"
 #include "debug_xtrn.h"
 #include "fracterval_u128.h"
+#include "fracterval_u128_xtrn.h"
 #include "fracterval_u64.h"
 #include "loggamma.h"
 #include "poissocache.h"
 #include "agnentroprox.h"
 #include "agnentroprox_xtrn.h"
 #include "lmd2.h"
+#include "thread.h"
+#include "thread_xtrn.h"
 #include "zorb.h"
 #include "zorb_xtrn.h"
 
@@ -55,35 +59,23 @@ In:
 
   mask_max is the the expected value of zorb_base->mask_max.
 
-  zorb_base is the return value of zorb_init().
+  zorb_base is the return value of zorb_init(), containing a dense Zorb file or the output of zorb_unpack().
 
-  zorb_size is the size of the Zorb file.
+  zorb_size is the size of the dense Zorb file.
 
 Out:
 
   Returns one on failure, else zero.
 */
-  u64 lmd2;
+  u64 lmd2_accumulator;
   u8 status;
-  u64 zorb_size_u64;
 
-  status=1;
-  if(zorb_base->signature==ZORB_SIGNATURE){
-    if(mask_max==zorb_base->mask_max){
-      if(!zorb_base->zero){
-        zorb_size_u64=(u64)(sizeof(zorb_t))+(((u64)(mask_max)+1)<<U64_SIZE_LOG2);
-        if(zorb_size==zorb_size_u64){
-          status=zorb_lmd2_get(zorb_base, &lmd2);
-          status=(u8)(status|(lmd2!=zorb_base->lmd2_following));
-        }
-      }
-    }     
-  }
+  status=zorb_lmd2_accumulator_check(&lmd2_accumulator, mask_max, zorb_base, zorb_size);
   return status;
 }
 
 void
-zorb_finalize(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base){
+zorb_finalize(agnentroprox_t *agnentroprox_base, u32 weight, zorb_t *zorb_base){
 /*
 Prepare a Zorb file header for writing to storage.
 
@@ -91,13 +83,33 @@ In:
 
   agnentroprox_base is the return value of agnentroprox_init(), which has successfully passed through zorb_freq_list_import().
 
+  weight is zero if the Zorb isn't aging, else as defined in zorb_weight_advance().
+
   zorb_base is the return value of zorb_init().
 
 Out:
 
   *zorb_base is ready for writing to storage.
 */
-  u64 lmd2;
+  zorb_finalize_parallel(agnentroprox_base, weight, zorb_base, 0);
+  return;
+}
+
+void
+zorb_finalize_parallel(agnentroprox_t *agnentroprox_base, u32 weight, zorb_t *zorb_base, u32 thread_idx_max){
+/*
+Do the same thing as zorb_finalize(), but compute the LMD2 using multiple threads.
+
+In:
+
+  All inputs are as defined in zorb_finalize(), except:
+
+  thread_idx_max is as defined in zorb_lmd2_accumulator_get_parallel().
+
+Out:
+
+  *zorb_base is ready for writing to storage.
+*/
   ULONG mask_idx_max;
   u32 mask_max;
 
@@ -106,9 +118,8 @@ Out:
   zorb_base->mask_idx_max=mask_idx_max;
   zorb_base->mask_max=mask_max;
   zorb_base->signature=ZORB_SIGNATURE;
-  zorb_base->zero=0;
-  zorb_lmd2_get(zorb_base, &lmd2);
-  zorb_base->lmd2_following=lmd2;
+  zorb_base->weight=weight;
+  zorb_lmd2_set_parallel(zorb_base, thread_idx_max);
   return;
 }
 
@@ -260,6 +271,60 @@ Out:
   return status;
 }
 
+u8
+zorb_freq_list_weight(agnentroprox_t *agnentroprox_base, u8 freq_list_idx, u32 weight){
+/*
+After verifying that it's safe to do so, multiply one of Agnentroprox's frequency lists by a weight. This is how mask lists are absorbed into an aging Zorb, and how a Zorb starts to age.
+
+In:
+
+  agnentroprox_base is the return value of agnentroprox_init().
+
+  freq_list_idx is zero to weight frequency list zero, else one to weight frequency list one.
+
+  weight is the nonzero factor by which to multiply the frequency list.
+
+Out:
+
+  Returns one if weight is zero or the weighted mask count would exceed the capacity of *agnentroprox_base, in which case the frequency list is unchanged, else zero.
+
+  agnentroprox_base has been referenced for the sake of weighting the indicated frequency list.
+*/
+  ULONG *freq_list_base;
+  u32 mask;
+  ULONG mask_count;
+  u32 mask_max;
+  u8 status;
+
+  freq_list_base=agnentroprox_base->freq_list_base0;
+  mask_count=agnentroprox_base->mask_count0;
+  if(freq_list_idx){
+    freq_list_base=agnentroprox_base->freq_list_base1;
+    mask_count=agnentroprox_base->mask_count1;
+  }
+  status=!weight;
+  if(mask_count&&!status){
+    status=((ULONG_MAX/weight)<mask_count);
+    if(!status){
+      mask_count*=weight;
+      status=agnentroprox_capacity_check(agnentroprox_base, freq_list_idx, mask_count-1, 0);
+    }
+    if(!status){
+      mask=0;
+      mask_max=agnentroprox_base->mask_max;
+      do{
+        freq_list_base[mask]*=weight;
+      }while((mask++)!=mask_max);
+      if(!freq_list_idx){
+        agnentroprox_base->mask_count0=mask_count;
+      }else{
+        agnentroprox_base->mask_count1=mask_count;
+      }
+    }
+  }
+  return status;
+}
+
 zorb_t *
 zorb_init(u32 build_break_count, u32 build_feature_count, u32 mask_max){
 /*
@@ -293,33 +358,318 @@ Out:
   return zorb_base;
 }
 
+ULONG
+zorb_journal_build(agnentroprox_t *agnentroprox_base, u64 lmd2_accumulator, ULONG journal_size_max, zorb_journal_t *journal_base, u32 weight, zorb_t *zorb_base){
+/*
+Build a journal of the frequencies which need to change in a dense Zorb file in order to reflect the frequency list zero of an Agnentroprox instance, along with the new header values, so that the Zorb file can be updated in place via zorb_journal_replay() without being rewritten in its entirety. The new LMD2 is derived from the old one in time proportional to the number of changed frequencies, rather than to mask_max.
+
+In:
+
+  agnentroprox_base is the return value of agnentroprox_init(), having passed through zorb_freq_list_export(), zorb_mask_list_load(), and then zorb_freq_list_add() or zorb_freq_list_subtract(). Masks with nonzero frequency in its frequency list one are the ones which might have changed.
+
+  lmd2_accumulator is (Out:*lmd2_accumulator_base) from zorb_lmd2_accumulator_check() for *zorb_base.
+
+  journal_size_max is the number of bytes available at journal_base.
+
+  journal_base is the base of journal_size_max writable bytes, aligned to a (u64).
+
+  weight is the new weight of the Zorb file, as for zorb_finalize().
+
+  zorb_base is the unmodified dense Zorb file from which *agnentroprox_base was exported.
+
+Out:
+
+  Returns zero if the journal would not fit in journal_size_max bytes, in which case the caller should rewrite the whole Zorb file instead. Else the size of the journal at journal_base, which should be written to storage before calling zorb_journal_replay().
+
+  *journal_base is the journal, subject to the return value.
+*/
+  u64 entry_count;
+  ULONG entry_idx;
+  ULONG *freq_list_base0;
+  ULONG *freq_list_base1;
+  u64 freq_new;
+  u64 freq_old;
+  u64 iteration_idx;
+  ULONG journal_size;
+  ULONG journal_size_max_max;
+  u64 lmd2_iterand;
+  u32 mask;
+  u64 mask_idx_max;
+  u32 mask_max;
+
+  journal_size=0;
+  if(sizeof(zorb_journal_t)<=journal_size_max){
+    freq_list_base0=agnentroprox_base->freq_list_base0;
+    freq_list_base1=agnentroprox_base->freq_list_base1;
+    mask_max=agnentroprox_base->mask_max;
+    mask_idx_max=agnentroprox_base->mask_count0-1;
+/*
+Update the accumulator for the new mask_idx_max, which is at (u32) indexes zero and one of the LMD2 input.
+*/
+    lmd2_iterand=zorb_lmd2_iterand_get(1, ((u64)(LMD2_C0)<<U32_BITS)|LMD2_X0);
+    lmd2_accumulator+=(u64)((u32)(lmd2_iterand))*(u32)(mask_idx_max);
+    lmd2_accumulator-=(u64)((u32)(lmd2_iterand))*(u32)(zorb_base->mask_idx_max);
+    lmd2_iterand=zorb_lmd2_iterand_get(1, lmd2_iterand);
+    lmd2_accumulator+=(u64)((u32)(lmd2_iterand))*(u32)(mask_idx_max>>U32_BITS);
+    lmd2_accumulator-=(u64)((u32)(lmd2_iterand))*(u32)(zorb_base->mask_idx_max>>U32_BITS);
+/*
+Skip mask_max, which doesn't change, to update the weight.
+*/
+    lmd2_iterand=zorb_lmd2_iterand_get(2, lmd2_iterand);
+    lmd2_accumulator+=(u64)((u32)(lmd2_iterand))*weight;
+    lmd2_accumulator-=(u64)((u32)(lmd2_iterand))*zorb_base->weight;
+    entry_idx=0;
+    iteration_idx=4;
+    journal_size=(ULONG)(sizeof(zorb_journal_t));
+    journal_size_max_max=journal_size_max-(1U<<ZORB_JOURNAL_ENTRY_SIZE_LOG2);
+    mask=0;
+    do{
+      if(freq_list_base1[mask]){
+        if(journal_size_max_max<journal_size){
+          journal_size=0;
+          break;
+        }
+        freq_new=freq_list_base0[mask];
+        freq_old=zorb_base->freq_list[mask];
+        journal_base->entry_list[entry_idx]=mask;
+        journal_base->entry_list[entry_idx+1]=freq_new;
+        entry_idx+=2;
+        journal_size+=(1U<<ZORB_JOURNAL_ENTRY_SIZE_LOG2);
+/*
+Jump to the iterand for the low half of this frequency, then step once more to the high half.
+*/
+        lmd2_iterand=zorb_lmd2_iterand_get(((u64)(mask)<<1)+ZORB_LMD2_ITERATION_IDX_FREQ_LIST-iteration_idx, lmd2_iterand);
+        lmd2_accumulator+=(u64)((u32)(lmd2_iterand))*(u32)(freq_new);
+        lmd2_accumulator-=(u64)((u32)(lmd2_iterand))*(u32)(freq_old);
+        lmd2_iterand=zorb_lmd2_iterand_get(1, lmd2_iterand);
+        lmd2_accumulator+=(u64)((u32)(lmd2_iterand))*(u32)(freq_new>>U32_BITS);
+        lmd2_accumulator-=(u64)((u32)(lmd2_iterand))*(u32)(freq_old>>U32_BITS);
+        iteration_idx=((u64)(mask)<<1)+ZORB_LMD2_ITERATION_IDX_FREQ_LIST+1;
+      }
+    }while((mask++)!=mask_max);
+    if(journal_size){
+      entry_count=entry_idx>>1;
+      journal_base->signature=ZORB_JOURNAL_SIGNATURE;
+      journal_base->entry_count=entry_count;
+      journal_base->mask_idx_max=mask_idx_max;
+      journal_base->zorb_lmd2=zorb_lmd2_finalize(lmd2_accumulator, mask_max);
+      journal_base->mask_max=mask_max;
+      journal_base->weight=weight;
+      journal_base->lmd2_following=zorb_journal_lmd2_get(journal_size, journal_base);
+    }
+  }
+  return journal_size;
+}
+
+u64
+zorb_journal_lmd2_get(ULONG journal_size, zorb_journal_t *journal_base){
+/*
+Get the LMD2 error detection code of a zorb_journal_t.
+
+In:
+
+  journal_size is the size of the journal, which must be a nonzero multiple of U64_SIZE and at least sizeof(zorb_journal_t).
+
+  *journal_base is the journal for which to compute (but not overwrite) the value of lmd2_following (which is not the LMD2 of the entire structure).
+
+Out:
+
+  Returns the correct value of journal_base->lmd2_following.
+*/
+  u64 lmd2;
+  u32 lmd2_c0;
+  u64 lmd2_iterand;
+  u32 lmd2_x0;
+  u32 uint;
+  ULONG uint_idx;
+  ULONG uint_idx_max;
+  u32 *uint_list_base;
+
+  LMD_SEED_INIT(LMD2_C0, lmd2_c0, LMD2_X0, lmd2_x0)
+  LMD_ACCUMULATOR_INIT(lmd2)
+  uint_list_base=(u32 *)(&journal_base->entry_count);
+  uint_idx=0;
+  uint_idx_max=((journal_size-(ULONG)(U64_SIZE<<1))>>U32_SIZE_LOG2)-1;
+  do{
+    uint=uint_list_base[uint_idx];
+    LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand)
+    LMD_ACCUMULATE(uint, lmd2_x0, lmd2)
+  }while((uint_idx++)!=uint_idx_max);
+  LMD_FINALIZE(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand, lmd2)
+  return lmd2;
+}
+
 u8
-zorb_lmd2_get(zorb_t *zorb_base, u64 *lmd2_base){
+zorb_journal_replay(u32 mask_max, ULONG journal_size, zorb_journal_t *journal_base, zorb_t *zorb_base){
 /*
-Get the LMD2 error detection code of a zorb_t, and return it along with a status indicating whether the mask count implied by its header is consistent with the sum of its constituent frequencies.
+Verify a journal produced by zorb_journal_build() and apply it to a dense Zorb file. Replaying the same journal more than once has no further effect, so it's safe to do so after a crash which occurred at any point after the journal reached storage.
 
 In:
 
-  *zorb_base is the zorb_t for which to compute (but not overwrite) the value of lmd2_following (which is not the LMD2 of the entire structure).
+  mask_max is the expected value of journal_base->mask_max.
 
-  *lmd2_base is undefined.
+  journal_size is the size of the journal.
+
+  *journal_base is the journal.
+
+  zorb_base is the return value of zorb_init() or filesys_file_map(), containing a dense Zorb file with the same mask_max.
+
+Out:
+
+  Returns one if the journal is corrupt (as would be the case if a crash occurred while it was being written, in which case *zorb_base was not yet modified) or inconsistent with mask_max, else zero.
+
+  *zorb_base has been updated according to the journal if the return value is zero, else unchanged.
+*/
+  u64 entry_count;
+  ULONG entry_idx;
+  ULONG entry_idx_max;
+  u64 mask;
+  u8 status;
+
+  status=1;
+  if(sizeof(zorb_journal_t)<=journal_size){
+    entry_count=journal_base->entry_count;
+    entry_idx_max=journal_size-(ULONG)(sizeof(zorb_journal_t));
+    if((journal_base->signature==ZORB_JOURNAL_SIGNATURE)&&(journal_base->mask_max==mask_max)&&(entry_count==(entry_idx_max>>ZORB_JOURNAL_ENTRY_SIZE_LOG2))&&!(entry_idx_max&((1U<<ZORB_JOURNAL_ENTRY_SIZE_LOG2)-1))){
+      status=(journal_base->lmd2_following!=zorb_journal_lmd2_get(journal_size, journal_base));
+      entry_idx_max=(ULONG)(entry_count<<1);
+      entry_idx=0;
+      while((!status)&&(entry_idx!=entry_idx_max)){
+        mask=journal_base->entry_list[entry_idx];
+        status=(mask_max<mask);
+        entry_idx+=2;
+      }
+      if(!status){
+        entry_idx=0;
+        while(entry_idx!=entry_idx_max){
+          mask=journal_base->entry_list[entry_idx];
+          zorb_base->freq_list[mask]=journal_base->entry_list[entry_idx+1];
+          entry_idx+=2;
+        }
+        zorb_base->mask_idx_max=journal_base->mask_idx_max;
+        zorb_base->weight=journal_base->weight;
+        zorb_base->lmd2_following=journal_base->zorb_lmd2;
+      }
+    }
+  }
+  return status;
+}
+
+u8
+zorb_lmd2_accumulator_check(u64 *lmd2_accumulator_base, u32 mask_max, zorb_t *zorb_base, ULONG zorb_size){
+/*
+Verify the size and integrity of a Zorb (ZRB) file, just like zorb_check(), but also return its LMD2 accumulator so that zorb_journal_build() can later update its LMD2 without another pass over the whole file.
+
+In:
+
+  *lmd2_accumulator_base is undefined.
+
+  mask_max is the the expected value of zorb_base->mask_max.
+
+  zorb_base is the return value of zorb_init() or filesys_file_map(), containing a dense Zorb file or the output of zorb_unpack().
+
+  zorb_size is the size of the dense Zorb file.
+
+Out:
+
+  Returns one on failure, else zero.
+
+  *lmd2_accumulator_base is as (Out:*lmd2_accumulator_base) from zorb_lmd2_accumulator_get(), on success.
+*/
+  u8 status;
+
+  status=zorb_lmd2_accumulator_check_parallel(lmd2_accumulator_base, mask_max, zorb_base, zorb_size, 0);
+  return status;
+}
+
+u8
+zorb_lmd2_accumulator_check_parallel(u64 *lmd2_accumulator_base, u32 mask_max, zorb_t *zorb_base, ULONG zorb_size, u32 thread_idx_max){
+/*
+Do the same thing as zorb_lmd2_accumulator_check(), but compute the LMD2 using multiple threads.
+
+In:
+
+  All inputs are as defined in zorb_lmd2_accumulator_check(), except:
+
+  thread_idx_max is as defined in zorb_lmd2_accumulator_get_parallel().
+
+Out:
+
+  All outputs are as defined in zorb_lmd2_accumulator_check().
+*/
+  u64 lmd2;
+  u64 lmd2_accumulator;
+  u8 status;
+  u64 zorb_size_u64;
+
+  status=1;
+  if(zorb_base->signature==ZORB_SIGNATURE){
+    if(mask_max==zorb_base->mask_max){
+      zorb_size_u64=(u64)(sizeof(zorb_t))+(((u64)(mask_max)+1)<<U64_SIZE_LOG2);
+      if(zorb_size==zorb_size_u64){
+        status=zorb_lmd2_accumulator_get_parallel(zorb_base, &lmd2_accumulator, thread_idx_max);
+        lmd2=zorb_lmd2_finalize(lmd2_accumulator, mask_max);
+        status=(u8)(status|(lmd2!=zorb_base->lmd2_following));
+        *lmd2_accumulator_base=lmd2_accumulator;
+      }
+    }     
+  }
+  return status;
+}
+
+u8
+zorb_lmd2_accumulator_get(zorb_t *zorb_base, u64 *lmd2_accumulator_base){
+/*
+Get the LMD2 accumulator of a zorb_t, which is its LMD2 prior to finalization, and return it along with a status indicating whether the mask count implied by its header is consistent with the sum of its constituent frequencies.
+
+The accumulator is the sum of each (u32) of the header (after lmd2_following) and frequency list, times the LMD2 iterand low half corresponding to its position. It's therefore linear in each (u32), which allows zorb_journal_build() to update it in time proportional to the number of frequencies changed, and zorb_lmd2_accumulator_get_parallel() to split it into slices.
+
+In:
+
+  *zorb_base is the zorb_t for which to compute the accumulator.
+
+  *lmd2_accumulator_base is undefined.
 
 Out:
 
   Returns zero if zorb_base->mask_idx_max is consistent with the sum of all (zorb_base->mask_max+1) items at zorb_base->freq_list, else one.
 
-  *lmd2_base is the correct value of zorb_base->lmd2_following.
+  *lmd2_accumulator_base is the accumulator, which zorb_lmd2_finalize() converts to the correct value of zorb_base->lmd2_following.
 */
-  u64 freq;
+  u8 status;
+
+  status=zorb_lmd2_accumulator_get_parallel(zorb_base, lmd2_accumulator_base, 0);
+  return status;
+}
+
+u8
+zorb_lmd2_accumulator_get_parallel(zorb_t *zorb_base, u64 *lmd2_accumulator_base, u32 thread_idx_max){
+/*
+Do the same thing as zorb_lmd2_accumulator_get(), but using multiple threads. Each thread accumulates a slice of the frequency list starting from the LMD2 iterand at the base of its slice, which zorb_lmd2_iterand_get() can jump to directly. The partial accumulators are then summed, giving exactly the same result as a single pass. Slices are at least ZORB_THREAD_MASK_COUNT_MIN frequencies, so this may end up running on fewer threads, or just one, for small frequency lists.
+
+In:
+
+  All inputs are as defined in zorb_lmd2_accumulator_get(), except:
+
+  thread_idx_max is one less than the maximum number of threads to use, on [0, THREAD_COUNT_MAX-1], usually (thread_count_get()-1).
+
+Out:
+
+  All outputs are as defined in zorb_lmd2_accumulator_get().
+*/
+  u64 freq_sum;
   u64 lmd2;
   u32 lmd2_c0;
   u64 lmd2_iterand;
   u32 lmd2_x0;
-  u32 mask;
   u64 mask_count;
   u64 mask_idx_max;
   u32 mask_max;
+  u32 slice_size;
   u8 status;
+  u32 thread_idx;
+  u32 thread_idx_max_max;
+  zorb_thread_t thread_list_base[THREAD_COUNT_MAX];
   u32 uint;
 
   LMD_SEED_INIT(LMD2_C0, lmd2_c0, LMD2_X0, lmd2_x0)
@@ -334,16 +684,83 @@ Out:
   mask_max=zorb_base->mask_max;
   LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand)
   LMD_ACCUMULATE(mask_max, lmd2_x0, lmd2)
-  uint=zorb_base->zero;
+  uint=zorb_base->weight;
   LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand)
   LMD_ACCUMULATE(uint, lmd2_x0, lmd2)
-  mask=0;
-  mask_count=mask_idx_max+1;
+  mask_count=(u64)(mask_max)+1;
+  thread_idx_max_max=(u32)(mask_count/ZORB_THREAD_MASK_COUNT_MIN);
+  thread_idx_max=MIN(thread_idx_max, thread_idx_max_max ? thread_idx_max_max-1 : 0);
+  slice_size=(u32)(mask_count/(thread_idx_max+1));
+  thread_idx=0;
+  do{
+    thread_list_base[thread_idx].zorb_base=zorb_base;
+    thread_list_base[thread_idx].mask_min=thread_idx*slice_size;
+    thread_list_base[thread_idx].mask_max=((thread_idx+1)*slice_size)-1;
+  }while((thread_idx++)!=thread_idx_max);
+  thread_list_base[thread_idx_max].mask_max=mask_max;
+  if(!thread_idx_max){
+    zorb_lmd2_accumulator_get_thread(thread_list_base);
+  }else{
+    thread_list_run(&zorb_lmd2_accumulator_get_thread, (u8 *)(thread_list_base), (ULONG)(sizeof(zorb_thread_t)), thread_idx_max);
+  }
+/*
+Sum the partial accumulators and frequency sums, the latter of which must neither wrap nor differ from (mask_idx_max+1).
+*/
+  freq_sum=0;
+  status=0;
+  thread_idx=0;
+  do{
+    lmd2+=thread_list_base[thread_idx].lmd2;
+    freq_sum+=thread_list_base[thread_idx].freq_sum;
+    status=(u8)(status|thread_list_base[thread_idx].status|(freq_sum<thread_list_base[thread_idx].freq_sum));
+  }while((thread_idx++)!=thread_idx_max);
+  status=(u8)(status|(freq_sum!=(mask_idx_max+1)));
+  *lmd2_accumulator_base=lmd2;
+  return status;
+}
+
+void *
+zorb_lmd2_accumulator_get_thread(void *thread_base){
+/*
+Don't call here directly. This is a helper for zorb_lmd2_accumulator_get_parallel().
+
+In:
+
+  *thread_base is a zorb_thread_t whose zorb_base, mask_max, and mask_min specify the slice of the frequency list to accumulate.
+
+Out:
+
+  Returns NULL.
+
+  *thread_base is as follows: lmd2 is the contribution of the slice to the LMD2 accumulator; freq_sum is the sum of the frequencies in the slice; status is one if that sum wrapped, else zero; all other fields are unchanged.
+*/
+  u64 freq;
+  u64 freq_sum;
+  u64 lmd2;
+  u32 lmd2_c0;
+  u64 lmd2_iterand;
+  u32 lmd2_x0;
+  u32 mask;
+  u32 mask_max;
+  u8 status;
+  zorb_thread_t *thread_base_u;
+  u32 uint;
+  zorb_t *zorb_base;
+
+  thread_base_u=(zorb_thread_t *)(thread_base);
+  mask=thread_base_u->mask_min;
+  mask_max=thread_base_u->mask_max;
+  zorb_base=thread_base_u->zorb_base;
+  lmd2_iterand=zorb_lmd2_iterand_get(((u64)(mask)<<1)+ZORB_LMD2_ITERATION_IDX_FREQ_LIST-1, ((u64)(LMD2_C0)<<U32_BITS)|LMD2_X0);
+  lmd2_c0=(u32)(lmd2_iterand>>U32_BITS);
+  lmd2_x0=(u32)(lmd2_iterand);
+  LMD_ACCUMULATOR_INIT(lmd2)
+  freq_sum=0;
   status=0;
   do{
     freq=zorb_base->freq_list[mask];
-    status=(u8)(status|(mask_count<freq));
-    mask_count-=freq;
+    freq_sum+=freq;
+    status=(u8)(status|(freq_sum<freq));
     uint=(u32)(freq);
     LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand)
     LMD_ACCUMULATE(uint, lmd2_x0, lmd2)
@@ -351,9 +768,154 @@ Out:
     LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand)
     LMD_ACCUMULATE(uint, lmd2_x0, lmd2)
   }while((mask++)!=mask_max);
-  status=(u8)(status|!!mask_count);
+  thread_base_u->freq_sum=freq_sum;
+  thread_base_u->lmd2=lmd2;
+  thread_base_u->status=status;
+  return NULL;
+}
+
+u64
+zorb_lmd2_finalize(u64 lmd2_accumulator, u32 mask_max){
+/*
+Convert the LMD2 accumulator of a zorb_t to its LMD2.
+
+In:
+
+  lmd2_accumulator is (Out:*lmd2_accumulator_base) from zorb_lmd2_accumulator_get() or an equivalent incremental update thereof.
+
+  mask_max is the mask_max of the zorb_t, which determines the number of LMD2 iterations which preceded finalization.
+
+Out:
+
+  Returns the correct value of lmd2_following for the zorb_t.
+*/
+  u64 iteration_count;
+  u64 lmd2;
+  u32 lmd2_c0;
+  u64 lmd2_iterand;
+  u32 lmd2_x0;
+
+  iteration_count=(((u64)(mask_max)+1)<<1)+ZORB_LMD2_ITERATION_IDX_FREQ_LIST-1;
+  lmd2_iterand=zorb_lmd2_iterand_get(iteration_count, ((u64)(LMD2_C0)<<U32_BITS)|LMD2_X0);
+  lmd2=lmd2_accumulator;
   LMD_FINALIZE(LMD2_A, lmd2_c0, lmd2_x0, lmd2_iterand, lmd2)
-  *lmd2_base=lmd2;
+  return lmd2;
+}
+
+u8
+zorb_lmd2_get(zorb_t *zorb_base, u64 *lmd2_base){
+/*
+Get the LMD2 error detection code of a zorb_t, and return it along with a status indicating whether the mask count implied by its header is consistent with the sum of its constituent frequencies.
+
+In:
+
+  *zorb_base is the zorb_t for which to compute (but not overwrite) the value of lmd2_following (which is not the LMD2 of the entire structure).
+
+  *lmd2_base is undefined.
+
+Out:
+
+  Returns zero if zorb_base->mask_idx_max is consistent with the sum of all (zorb_base->mask_max+1) items at zorb_base->freq_list, else one.
+
+  *lmd2_base is the correct value of zorb_base->lmd2_following.
+*/
+  u64 lmd2_accumulator;
+  u8 status;
+
+  status=zorb_lmd2_accumulator_get(zorb_base, &lmd2_accumulator);
+  *lmd2_base=zorb_lmd2_finalize(lmd2_accumulator, zorb_base->mask_max);
+  return status;
+}
+
+u64
+zorb_lmd2_iterand_get(u64 iteration_count, u64 lmd2_iterand){
+/*
+Advance an LMD2 iterand by a given number of iterations. LMD2 is a multiply-with-carry generator, so its iterand ((c<<32)|x) after N iterations is just (iterand*(LMD2_A^N)) modulo ZORB_LMD2_MODULUS, which is (LMD2_A*(2^32))-1. Long jumps therefore take logarithmic time.
+
+In:
+
+  iteration_count is the number of iterations to advance.
+
+  lmd2_iterand is the iterand to advance, for example ((LMD2_C0<<32)|LMD2_X0) to start from the seed.
+
+Out:
+
+  Returns the advanced iterand. If lmd2_iterand was the seed, then its low half is the x value by which the (u32) at zero-based index (iteration_count-1) of the LMD2 input is multiplied.
+*/
+  u32 lmd2_c;
+  u64 lmd2_power;
+  u32 lmd2_x;
+
+  if(iteration_count<=ZORB_LMD2_ITERATION_COUNT_JUMP_MIN){
+    lmd2_c=(u32)(lmd2_iterand>>U32_BITS);
+    lmd2_x=(u32)(lmd2_iterand);
+    while(iteration_count){
+      LMD_ITERATE_NO_ZERO_CHECK(LMD2_A, lmd2_c, lmd2_x, lmd2_iterand)
+      iteration_count--;
+    }
+  }else{
+    lmd2_power=LMD2_A;
+    do{
+      if(iteration_count&1){
+        lmd2_iterand=zorb_lmd2_product_get(lmd2_iterand, lmd2_power);
+      }
+      lmd2_power=zorb_lmd2_product_get(lmd2_power, lmd2_power);
+      iteration_count>>=1;
+    }while(iteration_count);
+  }
+  return lmd2_iterand;
+}
+
+u64
+zorb_lmd2_product_get(u64 factor0, u64 factor1){
+/*
+Don't call here directly. This is a helper for zorb_lmd2_iterand_get().
+
+Multiply 2 (u64)s modulo ZORB_LMD2_MODULUS.
+
+In:
+
+  factor0 is one factor, less than ZORB_LMD2_MODULUS.
+
+  factor1 is the other factor, less than ZORB_LMD2_MODULUS.
+
+Out:
+
+  Returns (factor0*factor1) modulo ZORB_LMD2_MODULUS.
+*/
+  u128 product;
+  u64 product_lo;
+  u64 quotient;
+  u8 status;
+
+  status=0;
+  U128_FROM_U64_PRODUCT(product, factor0, factor1);
+  U128_DIVIDE_U64_TO_U64(quotient, product, ZORB_LMD2_MODULUS, status);
+  U128_TO_U64_LO(product_lo, product);
+  product_lo-=quotient*ZORB_LMD2_MODULUS;
+  return product_lo;
+}
+
+u8
+zorb_lmd2_set_parallel(zorb_t *zorb_base, u32 thread_idx_max){
+/*
+Recompute the LMD2 of a Zorb after its frequency list and mask_idx_max have been changed directly, as by zorb_merge(), so that it can be written to storage.
+
+In:
+
+  zorb_base is the return value of zorb_init(), with a valid header apart from lmd2_following.
+
+  thread_idx_max is as defined in zorb_lmd2_accumulator_get_parallel().
+
+Out:
+
+  Returns one if zorb_base->mask_idx_max is inconsistent with the sum of its frequency list, else zero. In either case, zorb_base->lmd2_following has been updated.
+*/
+  u64 lmd2_accumulator;
+  u8 status;
+
+  status=zorb_lmd2_accumulator_get_parallel(zorb_base, &lmd2_accumulator, thread_idx_max);
+  zorb_base->lmd2_following=zorb_lmd2_finalize(lmd2_accumulator, zorb_base->mask_max);
   return status;
 }
 
@@ -429,6 +991,172 @@ Out:
   return status;
 }
 
+u8
+zorb_merge(u8 split_status, zorb_t *zorb_base, zorb_t *zorb_base1){
+/*
+Add the frequency list of one Zorb to that of another, or subtract it. This allows Zorbs absorbed separately, for example on different machines, to be combined without reabsorbing their masklists, and allows one such contribution to be removed again later.
+
+In:
+
+  split_status is zero to add *zorb_base1 to *zorb_base, or one to subtract it.
+
+  zorb_base is the return value of zorb_init(), containing a dense Zorb file which has passed zorb_check(), or the output of zorb_unpack().
+
+  zorb_base1 is like zorb_base, and must have the same mask_max. It must also have the same weight, unless *zorb_base is empty, in which case *zorb_base takes on its weight.
+
+Out:
+
+  Returns one if the mask_max or weight values differ, or if any frequency or the total mask count would overflow on addition or underflow on subtraction, else zero.
+
+  *zorb_base is undefined on failure. Otherwise its frequency list and mask_idx_max reflect the addition or subtraction, but its LMD2 is stale, so zorb_lmd2_set_parallel() must be called before writing it to storage.
+*/
+  u64 carry;
+  u64 freq;
+  u64 freq0;
+  u64 freq1;
+  ULONG freq_idx;
+  ULONG freq_idx_max;
+  u64 *freq_list_base;
+  u64 *freq_list_base1;
+  u64 mask_count;
+  u64 mask_count1;
+  u8 status;
+  u32 weight;
+
+  status=1;
+  freq_idx_max=zorb_base->mask_max;
+  weight=zorb_base1->weight;
+  if(zorb_base->mask_idx_max==U64_MAX){
+    zorb_base->weight=weight;
+  }
+  if((freq_idx_max==zorb_base1->mask_max)&&(zorb_base->weight==weight)){
+/*
+The frequency loops are kept free of branches so that the compiler can vectorize them. Carries and borrows are derived from the MSBs of the operands and the result, rather than by comparison, because SSE2 lacks a 64-bit compare. They're simply ORed together and checked at the end, which is all we need because the result is undefined on failure. Mask counts of zero are represented as mask_idx_max==U64_MAX, which the wrapping arithmetic below handles naturally.
+*/
+    carry=0;
+    freq_idx=0;
+    freq_list_base=zorb_base->freq_list;
+    freq_list_base1=zorb_base1->freq_list;
+    mask_count=zorb_base->mask_idx_max+1;
+    mask_count1=zorb_base1->mask_idx_max+1;
+    if(!split_status){
+      do{
+        freq0=freq_list_base[freq_idx];
+        freq1=freq_list_base1[freq_idx];
+        freq=freq0+freq1;
+        carry|=(freq0&freq1)|((freq0|freq1)&~freq);
+        freq_list_base[freq_idx]=freq;
+      }while((freq_idx++)!=freq_idx_max);
+      carry>>=U64_BIT_MAX;
+      mask_count+=mask_count1;
+      carry|=(mask_count<mask_count1);
+    }else{
+      do{
+        freq0=freq_list_base[freq_idx];
+        freq1=freq_list_base1[freq_idx];
+        freq=freq0-freq1;
+        carry|=(~freq0&freq1)|(~(freq0^freq1)&freq);
+        freq_list_base[freq_idx]=freq;
+      }while((freq_idx++)!=freq_idx_max);
+      carry>>=U64_BIT_MAX;
+      carry|=(mask_count<mask_count1);
+      mask_count-=mask_count1;
+    }
+    zorb_base->mask_idx_max=mask_count-1;
+    status=(u8)(!!carry);
+  }
+  return status;
+}
+
+ULONG
+zorb_pack(ULONG pack_size_max, u8 *pack_base, zorb_t *zorb_base){
+/*
+Convert a zorb_t to a sparse Zorb file, provided that the result is sufficiently small to be worth storing in place of the dense one.
+
+In:
+
+  pack_size_max is (Out:*pack_size_max_base) from zorb_pack_malloc().
+
+  pack_base is the return value of zorb_pack_malloc().
+
+  zorb_base is the return value of zorb_init(), having passed through zorb_finalize().
+
+Out:
+
+  Returns zero if the sparse Zorb file might not fit in pack_size_max bytes, in which case the caller should store *zorb_base instead. Else the size of the sparse Zorb file at pack_base.
+
+  *pack_base is the sparse Zorb file, subject to the return value. Its header is identical to that of *zorb_base, including lmd2_following, except that its signature is ZORB_SIGNATURE_SPARSE. The header is followed by a (gap, frequency) pair for each nonzero frequency in ascending mask order, where gap is the number of zero frequencies since the previous such pair (or mask zero). Both members of the pair are encoded with zorb_varint_put().
+*/
+  u64 freq;
+  u64 gap;
+  u32 mask;
+  u32 mask_max;
+  zorb_t *pack_header_base;
+  ULONG pack_idx;
+  ULONG pack_idx_max;
+
+  pack_idx=0;
+  if((sizeof(zorb_t)+ZORB_PACK_PAIR_SIZE_MAX)<=pack_size_max){
+    pack_header_base=(zorb_t *)(pack_base);
+    pack_header_base->signature=ZORB_SIGNATURE_SPARSE;
+    pack_header_base->lmd2_following=zorb_base->lmd2_following;
+    pack_header_base->mask_idx_max=zorb_base->mask_idx_max;
+    mask_max=zorb_base->mask_max;
+    pack_header_base->mask_max=mask_max;
+    pack_header_base->weight=zorb_base->weight;
+    gap=0;
+    mask=0;
+    pack_idx=(ULONG)(sizeof(zorb_t));
+    pack_idx_max=pack_size_max-ZORB_PACK_PAIR_SIZE_MAX;
+    do{
+      freq=zorb_base->freq_list[mask];
+      if(freq){
+        if(pack_idx_max<pack_idx){
+          pack_idx=0;
+          break;
+        }
+        pack_idx=zorb_varint_put(pack_idx, pack_base, gap);
+        pack_idx=zorb_varint_put(pack_idx, pack_base, freq);
+        gap=0;
+      }else{
+        gap++;
+      }
+    }while((mask++)!=mask_max);
+  }
+  return pack_idx;
+}
+
+u8 *
+zorb_pack_malloc(u32 mask_max, ULONG *pack_size_max_base){
+/*
+Allocate a buffer for zorb_pack() and zorb_unpack(), which is half the size of the corresponding zorb_t, so that a sparse Zorb file is only ever stored when it's at most half the size of the dense one.
+
+In:
+
+  mask_max is as defined in zorb_init().
+
+  *pack_size_max_base is undefined.
+
+Out:
+
+  Returns NULL on failure, else the base of an undefined buffer which must be freed via zorb_free().
+
+  *pack_size_max_base is the size of the buffer, which is also the maximum size of a sparse Zorb file which zorb_pack() could produce.
+*/
+  u8 *pack_base;
+  ULONG pack_size_max;
+  u8 status;
+
+  pack_base=NULL;
+  status=zorb_size_ulong_get(mask_max, &pack_size_max);
+  if(!status){
+    pack_size_max>>=1;
+    *pack_size_max_base=pack_size_max;
+    pack_base=(u8 *)(DEBUG_MALLOC_PARANOID(pack_size_max));
+  }
+  return pack_base;
+}
+
 void
 zorb_reset(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base){
 /*
@@ -494,3 +1222,223 @@ Out:
   #endif
   return status;
 }
+
+u8
+zorb_unpack(u32 mask_max, ULONG pack_size, u8 *pack_base, zorb_t *zorb_base){
+/*
+Convert a sparse Zorb file produced by zorb_pack() to a zorb_t.
+
+In:
+
+  mask_max is the expected value of the mask_max field in the header of the sparse Zorb file.
+
+  pack_size is the size of the sparse Zorb file.
+
+  pack_base is the return value of zorb_pack_malloc(), containing the sparse Zorb file.
+
+  zorb_base is the return value of zorb_init(), called with the same mask_max.
+
+Out:
+
+  Returns one if *pack_base is not a well formed sparse Zorb file for mask_max, else zero. The consistency of the frequencies and the integrity of the file are not checked here, so zorb_check() must still be called.
+
+  *zorb_base is undefined on failure, else the dense equivalent of the sparse Zorb file, with a signature of ZORB_SIGNATURE.
+*/
+  u64 freq;
+  u64 gap;
+  u64 mask;
+  zorb_t *pack_header_base;
+  ULONG pack_idx;
+  u8 status;
+
+  status=1;
+  pack_header_base=(zorb_t *)(pack_base);
+  if(sizeof(zorb_t)<=pack_size){
+    if((pack_header_base->signature==ZORB_SIGNATURE_SPARSE)&&(pack_header_base->mask_max==mask_max)){
+      memset(zorb_base->freq_list, 0, (size_t)(((ULONG)(mask_max)+1)<<U64_SIZE_LOG2));
+      mask=0;
+      pack_idx=(ULONG)(sizeof(zorb_t));
+      status=0;
+      while(pack_idx!=pack_size){
+        status=zorb_varint_get(&pack_idx, pack_size, pack_base, &gap);
+        status=(u8)(status|zorb_varint_get(&pack_idx, pack_size, pack_base, &freq));
+        mask+=gap;
+        status=(u8)(status|(mask_max<gap)|(mask_max<mask)|!freq);
+        if(status){
+          break;
+        }
+        zorb_base->freq_list[mask]=freq;
+        mask++;
+      }
+      zorb_base->signature=ZORB_SIGNATURE;
+      zorb_base->lmd2_following=pack_header_base->lmd2_following;
+      zorb_base->mask_idx_max=pack_header_base->mask_idx_max;
+      zorb_base->mask_max=mask_max;
+      zorb_base->weight=pack_header_base->weight;
+    }
+  }
+  return status;
+}
+
+u8
+zorb_varint_get(ULONG *pack_idx_base, ULONG pack_size, u8 *pack_base, u64 *value_base){
+/*
+Decode a varint written by zorb_varint_put().
+
+In:
+
+  *pack_idx_base is the index of the varint at pack_base.
+
+  pack_size is the number of bytes at pack_base.
+
+  *pack_base contains the varint.
+
+  *value_base is undefined.
+
+Out:
+
+  Returns one if the varint runs off the end of *pack_base or is longer than any varint which zorb_varint_put() could write, else zero.
+
+  *pack_idx_base is the index after the varint, on success.
+
+  *value_base is the decoded value, on success.
+*/
+  u8 byte;
+  ULONG pack_idx;
+  u8 shift;
+  u8 status;
+  u64 value;
+
+  pack_idx=*pack_idx_base;
+  shift=0;
+  status=0;
+  value=0;
+  do{
+    status=(u8)((pack_idx==pack_size)|(U64_BITS<=shift));
+    if(status){
+      break;
+    }
+    byte=pack_base[pack_idx];
+    pack_idx++;
+    value|=(u64)(byte&(ZORB_VARINT_MORE-1))<<shift;
+    shift=(u8)(shift+ZORB_VARINT_BIT_COUNT);
+  }while(byte&ZORB_VARINT_MORE);
+  *pack_idx_base=pack_idx;
+  *value_base=value;
+  return status;
+}
+
+ULONG
+zorb_varint_put(ULONG pack_idx, u8 *pack_base, u64 value){
+/*
+Encode a value as a little endian base-128 varint, which consists of 7 bits per byte, with the high bit set in all but the last byte.
+
+In:
+
+  pack_idx is the index at which to write the varint.
+
+  *pack_base is writable for at least ((U64_BITS+6)/7) bytes starting at pack_idx.
+
+  value is the value to encode.
+
+Out:
+
+  Returns the index after the varint.
+
+  *pack_base contains the varint at pack_idx.
+*/
+  u8 byte;
+
+  do{
+    byte=(u8)(value&(ZORB_VARINT_MORE-1));
+    value>>=ZORB_VARINT_BIT_COUNT;
+    if(value){
+      byte=(u8)(byte|ZORB_VARINT_MORE);
+    }
+    pack_base[pack_idx]=byte;
+    pack_idx++;
+  }while(value);
+  return pack_idx;
+}
+
+u8
+zorb_weight_advance(agnentroprox_t *agnentroprox_base, u8 aging_log2, u32 *weight_base){
+/*
+Age a Zorb by increasing the weight at which mask lists are absorbed into it, after each absorption. Everything absorbed so far thus decays exponentially relative to whatever is absorbed next, without touching its frequencies. Only when the weight gets too big are all frequencies scaled down by a constant factor, along with the weight itself. This renormalization occurs once every ((2^aging_log2)*ZORB_WEIGHT_RENORMALIZE_BIT_COUNT*(ln 2)) absorptions, roughly.
+
+In:
+
+  agnentroprox_base is the return value of agnentroprox_init(), having passed through zorb_freq_list_add() after zorb_freq_list_weight() weighted frequency list one by *weight_base.
+
+  aging_log2 is on [1, ZORB_AGING_LOG2_MAX]. Each absorption weighs (1/(2^aging_log2)) more than the previous one, so the half-life is about ((2^aging_log2)*(ln 2)) absorptions.
+
+  *weight_base is the weight used for the absorption just completed, which should initially be (2^aging_log2).
+
+Out:
+
+  Returns one if frequency list zero was renormalized, such that all its frequencies may have changed, else zero.
+
+  *weight_base is the weight for the next absorption.
+
+  agnentroprox_base has been referenced for the sake of renormalizing its frequency list zero as described in the summary.
+*/
+  ULONG freq;
+  ULONG *freq_list_base;
+  u32 mask;
+  ULONG mask_count;
+  u32 mask_max;
+  u8 status;
+  u32 weight;
+  u32 weight_delta;
+
+  status=0;
+  weight=*weight_base;
+  weight_delta=weight>>aging_log2;
+  weight_delta=MAX(weight_delta, 1);
+  weight+=weight_delta;
+  if((1U<<(aging_log2+ZORB_WEIGHT_RENORMALIZE_BIT_COUNT))<=weight){
+/*
+Round each frequency to the nearest multiple of (2^ZORB_WEIGHT_RENORMALIZE_BIT_COUNT) without risking overflow. The mask list just absorbed had at least half that weight, so the Zorb can't end up empty.
+*/
+    freq_list_base=agnentroprox_base->freq_list_base0;
+    mask=0;
+    mask_count=0;
+    mask_max=agnentroprox_base->mask_max;
+    do{
+      freq=freq_list_base[mask];
+      freq=(freq>>ZORB_WEIGHT_RENORMALIZE_BIT_COUNT)+((freq>>(ZORB_WEIGHT_RENORMALIZE_BIT_COUNT-1))&1);
+      freq_list_base[mask]=freq;
+      mask_count+=freq;
+    }while((mask++)!=mask_max);
+    agnentroprox_base->mask_count0=mask_count;
+    weight>>=ZORB_WEIGHT_RENORMALIZE_BIT_COUNT;
+    status=1;
+  }
+  *weight_base=weight;
+  return status;
+}
+
+void
+zorb_zero(u32 mask_max, zorb_t *zorb_base){
+/*
+Set a Zorb to the empty state, containing no masks at all, without reference to an Agnentroprox instance.
+
+In:
+
+  mask_max is the mask_max with which zorb_base was allocated.
+
+  zorb_base is the return value of zorb_init().
+
+Out:
+
+  *zorb_base is empty. Its LMD2 must be set by zorb_lmd2_set_parallel() before writing it to storage.
+*/
+  ULONG zorb_size;
+
+  zorb_size=(ULONG)(sizeof(zorb_t))+(((ULONG)(mask_max)+1)<<U64_SIZE_LOG2);
+  memset(zorb_base, 0, (size_t)(zorb_size));
+  zorb_base->mask_idx_max=U64_MAX;
+  zorb_base->mask_max=mask_max;
+  zorb_base->signature=ZORB_SIGNATURE;
+  return;
+}
@@ -24,8 +24,40 @@ TYPEDEF_START
   u64 lmd2_following;
   u64 mask_idx_max;
   u32 mask_max;
-  u32 zero;
+  u32 weight;
   u64 freq_list[];
 TYPEDEF_END(zorb_t)
 
+TYPEDEF_START
+  u64 signature;
+  u64 lmd2_following;
+  u64 entry_count;
+  u64 mask_idx_max;
+  u64 zorb_lmd2;
+  u32 mask_max;
+  u32 weight;
+  u64 entry_list[];
+TYPEDEF_END(zorb_journal_t)
+
+TYPEDEF_START
+  zorb_t *zorb_base;
+  u64 freq_sum;
+  u64 lmd2;
+  u32 mask_max;
+  u32 mask_min;
+  u8 status;
+TYPEDEF_END(zorb_thread_t)
+
+#define ZORB_AGING_LOG2_MAX 15U
+#define ZORB_JOURNAL_ENTRY_SIZE_LOG2 4U
+#define ZORB_JOURNAL_SIGNATURE 0x5BC4035C4EB46DB4ULL
+#define ZORB_LMD2_ITERATION_COUNT_JUMP_MIN 0x40U
+#define ZORB_LMD2_ITERATION_IDX_FREQ_LIST 5U
+#define ZORB_LMD2_MODULUS 0xFE000FFFFFFFFFFFULL
+#define ZORB_PACK_PAIR_SIZE_MAX 15U
 #define ZORB_SIGNATURE 0x5BC4035C4EB46DB2ULL
+#define ZORB_SIGNATURE_SPARSE 0x5BC4035C4EB46DB3ULL
+#define ZORB_THREAD_MASK_COUNT_MIN 0x100000U
+#define ZORB_VARINT_BIT_COUNT 7U
+#define ZORB_VARINT_MORE 0x80U
+#define ZORB_WEIGHT_RENORMALIZE_BIT_COUNT 16U
@@ -20,15 +20,37 @@ License version 3 along with the Zorb Library (filename
 "COPYING"). If not, see http://www.gnu.org/licenses/ .
 */
 extern u8 zorb_check(u32 mask_max, zorb_t *zorb_base, ULONG zorb_size);
-extern void zorb_finalize(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base);
+extern void zorb_finalize(agnentroprox_t *agnentroprox_base, u32 weight, zorb_t *zorb_base);
+extern void zorb_finalize_parallel(agnentroprox_t *agnentroprox_base, u32 weight, zorb_t *zorb_base, u32 thread_idx_max);
 extern void *zorb_free(void *base);
 extern u8 zorb_freq_list_add(agnentroprox_t *agnentroprox_base);
 extern u8 zorb_freq_list_export(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base);
 extern u8 zorb_freq_list_import(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base);
 extern u8 zorb_freq_list_subtract(agnentroprox_t *agnentroprox_base);
+extern u8 zorb_freq_list_weight(agnentroprox_t *agnentroprox_base, u8 freq_list_idx, u32 weight);
 extern zorb_t *zorb_init(u32 build_break_count, u32 build_feature_count, u32 mask_max);
+extern ULONG zorb_journal_build(agnentroprox_t *agnentroprox_base, u64 lmd2_accumulator, ULONG journal_size_max, zorb_journal_t *journal_base, u32 weight, zorb_t *zorb_base);
+extern u64 zorb_journal_lmd2_get(ULONG journal_size, zorb_journal_t *journal_base);
+extern u8 zorb_journal_replay(u32 mask_max, ULONG journal_size, zorb_journal_t *journal_base, zorb_t *zorb_base);
+extern u8 zorb_lmd2_accumulator_check(u64 *lmd2_accumulator_base, u32 mask_max, zorb_t *zorb_base, ULONG zorb_size);
+extern u8 zorb_lmd2_accumulator_check_parallel(u64 *lmd2_accumulator_base, u32 mask_max, zorb_t *zorb_base, ULONG zorb_size, u32 thread_idx_max);
+extern u8 zorb_lmd2_accumulator_get(zorb_t *zorb_base, u64 *lmd2_accumulator_base);
+extern u8 zorb_lmd2_accumulator_get_parallel(zorb_t *zorb_base, u64 *lmd2_accumulator_base, u32 thread_idx_max);
+extern void *zorb_lmd2_accumulator_get_thread(void *thread_base);
+extern u64 zorb_lmd2_finalize(u64 lmd2_accumulator, u32 mask_max);
 extern u8 zorb_lmd2_get(zorb_t *zorb_base, u64 *lmd2_base);
+extern u64 zorb_lmd2_iterand_get(u64 iteration_count, u64 lmd2_iterand);
+extern u64 zorb_lmd2_product_get(u64 factor0, u64 factor1);
+extern u8 zorb_lmd2_set_parallel(zorb_t *zorb_base, u32 thread_idx_max);
 extern u8 zorb_mask_idx_max_get(ULONG *mask_idx_max_base, zorb_t *zorb_base);
 extern u8 zorb_mask_list_load(agnentroprox_t *agnentroprox_base, u8 *mask_list_base, ULONG mask_list_size);
+extern u8 zorb_merge(u8 split_status, zorb_t *zorb_base, zorb_t *zorb_base1);
+extern ULONG zorb_pack(ULONG pack_size_max, u8 *pack_base, zorb_t *zorb_base);
+extern u8 *zorb_pack_malloc(u32 mask_max, ULONG *pack_size_max_base);
 extern void zorb_reset(agnentroprox_t *agnentroprox_base, zorb_t *zorb_base);
 extern u8 zorb_size_ulong_get(u32 mask_max, ULONG *zorb_size_base);
+extern u8 zorb_unpack(u32 mask_max, ULONG pack_size, u8 *pack_base, zorb_t *zorb_base);
+extern u8 zorb_varint_get(ULONG *pack_idx_base, ULONG pack_size, u8 *pack_base, u64 *value_base);
+extern ULONG zorb_varint_put(ULONG pack_idx, u8 *pack_base, u64 value);
+extern u8 zorb_weight_advance(agnentroprox_t *agnentroprox_base, u8 aging_log2, u32 *weight_base);
+extern void zorb_zero(u32 mask_max, zorb_t *zorb_base);